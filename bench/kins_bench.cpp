@@ -0,0 +1,197 @@
+#include <string.h>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "rtmc_kins_scalar.h"
+#include "rtmc_magic_numbers.h"
+#include "rtmc_math.h"
+#include "rtmc_path.h"
+
+static void setup_kins() {
+    double scale_factors[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        scale_factors[i] = 1000 + i;
+    }
+    rtmc_kins_scalar_setup(scale_factors);
+}
+
+// moves `num_active_axes` axes in a line
+static rtmc_path_t make_line(int num_active_axes) {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_POLYNOMIAL;
+    path.feed_rate = 100;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        path.coefficients[i][2] = (i < num_active_axes) ? 1.5 * (i + 1) : 0;
+        path.coefficients[i][3] = i;
+    }
+    return path;
+}
+
+// moves `num_active_axes` axes along cubics
+static rtmc_path_t make_cubic(int num_active_axes) {
+    rtmc_path_t path = make_line(num_active_axes);
+    for(int i = 0; i < num_active_axes; i++) {
+        path.coefficients[i][0] = 0.25 * (i + 1);
+        path.coefficients[i][1] = -0.5 * (i + 1);
+    }
+    return path;
+}
+
+// a quarter circle in the XY plane
+static rtmc_path_t make_arc() {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_TRIGONOMETRIC;
+    path.feed_rate = 100;
+    path.coefficients[RTMC_X_AXIS][0] = 10;
+    path.coefficients[RTMC_X_AXIS][1] = RTMC_PI / 2;
+    path.coefficients[RTMC_X_AXIS][2] = -1;
+    path.coefficients[RTMC_Y_AXIS][0] = 10;
+    path.coefficients[RTMC_Y_AXIS][1] = RTMC_PI / 2;
+    for(int i = RTMC_Z_AXIS; i < RTMC_NUM_AXES; i++) {
+        path.coefficients[i][3] = i;
+    }
+    return path;
+}
+
+static void BM_KinsScalar_Load(benchmark::State& state) {
+    setup_kins();
+    rtmc_path_t path = make_line(3);
+
+    for(auto _ : state) {
+        rtmc_kins_scalar_load(path);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KinsScalar_Load);
+
+// the argument is the number of active axes
+static void BM_KinsScalar_PoseLine(benchmark::State& state) {
+    setup_kins();
+    rtmc_kins_scalar_load(make_line((int)state.range(0)));
+    double pose[RTMC_NUM_AXES];
+
+    double s = 0;
+    for(auto _ : state) {
+        rtmc_kins_scalar_pose(pose, s);
+        benchmark::DoNotOptimize(pose);
+        s = (s < 1) ? s + 0.001 : 0;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KinsScalar_PoseLine)->Arg(1)->Arg(3)->Arg(RTMC_NUM_AXES);
+
+// per-call evaluation vs. forward differences, sampling s at a fixed step
+static void BM_KinsScalar_PoseCubic(benchmark::State& state) {
+    setup_kins();
+    rtmc_kins_scalar_load(make_cubic((int)state.range(0)));
+    double pose[RTMC_NUM_AXES];
+
+    double s = 0;
+    for(auto _ : state) {
+        rtmc_kins_scalar_pose(pose, s);
+        benchmark::DoNotOptimize(pose);
+        s = (s < 1) ? s + 0.001 : 0;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KinsScalar_PoseCubic)->Arg(3)->Arg(RTMC_NUM_AXES);
+
+static void BM_KinsScalar_StepCubic(benchmark::State& state) {
+    setup_kins();
+    rtmc_kins_scalar_load(make_cubic((int)state.range(0)));
+    double pose[RTMC_NUM_AXES];
+
+    rtmc_path_stepper_t stepper;
+    rtmc_kins_scalar_stepper_init(&stepper, 0, 0.001);
+    int steps = 0;
+    for(auto _ : state) {
+        rtmc_path_stepper_next(&stepper, pose);
+        benchmark::DoNotOptimize(pose);
+        if(++steps == 1000) {
+            rtmc_kins_scalar_stepper_init(&stepper, 0, 0.001);
+            steps = 0;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KinsScalar_StepCubic)->Arg(3)->Arg(RTMC_NUM_AXES);
+
+static void BM_KinsScalar_PoseArc(benchmark::State& state) {
+    setup_kins();
+    rtmc_kins_scalar_load(make_arc());
+    double pose[RTMC_NUM_AXES];
+
+    double s = 0;
+    for(auto _ : state) {
+        rtmc_kins_scalar_pose(pose, s);
+        benchmark::DoNotOptimize(pose);
+        s = (s < 1) ? s + 0.001 : 0;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KinsScalar_PoseArc);
+
+static void BM_KinsScalar_StepArc(benchmark::State& state) {
+    setup_kins();
+    rtmc_kins_scalar_load(make_arc());
+    double pose[RTMC_NUM_AXES];
+
+    rtmc_path_stepper_t stepper;
+    rtmc_kins_scalar_stepper_init(&stepper, 0, 0.001);
+    int steps = 0;
+    for(auto _ : state) {
+        rtmc_path_stepper_next(&stepper, pose);
+        benchmark::DoNotOptimize(pose);
+        if(++steps == 1000) {
+            rtmc_kins_scalar_stepper_init(&stepper, 0, 0.001);
+            steps = 0;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KinsScalar_StepArc);
+
+// the argument is the kernel (`enum rtmc_kins_batch_kernel`)
+static void run_pose_batch(benchmark::State& state, const rtmc_path_t& path) {
+    if(!rtmc_kins_scalar_set_batch_kernel((enum rtmc_kins_batch_kernel)state.range(0))) {
+        state.SkipWithError("kernel not supported");
+        return;
+    }
+    setup_kins();
+    rtmc_kins_scalar_load(path);
+
+    const size_t n = 1024;
+    std::vector<double> s(n), poses(n * RTMC_NUM_AXES);
+    for(size_t k = 0; k < n; k++) {
+        s[k] = (double)k / (n - 1);
+    }
+
+    for(auto _ : state) {
+        rtmc_kins_scalar_pose_batch(s.data(), n, poses.data());
+        benchmark::DoNotOptimize(poses.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * n);
+    rtmc_kins_scalar_set_batch_kernel(RTMC_KINS_BATCH_AUTO);
+}
+
+static void BM_KinsScalar_PoseBatchCubic(benchmark::State& state) {
+    run_pose_batch(state, make_cubic(RTMC_NUM_AXES));
+}
+BENCHMARK(BM_KinsScalar_PoseBatchCubic)
+    ->Arg(RTMC_KINS_BATCH_PORTABLE)->Arg(RTMC_KINS_BATCH_SSE2)->Arg(RTMC_KINS_BATCH_AVX2);
+
+static void BM_KinsScalar_PoseBatchArc(benchmark::State& state) {
+    run_pose_batch(state, make_arc());
+}
+BENCHMARK(BM_KinsScalar_PoseBatchArc)
+    ->Arg(RTMC_KINS_BATCH_PORTABLE)->Arg(RTMC_KINS_BATCH_SSE2)->Arg(RTMC_KINS_BATCH_AVX2);
@@ -0,0 +1,104 @@
+/*
+    bench/latency/histogram.h
+
+    A fixed-size latency histogram in the style of HdrHistogram. Values are
+    grouped by power of two, and each power of two is split into
+    linear sub-buckets, so every recorded value is accurate to within
+    2 / SUB_BUCKETS (under 1%) no matter its magnitude. Recording is
+    a few integer ops and never allocates, so it's safe on a real-time
+    thread.
+*/
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <string.h>
+
+class histogram {
+public:
+    // values up to 2^MAX_POWER ns (about 18 minutes) are tracked exactly
+    static const int SUB_BUCKET_BITS = 8;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_POWER = 40;
+    static const int NUM_BUCKETS = SUB_BUCKETS + (MAX_POWER - SUB_BUCKET_BITS) * (SUB_BUCKETS / 2);
+
+    histogram() {
+        reset();
+    }
+
+    void reset() {
+        memset(counts, 0, sizeof(counts));
+        count = 0;
+        sum = 0;
+        min = UINT64_MAX;
+        max = 0;
+    }
+
+    void record(uint64_t value) {
+        counts[index_of(value)]++;
+        count++;
+        sum += value;
+        if(value < min)
+            min = value;
+        if(value > max)
+            max = value;
+    }
+
+    // returns the value at or below which `percentile`% of values fall
+    uint64_t percentile(double percentile) const {
+        if(count == 0)
+            return 0;
+
+        uint64_t target = (uint64_t)(percentile / 100 * (double)count + 0.5);
+        if(target == 0)
+            target = 1;
+
+        uint64_t seen = 0;
+        for(int i = 0; i < NUM_BUCKETS; i++) {
+            seen += counts[i];
+            if(seen >= target)
+                return (highest_value_of(i) < max) ? highest_value_of(i) : max;
+        }
+        return max;
+    }
+
+    uint64_t total_count() const { return count; }
+    uint64_t min_value() const { return count ? min : 0; }
+    uint64_t max_value() const { return max; }
+    double mean() const { return count ? (double)sum / (double)count : 0; }
+
+private:
+    uint64_t counts[NUM_BUCKETS];
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+
+    // bucket 0 holds values [0, SUB_BUCKETS) exactly; bucket k > 0 holds
+    // [2^(k + SUB_BUCKET_BITS - 1), 2^(k + SUB_BUCKET_BITS)) in
+    // SUB_BUCKETS / 2 steps (the lower half overlaps the previous bucket)
+    static int index_of(uint64_t value) {
+        if(value >= (1ULL << MAX_POWER))
+            value = (1ULL << MAX_POWER) - 1;
+
+        int power = 63 - __builtin_clzll(value | 1);
+        if(power < SUB_BUCKET_BITS)
+            return (int)value;
+
+        int bucket = power - SUB_BUCKET_BITS + 1;
+        int sub_bucket = (int)(value >> (bucket - 1)) - SUB_BUCKETS / 2;
+        return SUB_BUCKETS + (bucket - 1) * (SUB_BUCKETS / 2) + sub_bucket;
+    }
+
+    static uint64_t highest_value_of(int index) {
+        if(index < SUB_BUCKETS)
+            return (uint64_t)index;
+
+        int bucket = (index - SUB_BUCKETS) / (SUB_BUCKETS / 2) + 1;
+        int sub_bucket = (index - SUB_BUCKETS) % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2;
+        return (((uint64_t)sub_bucket + 1) << (bucket - 1)) - 1;
+    }
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,357 @@
+/*
+    bench/latency/latency.cpp
+
+    Measures the worst-case latency of the library's real-time entry points.
+    Each call is timed individually and recorded in a histogram, then the
+    percentiles and the maximum are compared against a servo period.
+
+    For results that mean anything, the measuring thread is set up like a
+    real servo thread: memory is locked (no page faults), the thread is
+    pinned to one CPU, and it runs under SCHED_FIFO. Each of these needs
+    privileges (e.g., root or CAP_SYS_NICE/CAP_IPC_LOCK), and a warning is
+    printed for any that fail.
+
+    Usage: rtmc_lib_latency [options]
+      --iterations=N   timed calls per entry point (default 1000000)
+      --cpu=N          CPU to pin the measuring thread to (default: last)
+      --priority=N     SCHED_FIFO priority (default 80, 0 to disable)
+      --load=N         background load threads (default 0)
+      --budget-us=X    latency budget in microseconds (default 250)
+      --clock=C        "tsc" (x86 only, default there) or "monotonic"
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "histogram.h"
+#include "../program_generator.h"
+#include "rtmc_kins_scalar.h"
+#include "rtmc_magic_numbers.h"
+#include "rtmc_math.h"
+#include "rtmc_parser.h"
+#include "rtmc_path.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAS_TSC
+#include <x86intrin.h>
+#endif
+
+// paths queued up at a time for the dequeue test
+#define DEQUEUE_BATCH 4096
+
+// calls made before timing starts (warms caches and the free chunk lists)
+#define WARMUP_ITERATIONS 10000
+
+struct options_t {
+    uint64_t iterations = 1000000;
+    int cpu = -1;
+    int priority = 80;
+    int load_threads = 0;
+    double budget_us = 250;
+#ifdef HAS_TSC
+    bool use_tsc = true;
+#else
+    bool use_tsc = false;
+#endif
+};
+
+
+
+/*
+    Clock
+*/
+static bool use_tsc;
+static double ns_per_tick = 1;
+
+static inline uint64_t monotonic_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+// returns the current time in ticks (ns for the monotonic clock)
+static inline uint64_t read_clock() {
+#ifdef HAS_TSC
+    if(use_tsc) {
+        // keep the timed code from being reordered around the read
+        _mm_lfence();
+        uint64_t ticks = __rdtsc();
+        _mm_lfence();
+        return ticks;
+    }
+#endif
+    return monotonic_ns();
+}
+
+// measures the TSC frequency against the monotonic clock
+static void calibrate_clock() {
+    if(!use_tsc) {
+        return;
+    }
+
+    uint64_t start_ns = monotonic_ns();
+    uint64_t start_ticks = read_clock();
+    struct timespec duration = {0, 200000000};
+    nanosleep(&duration, NULL);
+    uint64_t ticks = read_clock() - start_ticks;
+    uint64_t ns = monotonic_ns() - start_ns;
+
+    ns_per_tick = (double)ns / (double)ticks;
+}
+
+static inline uint64_t ticks_to_ns(uint64_t ticks) {
+    return (uint64_t)((double)ticks * ns_per_tick + 0.5);
+}
+
+
+
+/*
+    Real-time setup
+*/
+static void setup_realtime_thread(const options_t& options) {
+    if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        perror("warning: mlockall failed (page faults may show up as latency)");
+    }
+
+    int cpu = options.cpu;
+    if(cpu < 0) {
+        cpu = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if(error != 0) {
+        fprintf(stderr, "warning: couldn't pin to CPU %d: %s\n", cpu, strerror(error));
+    }
+
+    if(options.priority > 0) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = options.priority;
+        error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if(error != 0) {
+            fprintf(stderr, "warning: SCHED_FIFO unavailable: %s (results include scheduler noise)\n", strerror(error));
+        }
+    }
+}
+
+// keeps the memory system and scheduler busy until `stop` is set
+static void background_load(std::atomic<bool>* stop) {
+    const size_t size = 64 << 20;
+    std::vector<char> buffer(size);
+
+    for(unsigned int round = 0; !stop->load(std::memory_order_relaxed); round++) {
+        // stream through a buffer much bigger than the caches...
+        for(size_t i = 0; i < size; i += 64) {
+            buffer[i] = (char)(buffer[i] + round);
+        }
+        // ...with some system calls mixed in
+        getpid();
+        sched_yield();
+    }
+}
+
+
+
+/*
+    Entry points under test
+
+    Each one is called `iterations` times. Only the call itself is timed;
+    any setup it needs (refilling or draining queues) happens outside the
+    timed region.
+*/
+static void record_kins_pose(histogram* h, uint64_t iterations) {
+    double scale_factors[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        scale_factors[i] = 1000;
+    }
+    rtmc_kins_scalar_setup(scale_factors);
+
+    // an arc with every other axis holding still
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_TRIGONOMETRIC;
+    path.feed_rate = 100;
+    path.coefficients[RTMC_X_AXIS][0] = 10;
+    path.coefficients[RTMC_X_AXIS][1] = RTMC_PI / 2;
+    path.coefficients[RTMC_X_AXIS][2] = -1;
+    path.coefficients[RTMC_Y_AXIS][0] = 10;
+    path.coefficients[RTMC_Y_AXIS][1] = RTMC_PI / 2;
+    rtmc_kins_scalar_load(path);
+
+    double pose[RTMC_NUM_AXES];
+    double s = 0;
+    for(uint64_t i = 0; i < WARMUP_ITERATIONS + iterations; i++) {
+        uint64_t start = read_clock();
+        rtmc_kins_scalar_pose(pose, s);
+        uint64_t end = read_clock();
+
+        if(i >= WARMUP_ITERATIONS)
+            h->record(ticks_to_ns(end - start));
+        s = (s < 1) ? s + 0.0001 : 0;
+    }
+}
+
+static void record_path_dequeue(histogram* h, uint64_t iterations) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.feed_rate = 100;
+
+    for(uint64_t i = 0; i < WARMUP_ITERATIONS + iterations; i++) {
+        if(i % DEQUEUE_BATCH == 0) {
+            for(int j = 0; j < DEQUEUE_BATCH; j++) {
+                rtmc_path_enqueue(&queue, path);
+            }
+        }
+
+        uint64_t start = read_clock();
+        rtmc_path_t dequeued = rtmc_path_dequeue(&queue);
+        uint64_t end = read_clock();
+
+        if(i >= WARMUP_ITERATIONS)
+            h->record(ticks_to_ns(end - start));
+        asm volatile("" : : "r"(&dequeued) : "memory");
+    }
+
+    rtmc_flush_path_queue(&queue);
+}
+
+static void record_parse(histogram* h, uint64_t iterations) {
+    std::vector<std::string> blocks = generate_blocks(10000, cam_mix, BENCH_SEED);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    size_t block = 0;
+    for(uint64_t i = 0; i < WARMUP_ITERATIONS + iterations; i++) {
+        uint64_t start = read_clock();
+        rtmc_parse_ctx(parser, &queue, blocks[block].c_str());
+        uint64_t end = read_clock();
+
+        if(i >= WARMUP_ITERATIONS)
+            h->record(ticks_to_ns(end - start));
+
+        while(rtmc_path_queue_front(&queue)) {
+            rtmc_path_queue_release(&queue);
+        }
+        if(++block == blocks.size()) {
+            block = 0;
+            rtmc_flush_parser_data_ctx(parser);
+        }
+    }
+
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+}
+
+// the cost of reading the clock twice (included in every measurement)
+static void record_clock_overhead(histogram* h, uint64_t iterations) {
+    for(uint64_t i = 0; i < WARMUP_ITERATIONS + iterations; i++) {
+        uint64_t start = read_clock();
+        uint64_t end = read_clock();
+
+        if(i >= WARMUP_ITERATIONS)
+            h->record(ticks_to_ns(end - start));
+    }
+}
+
+
+
+static bool parse_options(int argc, char** argv, options_t* options) {
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = strchr(arg, '=');
+        if(value == NULL) {
+            return false;
+        }
+        value++;
+
+        if(strncmp(arg, "--iterations=", 13) == 0)
+            options->iterations = strtoull(value, NULL, 10);
+        else if(strncmp(arg, "--cpu=", 6) == 0)
+            options->cpu = atoi(value);
+        else if(strncmp(arg, "--priority=", 11) == 0)
+            options->priority = atoi(value);
+        else if(strncmp(arg, "--load=", 7) == 0)
+            options->load_threads = atoi(value);
+        else if(strncmp(arg, "--budget-us=", 12) == 0)
+            options->budget_us = atof(value);
+        else if(strcmp(arg, "--clock=monotonic") == 0)
+            options->use_tsc = false;
+#ifdef HAS_TSC
+        else if(strcmp(arg, "--clock=tsc") == 0)
+            options->use_tsc = true;
+#endif
+        else
+            return false;
+    }
+
+    return options->iterations > 0;
+}
+
+static bool report(const char* name, const histogram& h, double budget_us) {
+    bool is_within_budget = (double)h.max_value() <= budget_us * 1000;
+    printf(
+        "%-16s %10llu %8.0f %8llu %8llu %8llu %8llu %8llu   %s\n", name,
+        (unsigned long long)h.total_count(), h.mean(),
+        (unsigned long long)h.percentile(50), (unsigned long long)h.percentile(99),
+        (unsigned long long)h.percentile(99.9), (unsigned long long)h.percentile(99.99),
+        (unsigned long long)h.max_value(), is_within_budget ? "ok" : "OVER BUDGET"
+    );
+    return is_within_budget;
+}
+
+int main(int argc, char** argv) {
+    options_t options;
+    if(!parse_options(argc, argv, &options)) {
+        fprintf(stderr, "usage: %s [--iterations=N] [--cpu=N] [--priority=N] [--load=N] [--budget-us=X] [--clock=tsc|monotonic]\n", argv[0]);
+        return 2;
+    }
+
+    use_tsc = options.use_tsc;
+    calibrate_clock();
+
+    // start the load first, so it doesn't inherit the real-time setup
+    std::atomic<bool> stop_load(false);
+    std::vector<std::thread> load_threads;
+    for(int i = 0; i < options.load_threads; i++) {
+        load_threads.emplace_back(background_load, &stop_load);
+    }
+
+    setup_realtime_thread(options);
+
+    // histograms are big, so they live on the heap (allocated before timing)
+    std::vector<histogram> histograms(4);
+    record_clock_overhead(&histograms[0], options.iterations);
+    record_kins_pose(&histograms[1], options.iterations);
+    record_path_dequeue(&histograms[2], options.iterations);
+    record_parse(&histograms[3], options.iterations);
+
+    stop_load = true;
+    for(std::thread& thread : load_threads) {
+        thread.join();
+    }
+
+    printf("clock: %s, load threads: %d, budget: %.0f us\n\n",
+        use_tsc ? "tsc" : "monotonic", options.load_threads, options.budget_us);
+    printf("%-16s %10s %8s %8s %8s %8s %8s %8s   (ns)\n",
+        "entry point", "calls", "mean", "p50", "p99", "p99.9", "p99.99", "max");
+
+    report("(clock overhead)", histograms[0], options.budget_us);
+    bool is_within_budget = true;
+    is_within_budget &= report("kins_pose", histograms[1], options.budget_us);
+    is_within_budget &= report("path_dequeue", histograms[2], options.budget_us);
+    is_within_budget &= report("parse", histograms[3], options.budget_us);
+
+    return is_within_budget ? 0 : 1;
+}
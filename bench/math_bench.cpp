@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+#include "rtmc_magic_numbers.h"
+#include "rtmc_math.h"
+
+// vectors of every size the library uses (3D and one entry per axis)
+struct vectors {
+    double v1[RTMC_NUM_AXES];
+    double v2[RTMC_NUM_AXES];
+    double result[RTMC_NUM_AXES];
+
+    vectors() {
+        for(int i = 0; i < RTMC_NUM_AXES; i++) {
+            v1[i] = 1.25 * (i + 1);
+            v2[i] = -0.75 * (i + 2);
+        }
+    }
+};
+
+static void BM_DotProduct(benchmark::State& state) {
+    vectors v;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(rtmc_dot_product(v.v1, v.v2, (int)state.range(0)));
+    }
+}
+BENCHMARK(BM_DotProduct)->Arg(3)->Arg(RTMC_NUM_AXES);
+
+static void BM_CrossProduct(benchmark::State& state) {
+    vectors v;
+    for(auto _ : state) {
+        rtmc_cross_product(v.result, v.v1, v.v2, 3);
+        benchmark::DoNotOptimize(v.result);
+    }
+}
+BENCHMARK(BM_CrossProduct);
+
+static void BM_VectorAddition(benchmark::State& state) {
+    vectors v;
+    for(auto _ : state) {
+        rtmc_vector_addition(v.result, v.v1, v.v2, (int)state.range(0));
+        benchmark::DoNotOptimize(v.result);
+    }
+}
+BENCHMARK(BM_VectorAddition)->Arg(3)->Arg(RTMC_NUM_AXES);
+
+static void BM_ScalarMultiplication(benchmark::State& state) {
+    vectors v;
+    for(auto _ : state) {
+        rtmc_scalar_multiplication(v.result, v.v1, 1.5, (int)state.range(0));
+        benchmark::DoNotOptimize(v.result);
+    }
+}
+BENCHMARK(BM_ScalarMultiplication)->Arg(3)->Arg(RTMC_NUM_AXES);
+
+static void BM_VectorMagnitude(benchmark::State& state) {
+    vectors v;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(rtmc_vector_magnitude(v.v1, (int)state.range(0)));
+    }
+}
+BENCHMARK(BM_VectorMagnitude)->Arg(3)->Arg(RTMC_NUM_AXES);
+
+static void BM_UnitVector(benchmark::State& state) {
+    vectors v;
+    for(auto _ : state) {
+        rtmc_unit_vector(v.result, v.v1, (int)state.range(0));
+        benchmark::DoNotOptimize(v.result);
+    }
+}
+BENCHMARK(BM_UnitVector)->Arg(3)->Arg(RTMC_NUM_AXES);
+
+static void BM_Distance(benchmark::State& state) {
+    vectors v;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(rtmc_distance(v.v1, v.v2, (int)state.range(0)));
+    }
+}
+BENCHMARK(BM_Distance)->Arg(3)->Arg(RTMC_NUM_AXES);
+
+static void BM_IsDirectionEqual(benchmark::State& state) {
+    vectors v;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(rtmc_is_direction_equal(v.v1, v.v1, (int)state.range(0)));
+    }
+}
+BENCHMARK(BM_IsDirectionEqual)->Arg(3)->Arg(RTMC_NUM_AXES);
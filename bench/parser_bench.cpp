@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "program_generator.h"
+#include "rtmc_parser.h"
+#include "rtmc_path.h"
+
+// empties the queue without freeing its chunks
+static void drain(rtmc_path_queue_t* queue) {
+    while(rtmc_path_queue_front(queue)) {
+        rtmc_path_queue_release(queue);
+    }
+}
+
+// parses one block per iteration, cycling through a program
+static void parse_blocks(benchmark::State& state, const program_mix_t& mix) {
+    std::vector<std::string> blocks = generate_blocks(10000, mix, BENCH_SEED);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    size_t i = 0;
+    size_t num_bytes = 0;
+    for(auto _ : state) {
+        rtmc_parsed_block_t parsed_block = rtmc_parse_ctx(parser, &queue, blocks[i].c_str());
+        benchmark::DoNotOptimize(parsed_block);
+        num_bytes += blocks[i].size();
+
+        if(++i == blocks.size()) {
+            state.PauseTiming();
+            i = 0;
+            drain(&queue);
+            rtmc_flush_parser_data_ctx(parser);
+            state.ResumeTiming();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(num_bytes);
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+}
+
+static void BM_Parse_CamMix(benchmark::State& state) {
+    parse_blocks(state, cam_mix);
+}
+BENCHMARK(BM_Parse_CamMix);
+
+static void BM_Parse_LongDecimals(benchmark::State& state) {
+    parse_blocks(state, long_decimal_mix);
+}
+BENCHMARK(BM_Parse_LongDecimals);
+
+static void BM_Parse_Arcs(benchmark::State& state) {
+    parse_blocks(state, program_mix_t{0, 0, 100, 0, 4});
+}
+BENCHMARK(BM_Parse_Arcs);
+
+
+
+// whole-program parsing (the argument is the number of blocks)
+static void BM_ParseBuffer(benchmark::State& state) {
+    std::string program = generate_program(state.range(0), cam_mix, BENCH_SEED);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    for(auto _ : state) {
+        rtmc_flush_parser_data_ctx(parser);
+        benchmark::DoNotOptimize(rtmc_parse_buffer(parser, &queue, program.data(), program.size(), NULL, 0));
+
+        state.PauseTiming();
+        drain(&queue);
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * program.size());
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+}
+BENCHMARK(BM_ParseBuffer)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// the arguments are the number of blocks and threads
+static void BM_ParseBufferParallel(benchmark::State& state) {
+    std::string program = generate_program(state.range(0), cam_mix, BENCH_SEED);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_parse_pool_t* pool = rtmc_create_parse_pool((int)state.range(1));
+
+    for(auto _ : state) {
+        rtmc_flush_parser_data_ctx(parser);
+        benchmark::DoNotOptimize(rtmc_parse_buffer_parallel(
+            parser, &queue, program.data(), program.size(), NULL, 0, pool
+        ));
+
+        state.PauseTiming();
+        drain(&queue);
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * program.size());
+    rtmc_destroy_parse_pool(pool);
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+}
+BENCHMARK(BM_ParseBufferParallel)
+    ->ArgsProduct({{1000000}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// the arguments are the number of blocks and the chunk size
+static void BM_ParseStream(benchmark::State& state) {
+    std::string program = generate_program(state.range(0), cam_mix, BENCH_SEED);
+    size_t chunk_size = (size_t)state.range(1);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    for(auto _ : state) {
+        rtmc_flush_parser_data_ctx(parser);
+        for(size_t i = 0; i < program.size(); i += chunk_size) {
+            size_t length = std::min(chunk_size, program.size() - i);
+            benchmark::DoNotOptimize(rtmc_parse_stream(parser, &queue, program.data() + i, length, NULL, 0));
+        }
+        rtmc_end_stream(parser, &queue, NULL, 0);
+
+        state.PauseTiming();
+        drain(&queue);
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * program.size());
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+}
+BENCHMARK(BM_ParseStream)->ArgsProduct({{100000}, {64, 4096}})->Unit(benchmark::kMillisecond);
@@ -0,0 +1,121 @@
+#include <string.h>
+#include <benchmark/benchmark.h>
+#include "rtmc_path.h"
+#include "rtmc_path_ring.h"
+#include "rtmc_path_sparse.h"
+#include "rtmc_path_spsc.h"
+
+// a line that only moves X and Y (typical of 2.5D CAM output)
+static rtmc_path_t make_path(double x) {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_POLYNOMIAL;
+    path.feed_rate = 100;
+    path.coefficients[RTMC_X_AXIS][2] = 1;
+    path.coefficients[RTMC_X_AXIS][3] = x;
+    path.coefficients[RTMC_Y_AXIS][2] = -1;
+    path.coefficients[RTMC_Y_AXIS][3] = 2 * x;
+    return path;
+}
+
+// the argument is the number of paths queued at once
+static void BM_PathQueue_EnqueueDequeue(benchmark::State& state) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_path_t path = make_path(1);
+
+    for(auto _ : state) {
+        for(int64_t i = 0; i < state.range(0); i++) {
+            rtmc_path_enqueue(&queue, path);
+        }
+        for(int64_t i = 0; i < state.range(0); i++) {
+            benchmark::DoNotOptimize(rtmc_path_dequeue(&queue));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    rtmc_flush_path_queue(&queue);
+}
+BENCHMARK(BM_PathQueue_EnqueueDequeue)->Arg(1)->Arg(1000);
+
+static void BM_PathQueue_ZeroCopy(benchmark::State& state) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    for(auto _ : state) {
+        for(int64_t i = 0; i < state.range(0); i++) {
+            rtmc_path_t* slot = rtmc_path_queue_reserve(&queue);
+            slot->type = RTMC_PATH_TYPE_POLYNOMIAL;
+            slot->feed_rate = 100;
+            slot->coefficients[RTMC_X_AXIS][3] = (double)i;
+            rtmc_path_queue_commit(&queue);
+        }
+        for(int64_t i = 0; i < state.range(0); i++) {
+            benchmark::DoNotOptimize(rtmc_path_queue_front(&queue)->coefficients[RTMC_X_AXIS][3]);
+            rtmc_path_queue_release(&queue);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    rtmc_flush_path_queue(&queue);
+}
+BENCHMARK(BM_PathQueue_ZeroCopy)->Arg(1)->Arg(1000);
+
+static void BM_PathRing_EnqueueDequeue(benchmark::State& state) {
+    static rtmc_path_t buffer[1024];
+    rtmc_path_ring_t ring = rtmc_create_path_ring(buffer, 1024);
+    rtmc_path_t path = make_path(1);
+    rtmc_path_t output;
+
+    for(auto _ : state) {
+        for(int64_t i = 0; i < state.range(0); i++) {
+            rtmc_path_ring_enqueue(&ring, path);
+        }
+        for(int64_t i = 0; i < state.range(0); i++) {
+            rtmc_path_ring_dequeue(&ring, &output);
+            benchmark::DoNotOptimize(output);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    rtmc_flush_path_ring(&ring);
+}
+BENCHMARK(BM_PathRing_EnqueueDequeue)->Arg(1)->Arg(1000);
+
+static void BM_PathSpsc_EnqueueDequeue(benchmark::State& state) {
+    static rtmc_path_t buffer[1024];
+    static rtmc_path_spsc_t spsc; // cache line aligned (which `new` isn't in C++14)
+    rtmc_init_path_spsc(&spsc, buffer, 1024);
+    rtmc_path_t path = make_path(1);
+    rtmc_path_t output;
+
+    for(auto _ : state) {
+        for(int64_t i = 0; i < state.range(0); i++) {
+            rtmc_path_spsc_enqueue(&spsc, path);
+        }
+        for(int64_t i = 0; i < state.range(0); i++) {
+            rtmc_path_spsc_dequeue(&spsc, &output);
+            benchmark::DoNotOptimize(output);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    rtmc_flush_path_spsc(&spsc);
+}
+BENCHMARK(BM_PathSpsc_EnqueueDequeue)->Arg(1)->Arg(1000);
+
+static void BM_SparsePathQueue_EnqueueDequeue(benchmark::State& state) {
+    rtmc_sparse_path_queue_t queue = rtmc_create_sparse_path_queue();
+
+    for(auto _ : state) {
+        // consecutive paths, so the idle axes stay idle
+        for(int64_t i = 0; i < state.range(0); i++) {
+            rtmc_sparse_path_enqueue(&queue, make_path((double)i));
+        }
+        for(int64_t i = 0; i < state.range(0); i++) {
+            benchmark::DoNotOptimize(rtmc_sparse_path_dequeue(&queue));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    rtmc_flush_sparse_path_queue(&queue);
+}
+BENCHMARK(BM_SparsePathQueue_EnqueueDequeue)->Arg(1)->Arg(1000);
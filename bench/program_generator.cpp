@@ -0,0 +1,87 @@
+/*
+    bench/program_generator.cpp
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <random>
+#include "program_generator.h"
+
+const program_mix_t cam_mix = {10, 70, 15, 5, 4};
+const program_mix_t long_decimal_mix = {0, 100, 0, 0, 15};
+
+// formats a word like "X12.3456"
+static std::string word(char key, double value, int decimal_places) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%c%.*f", key, decimal_places, value);
+    return buffer;
+}
+
+std::vector<std::string> generate_blocks(size_t num_blocks, const program_mix_t& mix, uint64_t seed) {
+    // std::mt19937_64 is fully specified, so it's the same everywhere
+    std::mt19937_64 random(seed);
+    auto uniform = [&](double min, double max) {
+        return min + (max - min) * (double)(random() >> 11) / (double)(1ULL << 53);
+    };
+
+    std::vector<std::string> blocks;
+    blocks.reserve(num_blocks + 2);
+    blocks.push_back("G17 G90");
+    blocks.push_back("G01 F1000");
+
+    // the tool wanders around a 100 x 100 x 20 work area
+    double x = 0, y = 0, z = 0;
+    int places = mix.decimal_places;
+    for(size_t i = 0; i < num_blocks; i++) {
+        int choice = (int)(random() % 100);
+
+        if(choice < mix.rapid_percent) {
+            x = uniform(0, 100);
+            y = uniform(0, 100);
+            z = uniform(5, 20);
+            blocks.push_back("G00 " + word('X', x, places) + " " + word('Y', y, places) + " " + word('Z', z, places));
+        }
+        else if(choice < mix.rapid_percent + mix.line_percent) {
+            x += uniform(-2, 2);
+            y += uniform(-2, 2);
+            z = uniform(0, 5);
+            blocks.push_back("G01 " + word('X', x, places) + " " + word('Y', y, places) + " " + word('Z', z, places));
+        }
+        else if(choice < mix.rapid_percent + mix.line_percent + mix.arc_percent) {
+            // pick a center, then an end point on the same circle
+            double i_offset = uniform(-5, 5);
+            double j_offset = uniform(-5, 5);
+            double radius = sqrt(i_offset * i_offset + j_offset * j_offset);
+            double angle = uniform(0, 2 * M_PI);
+            if(radius < 0.1) {
+                i_offset = radius = 1;
+                j_offset = 0;
+            }
+
+            double end_x = x + i_offset + radius * cos(angle);
+            double end_y = y + j_offset + radius * sin(angle);
+            blocks.push_back(
+                std::string((random() % 2) ? "G02 " : "G03 ") +
+                word('X', end_x, places) + " " + word('Y', end_y, places) + " " +
+                word('I', i_offset, places) + " " + word('J', j_offset, places)
+            );
+            x = end_x;
+            y = end_y;
+        }
+        else {
+            blocks.push_back("G01 " + word('F', uniform(200, 2000), 1));
+        }
+    }
+
+    return blocks;
+}
+
+std::string generate_program(size_t num_blocks, const program_mix_t& mix, uint64_t seed) {
+    std::string program;
+    for(const std::string& block : generate_blocks(num_blocks, mix, seed)) {
+        program += block;
+        program += '\n';
+    }
+
+    return program;
+}
@@ -0,0 +1,44 @@
+/*
+    bench/program_generator.h
+
+    Generates synthetic g-code programs that look like CAM output (mostly
+    short G01 moves with long decimals, plus rapids, arcs, and feed rate
+    changes). Every generator takes a seed, and the same seed always gives
+    the same program, so benchmark results can be compared across commits.
+*/
+
+#ifndef PROGRAM_GENERATOR_H
+#define PROGRAM_GENERATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// default seed used by the benchmarks
+#define BENCH_SEED 0x5EED
+
+/*
+    Mix of blocks in a CAM-style program (percentages should add to 100)
+*/
+typedef struct {
+    int rapid_percent; // G00
+    int line_percent; // G01
+    int arc_percent; // G02/G03 (always valid, IJK form)
+    int feed_percent; // F-word only
+    int decimal_places; // digits after the decimal point
+} program_mix_t;
+
+// roughly what a 3-axis finishing toolpath looks like
+extern const program_mix_t cam_mix;
+
+// lines only, with very long decimals
+extern const program_mix_t long_decimal_mix;
+
+// returns the program's blocks (without line terminators)
+std::vector<std::string> generate_blocks(size_t num_blocks, const program_mix_t& mix, uint64_t seed);
+
+// returns the whole program, one block per line ("\n" terminated)
+std::string generate_program(size_t num_blocks, const program_mix_t& mix, uint64_t seed);
+
+#endif // PROGRAM_GENERATOR_H
@@ -0,0 +1,66 @@
+/*
+    rtmc_alloc.h
+
+    Control over the library's heap use, for proving that nothing called
+    from a servo loop allocates.
+
+    Every allocation the library makes goes through one allocator, which
+    can be replaced (e.g., with a pool that's filled at startup). Code that
+    must never touch the heap can be wrapped in a real-time section: any
+    allocation or free inside one prints a message and aborts, so a
+    violation can't go unnoticed.
+
+    Both features need the library to be built with the `RTMC_ALLOC_HOOKS`
+    CMake option (on by default). Without it, the library calls `malloc()`
+    and `free()` directly, and these functions have no effect.
+*/
+
+#ifndef RTMC_ALLOC_H
+#define RTMC_ALLOC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+    A custom allocator. The functions have the same meaning (and alignment
+    guarantees) as `malloc()`, `realloc()`, and `free()`, and `user_data` is
+    passed to each of them.
+*/
+typedef struct {
+    void* (*allocate)(size_t size, void* user_data);
+    void* (*reallocate)(void* pointer, size_t size, void* user_data);
+    void (*deallocate)(void* pointer, void* user_data);
+    void* user_data;
+} rtmc_allocator_t;
+
+/*
+    Use `allocator` for all allocations from now on (or the C library's
+    allocator if NULL). Set it before creating any queues, parsers, etc.,
+    since memory must be freed by the allocator that allocated it.
+*/
+void rtmc_set_allocator(const rtmc_allocator_t* allocator);
+
+/*
+    Real-time sections (per thread). Any allocation or free by the library
+    between `rtmc_enter_rt_section()` and `rtmc_exit_rt_section()` on the
+    same thread aborts the program. Sections can be nested.
+*/
+void rtmc_enter_rt_section();
+void rtmc_exit_rt_section();
+
+// returns true if the calling thread is in a real-time section
+bool rtmc_is_in_rt_section();
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTMC_ALLOC_H
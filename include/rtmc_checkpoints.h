@@ -0,0 +1,92 @@
+/*
+    rtmc_checkpoints.h
+
+    Snapshots of the parser's modal state (modes, feed rate, and position)
+    taken every few lines while a program is parsed. To restart a program
+    partway through (e.g., after a tool break), the nearest snapshot is
+    loaded and only the lines between it and the restart line are parsed, so
+    restarting near the end of a long program is as fast as near the start.
+
+    Checkpoints can be kept in memory or saved next to the program file.
+*/
+
+#ifndef RTMC_CHECKPOINTS_H
+#define RTMC_CHECKPOINTS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "rtmc_parser.h"
+
+typedef struct rtmc_checkpoints rtmc_checkpoints_t;
+
+// create an empty set of checkpoints, one every `interval` lines (NULL if
+// out of memory or `interval` is 0)
+rtmc_checkpoints_t* rtmc_create_checkpoints(size_t interval);
+
+// free a set of checkpoints
+void rtmc_destroy_checkpoints(rtmc_checkpoints_t* checkpoints);
+
+// returns the number of checkpoints recorded
+size_t rtmc_checkpoint_count(const rtmc_checkpoints_t* checkpoints);
+
+/*
+    Record checkpoints while parsing with the given parser context (or stop
+    recording if `checkpoints` is NULL). Checkpoints are taken before lines
+    1, 1 + interval, 1 + 2*interval, etc. by `rtmc_parse_buffer()`,
+    `rtmc_parse_buffer_parallel()`, and `rtmc_parse_file()`.
+
+    Parsing a program again replaces its checkpoints from the first line
+    parsed onward. The checkpoints must outlive the parser or be detached
+    (`rtmc_restore_checkpoint()` also detaches them).
+*/
+void rtmc_set_parser_checkpoints(rtmc_parser_t* parser, rtmc_checkpoints_t* checkpoints);
+
+/*
+    Prepare the parser context to resume the program in `buffer` at `line`.
+    The nearest checkpoint at or before `line` is loaded, and the lines in
+    between are parsed without enqueuing anything.
+
+    Arguments:
+    checkpoints - checkpoints recorded while parsing the same program
+    parser - the parser context to restore
+    buffer - the g-code program
+    length - number of chars in `buffer`
+    line - the first line to run (line numbers start at 1)
+    offset - receives the index of `line` within `buffer`
+
+    Returns false if `line` is past the end of the program, or comes before
+    the first checkpoint. To finish the program, parse
+    `buffer + *offset`; errors from that are numbered from 1 at `line`.
+
+    Restoring stops the parser from recording checkpoints (the rest of the
+    program is numbered from `line`, so it would replace them with wrong
+    ones). The same checkpoints can be restored from again, even with the
+    same parser; call `rtmc_set_parser_checkpoints()` again before parsing
+    the whole program.
+*/
+bool rtmc_restore_checkpoint(
+    const rtmc_checkpoints_t* checkpoints, rtmc_parser_t* parser,
+    const char* buffer, size_t length, size_t line, size_t* offset
+);
+
+/*
+    Save checkpoints to a file, or load them back (NULL if the file can't be
+    read or wasn't saved by this build of the library). The file stores
+    doubles in native byte order, so it's only meant for the same machine.
+*/
+bool rtmc_save_checkpoints(const rtmc_checkpoints_t* checkpoints, const char* filename);
+rtmc_checkpoints_t* rtmc_load_checkpoints(const char* filename);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTMC_CHECKPOINTS_H
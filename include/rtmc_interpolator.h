@@ -0,0 +1,106 @@
+/*
+    rtmc_interpolator.h
+
+    The interpolator turns queued paths into motion over time (see
+    `docs/planning.md`). Each servo tick, it advances along the paths at
+    the planned speed and outputs the joint-space pose from the kinematic
+    solver.
+
+    Speeds are planned over a look-ahead window of upcoming paths. Each path
+    gets a velocity profile (accelerate, cruise, decelerate) within the
+    per-axis limits, and consecutive paths are joined at the fastest speed
+    the corner between them allows (a corner's share of the acceleration and
+    jerk limits is taken from the paths on either side, so sharp corners are
+    taken from rest). So
+    a run of short, nearly collinear paths (typical of CAM output) is
+    followed without stopping at every path.
+*/
+
+#ifndef RTMC_INTERPOLATOR_H
+#define RTMC_INTERPOLATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "rtmc_magic_numbers.h"
+#include "rtmc_path.h"
+
+/*
+    Velocity profiles:
+     * RTMC_PROFILE_TRAPEZOIDAL     constant acceleration (the acceleration
+                                    steps between phases)
+     * RTMC_PROFILE_S_CURVE         jerk-limited (7 phases; the acceleration
+                                    ramps up and down, and is zero wherever
+                                    the motion stops or turns a corner; a
+                                    run of collinear paths is one profile)
+*/
+enum rtmc_velocity_profile {
+    RTMC_PROFILE_TRAPEZOIDAL, RTMC_PROFILE_S_CURVE
+};
+
+/*
+    How to fill out this struct:
+     * tick                 servo period (s)
+     * look_ahead           number of paths planned at once (at least 1)
+     * max_velocity         per-axis speed limits (task-space units/s)
+     * max_acceleration     per-axis acceleration limits (units/s^2)
+     * profile              shape of the velocity profiles
+     * max_jerk             per-axis jerk limits (units/s^3, only used by
+                            RTMC_PROFILE_S_CURVE)
+     * load, pose           the kinematic solver (e.g.,
+                            `rtmc_kins_scalar_load()` and
+                            `rtmc_kins_scalar_pose()`, set up beforehand)
+
+    The speed along a path is also capped by its `feed_rate` (unless it's
+    `RTMC_RAPID_RATE`). The interpolator always plans to stop at the end of
+    the look-ahead window, so a longer window allows faster motion through
+    short paths.
+*/
+typedef struct {
+    double tick;
+    size_t look_ahead;
+    double max_velocity[RTMC_NUM_AXES];
+    double max_acceleration[RTMC_NUM_AXES];
+    enum rtmc_velocity_profile profile;
+    double max_jerk[RTMC_NUM_AXES];
+    void (*load)(rtmc_path_t path);
+    void (*pose)(double* pose, double s);
+} rtmc_interpolator_config_t;
+
+typedef struct rtmc_interpolator rtmc_interpolator_t;
+
+// create an interpolator (NULL if out of memory or `config` is invalid)
+rtmc_interpolator_t* rtmc_create_interpolator(const rtmc_interpolator_config_t* config);
+
+// free an interpolator
+void rtmc_destroy_interpolator(rtmc_interpolator_t* interpolator);
+
+
+
+/*
+    Advance one tick and write the joint-space pose to `pose`. Paths are
+    dequeued from `queue` as the look-ahead window needs them.
+
+    Returns true while moving. When the queue runs dry, the last moving tick
+    ends exactly at the end of the last path, and from then on this returns
+    false without touching `pose`. More paths can be queued at any time,
+    but paths queued after the window has planned to stop will start from
+    rest.
+*/
+bool rtmc_interpolator_tick(rtmc_interpolator_t* interpolator, rtmc_path_queue_t* queue, double* pose);
+
+// returns the current speed along the path (task-space units/s)
+double rtmc_interpolator_velocity(const rtmc_interpolator_t* interpolator);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTMC_INTERPOLATOR_H
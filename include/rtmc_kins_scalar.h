@@ -15,7 +15,10 @@ extern "C" {
 
 
 
+#include <stdbool.h>
+#include <stddef.h>
 #include "rtmc_path.h"
+#include "rtmc_path_stepper.h"
 
 
 
@@ -46,6 +49,55 @@ void rtmc_kins_scalar_pose(double* pose, double s);
 
 
 
+/*
+    This function starts a stepper (see `rtmc_path_stepper.h`) along the
+    loaded path in joint space, for sampling it at evenly spaced values of
+    s (starting at `s0`) much faster than `rtmc_kins_scalar_pose()`.
+
+    `rtmc_kins_scalar_load()` must be called before this function will work.
+*/
+void rtmc_kins_scalar_stepper_init(rtmc_path_stepper_t* stepper, double s0, double ds);
+
+
+
+/*
+    This function computes the joint-space poses at `n` values of s at once
+    (e.g., for look-ahead planning, previews, or baking a path offline).
+    The pose at `s[k]` is written to `poses[k*RTMC_NUM_AXES]` onwards, so
+    `poses` must have room for `n*RTMC_NUM_AXES` values.
+
+    The poses are computed with SIMD kernels when the CPU supports them, and
+    match `rtmc_kins_scalar_pose()` to within a few ulps.
+
+    `rtmc_kins_scalar_load()` must be called before this function will work.
+*/
+void rtmc_kins_scalar_pose_batch(const double* s, size_t n, double* poses);
+
+
+
+/*
+    Kernels for `rtmc_kins_scalar_pose_batch()`:
+     * RTMC_KINS_BATCH_AUTO         the fastest one this CPU supports (the
+                                    default)
+     * RTMC_KINS_BATCH_PORTABLE     plain C (works everywhere)
+     * RTMC_KINS_BATCH_SSE2         2 values of s at a time (x86)
+     * RTMC_KINS_BATCH_AVX2         4 values of s at a time (x86 with AVX2
+                                    and FMA)
+*/
+enum rtmc_kins_batch_kernel {
+    RTMC_KINS_BATCH_AUTO, RTMC_KINS_BATCH_PORTABLE,
+    RTMC_KINS_BATCH_SSE2, RTMC_KINS_BATCH_AVX2
+};
+
+/*
+    This function picks the kernel `rtmc_kins_scalar_pose_batch()` uses
+    (e.g., to compare them). It returns false, leaving the kernel as it
+    was, if this build or CPU doesn't support the kernel.
+*/
+bool rtmc_kins_scalar_set_batch_kernel(enum rtmc_kins_batch_kernel kernel);
+
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,12 +30,52 @@ extern "C" {
 
 
 /*
-    Double types are accurate to 15 digits  (+1 sign, +1 decimal, +1 E,
-    +1 E sign). Values with more than 19 characters will be truncated.
-    
-    For long numbers, use "1E-18" instead of "0.000000000000000001".
+    Defines how many paths are stored in each chunk of a path queue. Larger
+    chunks mean fewer allocations but more unused memory in short queues.
 */
-#define RTMC_MAX_DECIMAL_LENGTH 19
+#define RTMC_PATH_CHUNK_SIZE 32
+
+
+
+/*
+    Defines the size (in bytes) of each chunk of a sparse path queue. This
+    must be large enough to hold a path with every axis active.
+*/
+#define RTMC_SPARSE_PATH_CHUNK_SIZE 16384
+
+
+
+/*
+    Size of a cache line in bytes. Data written by different threads is kept
+    at least this far apart to avoid false sharing.
+*/
+#define RTMC_CACHE_LINE_SIZE 64
+
+
+
+/*
+    Defines how many steps a path stepper takes between re-anchoring (exactly
+    evaluating the path again), which bounds the round-off that builds up.
+*/
+#define RTMC_PATH_STEPPER_ANCHOR_INTERVAL 256
+
+
+
+/*
+    Defines the default radius tolerance of a path stepper, in path units:
+    how far an arc's radius can drift before the stepper renormalizes it.
+*/
+#define RTMC_PATH_STEPPER_RADIUS_TOLERANCE 1e-9
+
+
+
+/*
+    Defines the size of each thread's trace buffer (in events, must be a
+    power of two) and how many threads can record trace events at once.
+    Only used when the library is built with `RTMC_TRACE`.
+*/
+#define RTMC_TRACE_BUFFER_SIZE 65536
+#define RTMC_TRACE_MAX_THREADS 16
 
 
 
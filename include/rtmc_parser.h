@@ -12,6 +12,7 @@ extern "C" {
 
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "rtmc_magic_numbers.h"
 #include "rtmc_path.h"
 
@@ -56,6 +57,24 @@ typedef struct {
 
 
 
+/*
+    A parser context holds the modal state that carries over between g-code
+    blocks (modes, feed rate, current position). Each context is independent,
+    so several programs can be parsed at once (e.g., one per thread).
+
+    `rtmc_parse()` and `rtmc_flush_parser_data()` use a built-in default
+    context. The `_ctx` variants behave identically on the given context.
+*/
+typedef struct rtmc_parser rtmc_parser_t;
+
+// create a parser context with flushed parser data (NULL if out of memory)
+rtmc_parser_t* rtmc_create_parser();
+
+// free a parser context
+void rtmc_destroy_parser(rtmc_parser_t* parser);
+
+
+
 /*
     Parse a g-code string (called a block) and directly add to the path queue.
     G-code blocks must be terminated with '\r', '\n', or '\0'.
@@ -65,16 +84,130 @@ typedef struct {
     block - a line of g-code
 
     A note on decimal values:
-    Decimal values with more than RTMC_MAX_DECIMAL_LENGTH characters will be
-    truncated. For long numbers, use "1E-18" instead of "0.000000000000000001".
+    Values are converted without regard to the C locale and are correctly
+    rounded. There's no length limit, but digits past the 768th significant
+    digit only affect rounding.
 */
 rtmc_parsed_block_t rtmc_parse(rtmc_path_queue_t* queue, const char* block);
+rtmc_parsed_block_t rtmc_parse_ctx(rtmc_parser_t* parser, rtmc_path_queue_t* queue, const char* block);
+
+/*
+    Records which line of a program failed to parse, and why. Line numbers
+    start at 1.
+*/
+typedef struct {
+    size_t line;
+    char* error_msg;
+} rtmc_parse_error_t;
+
+/*
+    Parse a whole g-code program in one call, adding every path to the queue.
+    Lines are split on '\r', '\n', and '\0' ("\r\n" counts as a single line
+    break), and each line is parsed exactly like `rtmc_parse_ctx()` would.
+    The buffer doesn't need to be null-terminated.
+
+    Arguments:
+    parser - the parser context
+    queue - the path queue
+    buffer - the g-code program
+    length - number of chars in `buffer`
+    errors - array that receives one entry per invalid line (may be NULL)
+    max_errors - capacity of `errors`
+
+    Returns the number of invalid lines. This can be more than `max_errors`,
+    in which case only the first `max_errors` are recorded.
+*/
+size_t rtmc_parse_buffer(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue,
+    const char* buffer, size_t length,
+    rtmc_parse_error_t* errors, size_t max_errors
+);
+
+/*
+    A pool of threads for `rtmc_parse_buffer_parallel()`. The threads are
+    started once, when the pool is created, and sleep until there's work, so
+    parsing doesn't pay to start threads each time. A pool can be shared by
+    several parsers (even at the same time).
+
+    `num_threads` is the number of threads that lex at once, counting the
+    thread calling `rtmc_parse_buffer_parallel()` (<= 0 uses one per CPU).
+*/
+typedef struct rtmc_parse_pool rtmc_parse_pool_t;
+
+// create a pool and start its threads (NULL if out of memory)
+rtmc_parse_pool_t* rtmc_create_parse_pool(int num_threads);
+
+// stop a pool's threads and free it (no parse may be using it)
+void rtmc_destroy_parse_pool(rtmc_parse_pool_t* pool);
+
+/*
+    Parse a whole g-code program like `rtmc_parse_buffer()`, but lex it on
+    several threads. The program is split into chunks at line boundaries, and
+    each chunk is split into words (and their values converted) by a thread
+    in `pool`. The calling thread then applies the words in order, so the
+    paths and errors are identical to `rtmc_parse_buffer()`.
+
+    Programs too small to benefit (and any program, if `pool` is NULL) are
+    parsed on the calling thread.
+*/
+size_t rtmc_parse_buffer_parallel(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue,
+    const char* buffer, size_t length,
+    rtmc_parse_error_t* errors, size_t max_errors, rtmc_parse_pool_t* pool
+);
+
+/*
+    Parse a g-code file. This works like `rtmc_parse_buffer()`, but parses
+    directly from a memory-mapped view of the file (on POSIX systems), so
+    large programs are neither copied nor read line by line.
+
+    If the file can't be read, a single error with line number 0 is
+    reported.
+*/
+size_t rtmc_parse_file(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue, const char* filename,
+    rtmc_parse_error_t* errors, size_t max_errors
+);
+
+/*
+    Parse g-code that arrives in pieces (e.g., over a serial link). Chunks can
+    be any size and can split blocks anywhere, even in the middle of a
+    number. Each block is parsed and its path enqueued as soon as its
+    terminator arrives, and the unfinished block at the end of a chunk is
+    kept in the parser context (not copied) until the next call.
+
+    Lines are split and parsed like `rtmc_parse_buffer()`, and are numbered
+    from 1 since the parser data was last flushed. Don't mix these calls
+    with other parse functions on the same context mid-block.
+
+    Arguments:
+    parser - the parser context
+    queue - the path queue
+    chunk - the next piece of the program
+    length - number of chars in `chunk`
+    errors - array that receives one entry per invalid line (may be NULL)
+    max_errors - capacity of `errors`
+
+    Returns the number of invalid lines that ended within this chunk.
+*/
+size_t rtmc_parse_stream(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue,
+    const char* chunk, size_t length,
+    rtmc_parse_error_t* errors, size_t max_errors
+);
+
+// ends the stream, parsing the last block if it wasn't terminated
+size_t rtmc_end_stream(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue,
+    rtmc_parse_error_t* errors, size_t max_errors
+);
 
 /*
     A g-code block's meaning depends on previous g-code blocks.
     This function clears that data.
 */
 void rtmc_flush_parser_data();
+void rtmc_flush_parser_data_ctx(rtmc_parser_t* parser);
 
 
 
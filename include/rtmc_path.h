@@ -11,6 +11,8 @@ extern "C" {
 
 
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "rtmc_magic_numbers.h"
 
 /*
@@ -36,18 +38,45 @@ typedef struct {
     double coefficients[RTMC_NUM_AXES][RTMC_NUM_PATH_COEFFICIENTS];
 } rtmc_path_t;
 
-typedef struct rtmc_path_node {
-    rtmc_path_t path;
-    struct rtmc_path_node* next;
-} rtmc_path_node_t;
+/*
+    The queue is an unrolled linked list: paths are stored contiguously in
+    chunks of `RTMC_PATH_CHUNK_SIZE`, and only the chunks are linked together.
+
+    `head_index` is the position of the oldest path within the `head` chunk.
+    `tail_index` is the number of paths stored in the `tail` chunk. Both
+    `head` and `tail` are NULL while the queue is empty.
+
+    Chunks that are emptied by `rtmc_path_dequeue()` are kept in
+    `free_chunks` and reused by `rtmc_path_enqueue()`, so a queue that has
+    reached its working size never touches the heap again.
+*/
+typedef struct rtmc_path_chunk {
+    rtmc_path_t paths[RTMC_PATH_CHUNK_SIZE];
+    struct rtmc_path_chunk* next;
+} rtmc_path_chunk_t;
 
 typedef struct {
-    rtmc_path_node_t* head;
-    rtmc_path_node_t* tail;
+    rtmc_path_chunk_t* head;
+    rtmc_path_chunk_t* tail;
+    int head_index;
+    int tail_index;
+    rtmc_path_chunk_t* free_chunks;
 } rtmc_path_queue_t;
 
 
 
+/*
+    Returns a bit mask of the axes that move along the path (bit `i` is set
+    for axis `i`). An axis is idle when its A, B, and C coefficients are all
+    zero, since it then stays at D for the whole path.
+*/
+uint16_t rtmc_path_active_axes(const rtmc_path_t* path);
+
+// returns true if `axis` uses the trigonometric form for the given path type
+bool rtmc_path_is_trigonometric_axis(enum rtmc_path_type type, int axis);
+
+
+
 // create a path queue
 rtmc_path_queue_t rtmc_create_path_queue();
 
@@ -60,7 +89,26 @@ rtmc_path_t rtmc_path_dequeue(rtmc_path_queue_t* queue);
 // returns the head of the queue without removing it
 rtmc_path_t rtmc_path_queue_peek(const rtmc_path_queue_t* queue);
 
-// deletes all paths from the queue (freeing the memory)
+/*
+    Zero-copy interface
+
+    Producer side: `rtmc_path_queue_reserve()` returns the slot where the next
+    path will be stored. Write the path directly into it, then call
+    `rtmc_path_queue_commit()` to add it to the queue. Reserving without
+    committing is allowed (the same slot is returned next time). Nothing else
+    may be done with the queue between a reserve and its commit.
+
+    Consumer side: `rtmc_path_queue_front()` returns the head of the queue (or
+    NULL if the queue is empty). The pointer stays valid until
+    `rtmc_path_queue_release()` removes the head.
+*/
+rtmc_path_t* rtmc_path_queue_reserve(rtmc_path_queue_t* queue);
+void rtmc_path_queue_commit(rtmc_path_queue_t* queue);
+const rtmc_path_t* rtmc_path_queue_front(const rtmc_path_queue_t* queue);
+void rtmc_path_queue_release(rtmc_path_queue_t* queue);
+
+// deletes all paths from the queue (freeing the memory, including any
+// chunks kept for reuse)
 void rtmc_flush_path_queue(rtmc_path_queue_t* queue);
 
 
@@ -0,0 +1,88 @@
+/*
+    rtmc_path_file.h
+
+    A binary file format for compiled programs, so a program that's run
+    often only needs to be parsed once. The file holds a header, an optional
+    block of user metadata, and the paths as an array of `rtmc_path_t`.
+
+    Reading maps the file into memory (on POSIX systems), and the paths are
+    used in place through a read-only view, so loading a program doesn't
+    depend on how many paths it has.
+*/
+
+#ifndef RTMC_PATH_FILE_H
+#define RTMC_PATH_FILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "rtmc_path.h"
+
+/*
+    Write every path in the queue to a file, in order, removing them from
+    the queue. The queue is drained even if writing fails.
+
+    Arguments:
+    filename - the file to (over)write
+    queue - the path queue
+    source_hash - identifies the source program (stored as-is)
+    metadata - bytes to store alongside the paths (may be NULL)
+    metadata_size - number of bytes in `metadata`
+
+    Returns false if the file couldn't be written.
+*/
+bool rtmc_write_path_file(
+    const char* filename, rtmc_path_queue_t* queue, uint64_t source_hash,
+    const void* metadata, size_t metadata_size
+);
+
+/*
+    A read-only view of a path file. `paths` points straight into the mapped
+    file, and `index` is the position of the next path to read (the view
+    can be read like a queue with the functions below, or indexed
+    directly).
+
+    The view (and everything it points to) is valid until
+    `rtmc_close_path_view()`.
+*/
+typedef struct {
+    const rtmc_path_t* paths;
+    size_t count;
+    size_t index;
+    uint64_t source_hash;
+    const void* metadata;
+    size_t metadata_size;
+
+    // private
+    void* data;
+    size_t data_size;
+} rtmc_path_view_t;
+
+/*
+    Open a path file. Returns false if the file can't be read, is
+    truncated, or was written with a different path layout or version.
+*/
+bool rtmc_open_path_view(rtmc_path_view_t* view, const char* filename);
+
+// returns the next path (or NULL once every path has been read)
+const rtmc_path_t* rtmc_path_view_front(const rtmc_path_view_t* view);
+
+// moves on to the next path
+void rtmc_path_view_release(rtmc_path_view_t* view);
+
+// unmaps the file (an all-zero view is treated as already closed)
+void rtmc_close_path_view(rtmc_path_view_t* view);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTMC_PATH_FILE_H
@@ -0,0 +1,67 @@
+/*
+    rtmc_path_ring.h
+
+    A fixed-capacity path queue backed by a caller-provided array. Unlike
+    `rtmc_path_queue_t`, the ring never allocates memory, so it is safe to use
+    inside the real-time loop. Instead of growing, it reports when it is full
+    or empty.
+*/
+
+#ifndef RTMC_PATH_RING_H
+#define RTMC_PATH_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "rtmc_path.h"
+
+/*
+    `head` and `tail` are free-running counters. They are only wrapped (using
+    `capacity - 1` as a bit mask) when indexing into `buffer`, which is why
+    the capacity must be a power of two.
+*/
+typedef struct {
+    rtmc_path_t* buffer;
+    size_t capacity;
+    size_t head;
+    size_t tail;
+} rtmc_path_ring_t;
+
+
+
+/*
+    Create a ring using `buffer` as storage. The buffer must hold at least
+    `capacity` paths and must outlive the ring.
+
+    `capacity` should be a power of two. Other values are rounded down to the
+    nearest power of two (so the ring never indexes past the buffer).
+*/
+rtmc_path_ring_t rtmc_create_path_ring(rtmc_path_t* buffer, size_t capacity);
+
+// adds a path to the ring (returns false if the ring is full)
+bool rtmc_path_ring_enqueue(rtmc_path_ring_t* ring, rtmc_path_t path);
+
+// removes a path from the ring (returns false if the ring is empty)
+bool rtmc_path_ring_dequeue(rtmc_path_ring_t* ring, rtmc_path_t* path);
+
+// copies the head of the ring without removing it (false if empty)
+bool rtmc_path_ring_peek(const rtmc_path_ring_t* ring, rtmc_path_t* path);
+
+// returns the number of paths in the ring
+size_t rtmc_path_ring_size(const rtmc_path_ring_t* ring);
+
+// removes all paths from the ring (the buffer itself is left untouched)
+void rtmc_flush_path_ring(rtmc_path_ring_t* ring);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTMC_PATH_RING_H
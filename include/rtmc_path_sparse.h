@@ -0,0 +1,73 @@
+/*
+    rtmc_path_sparse.h
+
+    A compact path queue for storing long programs. Most g-code blocks only
+    move a few axes, so rather than storing every coefficient, each path is
+    stored as a bit mask of its active axes followed by the coefficients of
+    those axes. Idle axes are only stored as queue state (their current
+    position), which is restored when a path is dequeued.
+
+    Paths go in and come out as ordinary `rtmc_path_t` structs.
+*/
+
+#ifndef RTMC_PATH_SPARSE_H
+#define RTMC_PATH_SPARSE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+#include <stddef.h>
+#include "rtmc_magic_numbers.h"
+#include "rtmc_path.h"
+
+/*
+    Paths are packed back-to-back into chunks of
+    `RTMC_SPARSE_PATH_CHUNK_SIZE` bytes. The chunk layout is private to
+    `path_sparse.c`.
+
+    `tail_pose` holds each axis's position at the end of the newest path, and
+    `head_pose` holds each axis's position at the end of the most recently
+    dequeued path. An axis is only stored as idle if its position matches
+    `tail_pose` exactly, so the dequeue side can always rebuild it.
+*/
+struct rtmc_sparse_path_chunk;
+
+typedef struct {
+    struct rtmc_sparse_path_chunk* head;
+    struct rtmc_sparse_path_chunk* tail;
+    size_t head_offset;
+    struct rtmc_sparse_path_chunk* free_chunks;
+    double head_pose[RTMC_NUM_AXES];
+    double tail_pose[RTMC_NUM_AXES];
+} rtmc_sparse_path_queue_t;
+
+
+
+// create a sparse path queue (every axis starts at position 0)
+rtmc_sparse_path_queue_t rtmc_create_sparse_path_queue();
+
+// adds a path to the queue
+void rtmc_sparse_path_enqueue(rtmc_sparse_path_queue_t* queue, rtmc_path_t path);
+
+// removes and returns a path from the queue
+rtmc_path_t rtmc_sparse_path_dequeue(rtmc_sparse_path_queue_t* queue);
+
+// returns the head of the queue without removing it
+rtmc_path_t rtmc_sparse_path_queue_peek(const rtmc_sparse_path_queue_t* queue);
+
+// returns the number of bytes of chunk memory held by the queue
+size_t rtmc_sparse_path_queue_memory(const rtmc_sparse_path_queue_t* queue);
+
+// deletes all paths from the queue (freeing the memory)
+void rtmc_flush_sparse_path_queue(rtmc_sparse_path_queue_t* queue);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTMC_PATH_SPARSE_H
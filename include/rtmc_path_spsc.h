@@ -0,0 +1,98 @@
+/*
+    rtmc_path_spsc.h
+
+    A lock-free, single-producer/single-consumer path queue. One thread (e.g.,
+    the parser) enqueues while another thread (e.g., the servo loop) dequeues.
+    Both operations are wait-free and never allocate memory.
+
+    Only the producer thread may call `rtmc_path_spsc_enqueue()`. Only the
+    consumer thread may call `rtmc_path_spsc_dequeue()`,
+    `rtmc_path_spsc_peek()`, and `rtmc_flush_path_spsc()`.
+*/
+
+#ifndef RTMC_PATH_SPSC_H
+#define RTMC_PATH_SPSC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "rtmc_magic_numbers.h"
+#include "rtmc_path.h"
+
+/*
+    The indices are C11 atomics. C++ code sees them as plain `size_t` (which
+    has the same layout) and must only access them through the functions
+    below.
+*/
+#ifdef __cplusplus
+#define RTMC_ATOMIC_SIZE_T size_t
+#define RTMC_CACHE_ALIGNED alignas(RTMC_CACHE_LINE_SIZE)
+#else
+#include <stdatomic.h>
+#define RTMC_ATOMIC_SIZE_T atomic_size_t
+#define RTMC_CACHE_ALIGNED _Alignas(RTMC_CACHE_LINE_SIZE)
+#endif
+
+/*
+    `head` is written by the consumer and `tail` by the producer. Each index
+    sits on its own cache line, next to a cached copy of the other index that
+    only its owner touches. The cached copies let each side skip reading the
+    other side's cache line until the queue looks full (or empty).
+
+    The struct is aligned to a cache line (so the size is padded to a whole
+    number of them). Allocate it with `aligned_alloc()` (or C++17 `new`) when
+    it isn't a global or local variable.
+*/
+typedef struct {
+    rtmc_path_t* buffer;
+    size_t capacity;
+
+    // consumer's cache line
+    RTMC_CACHE_ALIGNED RTMC_ATOMIC_SIZE_T head;
+    size_t cached_tail;
+
+    // producer's cache line
+    RTMC_CACHE_ALIGNED RTMC_ATOMIC_SIZE_T tail;
+    size_t cached_head;
+} rtmc_path_spsc_t;
+
+
+
+/*
+    Initialize a queue using `buffer` as storage. This must be done before
+    either thread uses the queue. The buffer must hold at least `capacity`
+    paths and must outlive the queue.
+
+    `capacity` should be a power of two. Other values are rounded down to the
+    nearest power of two.
+*/
+void rtmc_init_path_spsc(rtmc_path_spsc_t* queue, rtmc_path_t* buffer, size_t capacity);
+
+// (producer) adds a path to the queue (returns false if the queue is full)
+bool rtmc_path_spsc_enqueue(rtmc_path_spsc_t* queue, rtmc_path_t path);
+
+// (consumer) removes a path from the queue (returns false if it's empty)
+bool rtmc_path_spsc_dequeue(rtmc_path_spsc_t* queue, rtmc_path_t* path);
+
+// (consumer) copies the head of the queue without removing it
+bool rtmc_path_spsc_peek(rtmc_path_spsc_t* queue, rtmc_path_t* path);
+
+// returns the number of paths in the queue (may be stale by the time it
+// returns if the other thread is active)
+size_t rtmc_path_spsc_size(rtmc_path_spsc_t* queue);
+
+// (consumer) removes all paths that have been enqueued so far
+void rtmc_flush_path_spsc(rtmc_path_spsc_t* queue);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTMC_PATH_SPSC_H
@@ -0,0 +1,76 @@
+/*
+    rtmc_path_stepper.h
+
+    Evaluates a path at evenly spaced values of s (s0, s0 + ds, s0 + 2*ds,
+    ...), which is how a servo loop samples a path. Each step reuses the
+    last one instead of evaluating the path from scratch:
+     * polynomial axes are advanced with forward differences (three
+       additions per axis)
+     * trigonometric axes (arcs and helices) are advanced by rotating
+       (sin, cos) of their angle through B*ds, so stepping never calls
+       `sin()` or `cos()`
+
+    Round-off builds up with every step. Polynomial axes are re-anchored
+    (evaluated exactly) every `RTMC_PATH_STEPPER_ANCHOR_INTERVAL` steps.
+    Trigonometric axes are renormalized whenever the radius has drifted by
+    more than the radius tolerance (the angle itself drifts by far less).
+*/
+
+#ifndef RTMC_PATH_STEPPER_H
+#define RTMC_PATH_STEPPER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+#include <stdint.h>
+#include "rtmc_magic_numbers.h"
+#include "rtmc_path.h"
+
+/*
+    The fields are internal. For each polynomial axis, `value` is p(s), and
+    `differences` holds its first, second, and third forward differences.
+    For each trigonometric axis, `phase` holds sin and cos of B*(s - C),
+    `rotation` holds cos and sin of B*ds, and `max_drift` is how far the
+    squared length of `phase` can drift from 1 before it's renormalized.
+*/
+typedef struct {
+    rtmc_path_t path;
+    uint16_t trigonometric_axes; // bit mask
+    double s0;
+    double ds;
+    uint64_t step; // steps taken since init
+    uint32_t steps_until_anchor;
+    double value[RTMC_NUM_AXES];
+    double differences[RTMC_NUM_AXES][3];
+    double phase[RTMC_NUM_AXES][2];
+    double rotation[RTMC_NUM_AXES][2];
+    double max_drift[RTMC_NUM_AXES];
+} rtmc_path_stepper_t;
+
+// start stepping along `path` from `s0` in steps of `ds`
+void rtmc_path_stepper_init(rtmc_path_stepper_t* stepper, const rtmc_path_t* path, double s0, double ds);
+
+/*
+    Set how far the radius of a trigonometric axis (in path units) can drift
+    before it's renormalized. `rtmc_path_stepper_init()` sets this to
+    `RTMC_PATH_STEPPER_RADIUS_TOLERANCE`.
+*/
+void rtmc_path_stepper_set_radius_tolerance(rtmc_path_stepper_t* stepper, double tolerance);
+
+/*
+    Write the pose at the current s to `pose`, then advance s by one step.
+    The first call gives the pose at `s0`. Stepping past s = 1 extrapolates
+    the path.
+*/
+void rtmc_path_stepper_next(rtmc_path_stepper_t* stepper, double* pose);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTMC_PATH_STEPPER_H
@@ -0,0 +1,82 @@
+/*
+    rtmc_program_cache.h
+
+    An on-disk cache of compiled programs (see `rtmc_path_file.h`). Programs
+    are looked up by a hash of their g-code and of the parser state they're
+    parsed from, so running a program that was parsed before only costs
+    mapping its path file.
+
+    The least recently used programs are deleted once the cache grows past
+    its size limit.
+*/
+
+#ifndef RTMC_PROGRAM_CACHE_H
+#define RTMC_PROGRAM_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rtmc_parser.h"
+#include "rtmc_path_file.h"
+
+typedef struct rtmc_program_cache rtmc_program_cache_t;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} rtmc_program_cache_stats_t;
+
+/*
+    Create a cache that stores its files in `directory` (which must already
+    exist), keeping it under `max_size` bytes. Returns NULL if out of
+    memory.
+*/
+rtmc_program_cache_t* rtmc_create_program_cache(const char* directory, uint64_t max_size);
+
+// free a cache (its files stay on disk)
+void rtmc_destroy_program_cache(rtmc_program_cache_t* cache);
+
+/*
+    Parse a whole g-code program through the cache. On a hit, the cached
+    paths are mapped and the parser context is set to the state it would
+    have after parsing the program. On a miss, the program is parsed with
+    `rtmc_parse_buffer()` and stored. Either way, if the parser context is
+    recording checkpoints (see `rtmc_checkpoints.h`), it ends up with the
+    same checkpoints as after a fresh parse.
+
+    Arguments:
+    cache - the program cache
+    parser - the parser context (its state is part of the cache key)
+    buffer - the g-code program
+    length - number of chars in `buffer`
+    view - receives the paths (close it with `rtmc_close_path_view()`)
+    errors - array that receives one entry per invalid line (may be NULL)
+    max_errors - capacity of `errors`
+
+    Returns the number of invalid lines. Programs with errors aren't cached,
+    and `view` is left empty for them. If the compiled program can't be
+    stored, a single error with line number 0 is reported and the parser
+    context is left unchanged.
+*/
+size_t rtmc_cache_parse_buffer(
+    rtmc_program_cache_t* cache, rtmc_parser_t* parser,
+    const char* buffer, size_t length, rtmc_path_view_t* view,
+    rtmc_parse_error_t* errors, size_t max_errors
+);
+
+// returns the number of hits, misses, and evictions so far
+rtmc_program_cache_stats_t rtmc_get_program_cache_stats(const rtmc_program_cache_t* cache);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTMC_PROGRAM_CACHE_H
@@ -0,0 +1,63 @@
+/*
+    rtmc_trace.h
+
+    Hot-path tracing. When the library is built with the `RTMC_TRACE` CMake
+    option, these functions are timed on every call and recorded as trace
+    events:
+     * parsing a block (`rtmc_parse()` and the other parse functions)
+     * generating a block's path
+     * adding paths to and removing them from a path queue (timed in
+       `rtmc_path_queue_commit()` and `rtmc_path_queue_release()`, which
+       `rtmc_path_enqueue()` and `rtmc_path_dequeue()` also use)
+     * `rtmc_kins_scalar_load()` and `rtmc_kins_scalar_pose()`
+
+    Each thread records into its own fixed-size ring buffer, which keeps
+    the most recent events, so recording never blocks or allocates. Up to
+    `RTMC_TRACE_MAX_THREADS` threads can record at once (a thread's buffer
+    is reused once it exits); beyond that, events are dropped and counted.
+    The events can be exported for viewing in chrome://tracing or Perfetto.
+
+    Without `RTMC_TRACE`, no trace points are compiled in at all.
+*/
+
+#ifndef RTMC_TRACE_H
+#define RTMC_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// returns true if the library was built with tracing
+bool rtmc_trace_is_enabled();
+
+// returns the number of events currently held by all threads' buffers
+size_t rtmc_trace_event_count();
+
+// returns the number of events dropped because every buffer was in use
+size_t rtmc_trace_dropped_count();
+
+/*
+    Write every buffered event to a file in the Chrome trace event format
+    (JSON). Each buffer's events get their own tid, and the dropped count
+    is written as `otherData.dropped_events`. Returns false if the file
+    can't be written or tracing is disabled. Events recorded while the dump
+    is running may be garbled, so dump while the traced threads are idle.
+*/
+bool rtmc_trace_dump_chrome(const char* filename);
+
+// discard all buffered events and reset the dropped count (same caveat as
+// `rtmc_trace_dump_chrome()`)
+void rtmc_trace_clear();
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTMC_TRACE_H
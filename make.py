@@ -7,6 +7,7 @@
 # Usage:
 #  * `./make.py` - build the library (rtmc_lib.a)
 #  * `./make.py test` - build and run tests
+#  * `./make.py bench` - build optimized and run benchmarks
 #  * `./make.py clean` - remove the build directory
 #
 
@@ -29,6 +30,11 @@ if(args):
     elif(args[0] == "test"):
         build()
         os.system("ctest --test-dir build")
+
+    elif(args[0] == "bench"):
+        os.system("cmake -S . -B build-release -DCMAKE_BUILD_TYPE=Release")
+        os.system("cmake --build build-release --target rtmc_lib_bench")
+        os.system("build-release/rtmc_lib_bench")
     
     else:
         print_red(f"Error: unknown argument: '{args[0]}'")
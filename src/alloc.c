@@ -0,0 +1,122 @@
+/*
+    alloc.c
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alloc.h"
+#include "rtmc_alloc.h"
+
+#ifdef RTMC_ALLOC_HOOKS
+
+static void* default_allocate(size_t size, void* user_data) {
+    (void)user_data;
+    return malloc(size);
+}
+
+static void* default_reallocate(void* pointer, size_t size, void* user_data) {
+    (void)user_data;
+    return realloc(pointer, size);
+}
+
+static void default_deallocate(void* pointer, void* user_data) {
+    (void)user_data;
+    free(pointer);
+}
+
+static const rtmc_allocator_t default_allocator = {
+    default_allocate, default_reallocate, default_deallocate, NULL
+};
+
+static rtmc_allocator_t allocator = {
+    default_allocate, default_reallocate, default_deallocate, NULL
+};
+
+// how many real-time sections the calling thread is in
+static _Thread_local int rt_section_depth = 0;
+
+// reports heap use inside a real-time section (never returns)
+static void rt_section_violation(const char* operation, size_t size) {
+    fprintf(stderr, "rtmc: %s of %zu bytes inside a real-time section\n", operation, size);
+    fflush(stderr);
+    abort();
+}
+
+
+
+void* rtmc_malloc(size_t size) {
+    if(rt_section_depth > 0) {
+        rt_section_violation("allocation", size);
+    }
+
+    return allocator.allocate(size, allocator.user_data);
+}
+
+void* rtmc_calloc(size_t count, size_t size) {
+    if(size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    void* pointer = rtmc_malloc(count * size);
+    if(pointer) {
+        memset(pointer, 0, count * size);
+    }
+
+    return pointer;
+}
+
+void* rtmc_realloc(void* pointer, size_t size) {
+    if(rt_section_depth > 0) {
+        rt_section_violation("reallocation", size);
+    }
+
+    return allocator.reallocate(pointer, size, allocator.user_data);
+}
+
+void rtmc_free(void* pointer) {
+    if(pointer == NULL) {
+        return;
+    }
+    if(rt_section_depth > 0) {
+        rt_section_violation("free", 0);
+    }
+
+    allocator.deallocate(pointer, allocator.user_data);
+}
+
+
+
+void rtmc_set_allocator(const rtmc_allocator_t* new_allocator) {
+    allocator = new_allocator ? *new_allocator : default_allocator;
+}
+
+void rtmc_enter_rt_section() {
+    rt_section_depth++;
+}
+
+void rtmc_exit_rt_section() {
+    if(rt_section_depth > 0) {
+        rt_section_depth--;
+    }
+}
+
+bool rtmc_is_in_rt_section() {
+    return rt_section_depth > 0;
+}
+
+#else // without hooks, allocations can't be redirected or checked
+
+void rtmc_set_allocator(const rtmc_allocator_t* new_allocator) {
+    (void)new_allocator;
+}
+
+void rtmc_enter_rt_section() {}
+void rtmc_exit_rt_section() {}
+
+bool rtmc_is_in_rt_section() {
+    return false;
+}
+
+#endif
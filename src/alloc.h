@@ -0,0 +1,35 @@
+/*
+    alloc.h
+
+    THIS IS NOT A PUBLIC INTERFACE AND SHOULD NOT BE INCLUDED ANYWHERE
+    EXCEPT FOR THE LIBRARY'S OWN SOURCE FILES
+
+    The library allocates only through these functions (never `malloc()`
+    and `free()` directly), so allocations can be redirected and checked
+    (see `rtmc_alloc.h`). Without `RTMC_ALLOC_HOOKS`, they're just the C
+    library functions.
+*/
+
+#ifndef ALLOC_H
+#define ALLOC_H
+
+
+
+#include <stddef.h>
+
+#ifdef RTMC_ALLOC_HOOKS
+void* rtmc_malloc(size_t size);
+void* rtmc_calloc(size_t count, size_t size);
+void* rtmc_realloc(void* pointer, size_t size);
+void rtmc_free(void* pointer);
+#else
+#include <stdlib.h>
+static inline void* rtmc_malloc(size_t size) { return malloc(size); }
+static inline void* rtmc_calloc(size_t count, size_t size) { return calloc(count, size); }
+static inline void* rtmc_realloc(void* pointer, size_t size) { return realloc(pointer, size); }
+static inline void rtmc_free(void* pointer) { free(pointer); }
+#endif
+
+
+
+#endif // ALLOC_H
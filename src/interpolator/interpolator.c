@@ -0,0 +1,334 @@
+/*
+    interpolator/interpolator.c
+*/
+
+#include "../alloc.h"
+#include "interpolator.h"
+#include "rtmc_interpolator.h"
+
+/*
+    Create and destroy interpolators
+*/
+static bool is_valid_config(const rtmc_interpolator_config_t* config) {
+    if(!(config->tick > 0) || config->look_ahead < 1 || !config->load || !config->pose) {
+        return false;
+    }
+
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(!(config->max_velocity[i] > 0) || !(config->max_acceleration[i] > 0)) {
+            return false;
+        }
+        if(config->profile == RTMC_PROFILE_S_CURVE && !(config->max_jerk[i] > 0)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+rtmc_interpolator_t* rtmc_create_interpolator(const rtmc_interpolator_config_t* config) {
+    if(!is_valid_config(config)) {
+        return NULL;
+    }
+
+    rtmc_interpolator_t* interpolator = (rtmc_interpolator_t*)rtmc_malloc(sizeof(rtmc_interpolator_t));
+    if(interpolator == NULL) {
+        return NULL;
+    }
+
+    interpolator->window = (segment_t*)rtmc_calloc(config->look_ahead, sizeof(segment_t));
+    if(interpolator->window == NULL) {
+        rtmc_free(interpolator);
+        return NULL;
+    }
+
+    interpolator->config = *config;
+    interpolator->window_start = 0;
+    interpolator->window_count = 0;
+    interpolator->is_moving = false;
+    interpolator->has_new_paths = false;
+    interpolator->corner_previous = NULL;
+    interpolator->profile_segments = 0;
+    interpolator->segment_start = 0;
+    interpolator->time = 0;
+    interpolator->velocity = 0;
+    return interpolator;
+}
+
+void rtmc_destroy_interpolator(rtmc_interpolator_t* interpolator) {
+    if(interpolator) {
+        rtmc_free(interpolator->window);
+        rtmc_free(interpolator);
+    }
+}
+
+
+
+/*
+    Moves paths from the queue into the window (until it's full). The corner
+    onto the first new path can lower the limits of the path before it,
+    which may already be planned on, so that path is saved first (see
+    `undo_corner()`).
+*/
+static void fill_window(rtmc_interpolator_t* interpolator, rtmc_path_queue_t* queue) {
+    interpolator->corner_previous = NULL;
+    size_t old_count = interpolator->window_count;
+
+    const rtmc_path_t* path;
+    while(interpolator->window_count < interpolator->config.look_ahead && (path = rtmc_path_queue_front(queue))) {
+        segment_t* segment = window_segment(interpolator, interpolator->window_count);
+        bool has_length = init_segment(segment, path, &interpolator->config);
+        rtmc_path_queue_release(queue);
+
+        // paths without any length are skipped
+        if(!has_length) {
+            continue;
+        }
+
+        // the first path in an empty window starts from rest
+        if(interpolator->window_count == 0) {
+            segment->max_entry_velocity = 0;
+        }
+        else {
+            segment_t* previous = window_segment(interpolator, interpolator->window_count - 1);
+            bool is_planned = (interpolator->window_count == old_count);
+            if(is_planned) {
+                interpolator->corner_saved = *previous;
+            }
+
+            segment->max_entry_velocity = join_segments(previous, segment, &interpolator->config);
+            if(is_planned && previous->corner_reserve > interpolator->corner_saved.corner_reserve) {
+                interpolator->corner_previous = previous;
+                interpolator->corner_next = segment;
+            }
+        }
+        segment->entry_velocity = segment->max_entry_velocity;
+
+        interpolator->window_count++;
+        interpolator->has_new_paths = true;
+    }
+}
+
+/*
+    Takes back the corner that `fill_window()` reserved on a path that was
+    already planned on: the path gets its old limits back, and the corner is
+    taken from rest instead (which the old plan can always still do). Returns
+    false if there's nothing to take back.
+*/
+static bool undo_corner(rtmc_interpolator_t* interpolator) {
+    segment_t* previous = interpolator->corner_previous;
+    if(previous == NULL) {
+        return false;
+    }
+
+    double entry_velocity = previous->entry_velocity;
+    *previous = interpolator->corner_saved;
+    previous->entry_velocity = entry_velocity;
+
+    interpolator->corner_next->max_entry_velocity = 0;
+    interpolator->corner_previous = NULL;
+    return true;
+}
+
+/*
+    Plans a profile from `covered` into the first path of the window, at its
+    entry speed and `acceleration`, through the paths joined to it without
+    slowing down (returned in `group_size`). Returns false if the profile
+    can't reach the next entry speed.
+
+    A profile runs through every path that's joined to the next without
+    slowing down (e.g., collinear CAM segments with the same limits), so an
+    S-curve doesn't bring the acceleration back to zero at each of them.
+*/
+static bool plan_profile(rtmc_interpolator_t* interpolator, profile_t* profile, size_t* group_size, double covered, double acceleration) {
+    const segment_t* first = window_segment(interpolator, 0);
+    plan_window(interpolator, first->length - covered);
+
+    *group_size = 1;
+    double length = first->length - covered;
+    while(*group_size < interpolator->window_count) {
+        const segment_t* previous = window_segment(interpolator, *group_size - 1);
+        const segment_t* next = window_segment(interpolator, *group_size);
+        if(!is_smooth_junction(previous, next)) {
+            break;
+        }
+
+        length += next->length;
+        (*group_size)++;
+    }
+
+    double exit_velocity = (*group_size < interpolator->window_count)
+        ? window_segment(interpolator, *group_size)->entry_velocity
+        : 0;
+
+    switch(interpolator->config.profile) {
+        case RTMC_PROFILE_TRAPEZOIDAL:
+            return plan_trapezoid(
+                profile, length,
+                first->entry_velocity, exit_velocity,
+                first->max_velocity, first->max_acceleration
+            );
+
+        case RTMC_PROFILE_S_CURVE:
+            return plan_s_curve_from(
+                profile, length,
+                first->entry_velocity, acceleration, exit_velocity,
+                first->max_velocity, first->max_acceleration, first->max_jerk
+            );
+    }
+
+    return false;
+}
+
+/*
+    Fills the window, then plans a profile from `covered` into its first
+    path, at its entry speed and `acceleration` (only S-curves start
+    mid-ramp; trapezoids are given zero), and loads that path. Returns
+    false if there are no paths, or if an S-curve can't reach the next entry
+    speed from that acceleration.
+
+    Once a new corner is taken back, the window has only grown since the
+    last plan, so a profile that starts at zero acceleration always fits
+    (to within rounding, so it's used either way).
+*/
+static bool start_profile(rtmc_interpolator_t* interpolator, rtmc_path_queue_t* queue, double covered, double acceleration) {
+    fill_window(interpolator, queue);
+    if(interpolator->window_count == 0) {
+        return false;
+    }
+
+    profile_t profile;
+    size_t group_size;
+    bool fits = plan_profile(interpolator, &profile, &group_size, covered, acceleration);
+    if(!fits && undo_corner(interpolator)) {
+        fits = plan_profile(interpolator, &profile, &group_size, covered, acceleration);
+    }
+    interpolator->corner_previous = NULL;
+
+    if(!fits && acceleration != 0) {
+        return false;
+    }
+
+    interpolator->profile = profile;
+    interpolator->has_new_paths = false;
+    interpolator->profile_segments = group_size;
+    interpolator->segment_start = -covered;
+    interpolator->config.load(window_segment(interpolator, 0)->path);
+    interpolator->is_moving = true;
+    return true;
+}
+
+// drops the first path from the window
+static void drop_segment(rtmc_interpolator_t* interpolator) {
+    interpolator->window_start = (interpolator->window_start + 1) % interpolator->config.look_ahead;
+    interpolator->window_count--;
+}
+
+// drops the paths of the finished profile
+static void finish_profile(rtmc_interpolator_t* interpolator) {
+    for(size_t i = 0; i < interpolator->profile_segments; i++) {
+        drop_segment(interpolator);
+    }
+    interpolator->profile_segments = 0;
+    interpolator->is_moving = false;
+}
+
+
+
+// moves on through the profile's paths, up to `distance` into the profile
+static void advance_segments(rtmc_interpolator_t* interpolator, double distance) {
+    segment_t* segment = window_segment(interpolator, 0);
+    while(interpolator->profile_segments > 1 && distance > interpolator->segment_start + segment->length) {
+        interpolator->segment_start += segment->length;
+        drop_segment(interpolator);
+        interpolator->profile_segments--;
+
+        segment = window_segment(interpolator, 0);
+        interpolator->config.load(segment->path);
+    }
+}
+
+/*
+    Replans the profile from the current time to take in the paths that
+    have come into view, which keeps a window that's too short to ever
+    cruise from stopping at its end (as long as paths keep coming). The
+    window only grows, so the current speed can always still slow down in
+    time (once any new corner that doesn't fit is taken back); but an
+    S-curve that first has to bring its acceleration back to zero might
+    not, and then the old profile is kept.
+
+    An S-curve isn't replanned while it's speeding up, since bringing the
+    acceleration back to zero would only cut the ramp short.
+*/
+static void replan(rtmc_interpolator_t* interpolator, rtmc_path_queue_t* queue) {
+    double acceleration = 0;
+    if(interpolator->config.profile == RTMC_PROFILE_S_CURVE) {
+        acceleration = profile_acceleration(&interpolator->profile, interpolator->time);
+        if(acceleration > 0) {
+            return;
+        }
+    }
+
+    double velocity;
+    double distance = profile_distance(&interpolator->profile, interpolator->time, &velocity);
+    advance_segments(interpolator, distance);
+
+    // the old profile's exit speed (any paths past the window start from rest)
+    size_t group_size = interpolator->profile_segments;
+    double exit_velocity = (group_size < interpolator->window_count)
+        ? window_segment(interpolator, group_size)->entry_velocity
+        : 0;
+
+    window_segment(interpolator, 0)->entry_velocity = velocity;
+    if(start_profile(interpolator, queue, distance - interpolator->segment_start, acceleration)) {
+        interpolator->time = 0;
+    }
+    else if(group_size < interpolator->window_count) {
+        window_segment(interpolator, group_size)->entry_velocity = exit_velocity;
+    }
+}
+
+// returns true if there are paths waiting that would fit in the window
+static bool can_grow_window(const rtmc_interpolator_t* interpolator, rtmc_path_queue_t* queue) {
+    return interpolator->window_count < interpolator->config.look_ahead && rtmc_path_queue_front(queue);
+}
+
+bool rtmc_interpolator_tick(rtmc_interpolator_t* interpolator, rtmc_path_queue_t* queue, double* pose) {
+    if(!interpolator->is_moving) {
+        if(!start_profile(interpolator, queue, 0, 0)) {
+            return false;
+        }
+        interpolator->time = 0;
+    }
+
+    // time left over at the end of a profile carries into the next one
+    interpolator->time += interpolator->config.tick;
+    while(interpolator->time >= interpolator->profile.duration) {
+        interpolator->time -= interpolator->profile.duration;
+        finish_profile(interpolator);
+
+        if(!start_profile(interpolator, queue, 0, 0)) {
+            // out of paths, so stop at the end of the last one (which is
+            // still loaded in the kinematic solver)
+            interpolator->time = 0;
+            interpolator->velocity = 0;
+            interpolator->config.pose(pose, 1);
+            return true;
+        }
+    }
+
+    if(interpolator->has_new_paths || can_grow_window(interpolator, queue)) {
+        replan(interpolator, queue);
+    }
+
+    double distance = profile_distance(&interpolator->profile, interpolator->time, &interpolator->velocity);
+    advance_segments(interpolator, distance);
+
+    const segment_t* segment = window_segment(interpolator, 0);
+    interpolator->config.pose(pose, segment_parameter(segment, distance - interpolator->segment_start));
+    return true;
+}
+
+double rtmc_interpolator_velocity(const rtmc_interpolator_t* interpolator) {
+    return interpolator->velocity;
+}
@@ -0,0 +1,162 @@
+/*
+    interpolator/interpolator.h
+
+    THIS IS NOT A PUBLIC INTERFACE AND SHOULD NOT BE INCLUDED ANYWHERE
+    EXCEPT FOR THE FILES WITHIN THIS DIRECTORY
+
+    The interpolator is split into these files:
+     * interpolator.c --- functions from `rtmc_interpolator.h`
+     * segment.c -------- path geometry (length, tangents, curvature)
+     * planner.c -------- look-ahead (junction and entry speeds)
+     * profile.c -------- velocity profiles along a single path
+*/
+
+#ifndef INTERPOLATOR_H
+#define INTERPOLATOR_H
+
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "rtmc_interpolator.h"
+#include "rtmc_path.h"
+
+// magic numbers
+#define NUM_LENGTH_PANELS 8 // Gauss-Legendre panels per path
+#define NUM_GAUSS_POINTS 5 // Gauss-Legendre points per panel
+#define MIN_SEGMENT_LENGTH 1e-12 // shorter paths are skipped
+#define MAX_PROFILE_PHASES 8 // an S-curve's 7, plus a lead-in
+#define FIT_TOLERANCE 1e-9 // rounding allowed when checking that a profile fits
+
+
+
+/*
+    A velocity profile is a table of phases. Within a phase, the distance
+    along the path is a cubic in time:
+        d(t) = distance + velocity*t + acceleration*t^2/2 + jerk*t^3/6
+    (where t is the time since the start of the phase)
+*/
+typedef struct {
+    double duration;
+    double distance;
+    double velocity;
+    double acceleration;
+    double jerk;
+} profile_phase_t;
+
+typedef struct {
+    profile_phase_t phases[MAX_PROFILE_PHASES];
+    int num_phases;
+    double duration;
+    double length;
+} profile_t;
+
+
+
+/*
+    A path along with what the planner needs to know about it. Lengths are
+    arc lengths in task space; `panel_lengths[i]` is the arc length from
+    s = 0 to s = i / NUM_LENGTH_PANELS.
+*/
+typedef struct {
+    rtmc_path_t path;
+    double length;
+    double panel_lengths[NUM_LENGTH_PANELS + 1];
+    double start_tangent[RTMC_NUM_AXES]; // unit tangents
+    double end_tangent[RTMC_NUM_AXES];
+    double max_velocity; // cruise speed limit
+    double max_acceleration; // along the path (less what its corners reserve)
+    double max_jerk; // along the path (INFINITY for trapezoidal profiles; less what its corners reserve)
+    double limit_share; // of each axis's limits (1, or 0.5 on curves)
+    double full_acceleration; // `max_acceleration` without any corners
+    double full_jerk; // `max_jerk` without any corners
+    double corner_reserve; // of each axis's acceleration limit, for corners
+    double corner_jerk_reserve; // of each axis's jerk limit, for corners
+    double max_entry_velocity; // limited by the junction with the previous path
+    double entry_velocity; // planned
+} segment_t;
+
+/*
+    Interpolator (declared as `rtmc_interpolator_t` in `rtmc_interpolator.h`)
+
+    The look-ahead window is a ring of `config.look_ahead` segments,
+    starting with the one being followed. The current profile covers the
+    first `profile_segments` of them.
+*/
+struct rtmc_interpolator {
+    rtmc_interpolator_config_t config;
+    segment_t* window;
+    size_t window_start;
+    size_t window_count;
+
+    bool is_moving; // true while following a profile
+    bool has_new_paths; // paths have come into view since the last plan
+
+    // the path that was last in the window before it was filled, if the
+    // corner onto the next one reserved some of its limits (see
+    // `undo_corner()`), and that path as it was
+    segment_t* corner_previous;
+    segment_t* corner_next;
+    segment_t corner_saved;
+
+    profile_t profile;
+    size_t profile_segments;
+    double segment_start; // distance into the profile of the first segment
+    double time; // since the start of the profile
+    double velocity;
+};
+
+
+
+/*
+    Private interface
+*/
+// returns the segment `i` places into the window
+static inline segment_t* window_segment(rtmc_interpolator_t* interpolator, size_t i) {
+    return &interpolator->window[(interpolator->window_start + i) % interpolator->config.look_ahead];
+}
+
+// computes the geometry and speed limits of `path` (returns false if it
+// has no length)
+bool init_segment(segment_t* segment, const rtmc_path_t* path, const rtmc_interpolator_config_t* config);
+
+// returns the path parameter (0 to 1) that's `distance` along the segment
+double segment_parameter(const segment_t* segment, double distance);
+
+// returns the fastest speed through the corner from `previous` to `next`,
+// and reserves the share of the axis limits it takes on both
+double join_segments(segment_t* previous, segment_t* next, const rtmc_interpolator_config_t* config);
+
+// returns true if one profile can run through both segments (the corner
+// doesn't limit the speed, and they share the same limits)
+bool is_smooth_junction(const segment_t* previous, const segment_t* next);
+
+// plans the entry speeds of the window (the first entry speed is kept, and
+// the window ends at rest), with `first_length` left of the first segment
+void plan_window(rtmc_interpolator_t* interpolator, double first_length);
+
+// plans a trapezoidal profile (returns false if `exit_velocity` is out of
+// reach, in which case the profile overshoots it)
+bool plan_trapezoid(profile_t* profile, double length, double entry_velocity, double exit_velocity, double max_velocity, double max_acceleration);
+
+// plans a jerk-limited profile that starts at `entry_acceleration`
+// (returns false if `exit_velocity` is out of reach, in which case the
+// profile overshoots it)
+bool plan_s_curve_from(profile_t* profile, double length, double entry_velocity, double entry_acceleration, double exit_velocity, double max_velocity, double max_acceleration, double max_jerk);
+
+// returns the distance covered by a ramp between two speeds
+double ramp_length(double from_velocity, double to_velocity, double max_acceleration, double max_jerk);
+
+// returns the distance travelled `t` into the profile (and its speed)
+double profile_distance(const profile_t* profile, double t, double* velocity);
+
+// returns the acceleration `t` into the profile (zero past the end)
+double profile_acceleration(const profile_t* profile, double t);
+
+// returns the highest speed reachable from `velocity` over `length`, with
+// the acceleration starting and ending at zero (`jerk` can be INFINITY)
+double reachable_velocity(double velocity, double length, double acceleration, double jerk);
+
+
+
+#endif // INTERPOLATOR_H
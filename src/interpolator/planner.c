@@ -0,0 +1,139 @@
+/*
+    interpolator/planner.c
+
+    Look-ahead planning. The window of upcoming paths is planned each time
+    a path starts, in two passes:
+     1. backward: working back from a stop at the end of the window, each
+        entry speed is limited to what can still decelerate in time
+     2. forward: working on from the current entry speed, each entry speed
+        is limited to what can be reached by accelerating
+
+    The current path's entry speed was planned with a shorter (or equal)
+    view of the paths ahead, so it can always still stop in time, unless a
+    corner onto a new path has lowered the limits of one that was already
+    planned (see `undo_corner()` in interpolator.c).
+*/
+
+#include <math.h>
+#include "interpolator.h"
+
+/*
+    At a corner, the direction changes instantly, so each axis's velocity
+    jumps by (speed * change in its unit tangent). The jump is spread over
+    one servo tick, on top of the acceleration along the paths on either
+    side. So a corner takes at most half of each axis's share of the limits:
+        speed * |next_tangent - previous_tangent| <= share/2 * max_acceleration * tick
+    and whatever it takes at that speed is reserved on both paths, lowering
+    their acceleration along the path to match. Collinear paths are only
+    limited by their cruise speeds (and reserve nothing).
+
+    For S-curves, the jump also comes and goes within a tick, a jerk of
+    (jump / tick^2), so the corner takes a share of the jerk limits the same
+    way:
+        speed * |next_tangent - previous_tangent| <= share/2 * max_jerk * tick^2
+
+    Sharp corners can only be taken very slowly, which isn't worth slowing
+    down both paths for, so a corner is only taken at speed if that's
+    quicker than stopping at it.
+*/
+static double reserved_limit(const segment_t* segment, double full_limit, double corner_reserve, double reserve) {
+    return full_limit * (1 - fmax(corner_reserve, reserve) / segment->limit_share);
+}
+
+// returns the time from `velocity` at one end of the segment to its middle,
+// speeding up as much as it can with the corner's reserves
+static double half_segment_time(const segment_t* segment, double velocity, double reserve, double jerk_reserve) {
+    double a = reserved_limit(segment, segment->full_acceleration, segment->corner_reserve, reserve);
+    double j = reserved_limit(segment, segment->full_jerk, segment->corner_jerk_reserve, jerk_reserve);
+    double length = segment->length / 2;
+    double peak_velocity = fmin(reachable_velocity(velocity, length, a, j), segment->max_velocity);
+    double ramp = ramp_length(velocity, peak_velocity, a, j);
+    return 2*ramp / (velocity + peak_velocity) + (length - ramp) / peak_velocity;
+}
+
+static void reserve_corner(segment_t* segment, double reserve, double jerk_reserve) {
+    segment->max_acceleration = reserved_limit(segment, segment->full_acceleration, segment->corner_reserve, reserve);
+    segment->max_jerk = reserved_limit(segment, segment->full_jerk, segment->corner_jerk_reserve, jerk_reserve);
+    segment->corner_reserve = fmax(segment->corner_reserve, reserve);
+    segment->corner_jerk_reserve = fmax(segment->corner_jerk_reserve, jerk_reserve);
+}
+
+double join_segments(segment_t* previous, segment_t* next, const rtmc_interpolator_config_t* config) {
+    bool is_s_curve = (config->profile == RTMC_PROFILE_S_CURVE);
+    double tick = config->tick;
+    double max_reserve = fmin(previous->limit_share, next->limit_share) / 2;
+    double velocity = fmin(previous->max_velocity, next->max_velocity);
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        double change = fabs(next->start_tangent[i] - previous->end_tangent[i]);
+        if(change > 0) {
+            velocity = fmin(velocity, max_reserve*config->max_acceleration[i]*tick / change);
+            if(is_s_curve) {
+                velocity = fmin(velocity, max_reserve*config->max_jerk[i]*tick*tick / change);
+            }
+        }
+    }
+
+    double reserve = 0;
+    double jerk_reserve = 0;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        double change = fabs(next->start_tangent[i] - previous->end_tangent[i]);
+        reserve = fmax(reserve, velocity*change / (config->max_acceleration[i]*tick));
+        if(is_s_curve) {
+            jerk_reserve = fmax(jerk_reserve, velocity*change / (config->max_jerk[i]*tick*tick));
+        }
+    }
+    if(reserve == 0) {
+        return velocity;
+    }
+
+    double carry_time = half_segment_time(previous, velocity, reserve, jerk_reserve)
+        + half_segment_time(next, velocity, reserve, jerk_reserve);
+    double stop_time = half_segment_time(previous, 0, 0, 0) + half_segment_time(next, 0, 0, 0);
+    if(carry_time >= stop_time) {
+        return 0;
+    }
+
+    reserve_corner(previous, reserve, jerk_reserve);
+    reserve_corner(next, reserve, jerk_reserve);
+    return velocity;
+}
+
+
+
+void plan_window(rtmc_interpolator_t* interpolator, double first_length) {
+    size_t count = interpolator->window_count;
+
+    // backward pass (the window ends at rest)
+    double exit_velocity = 0;
+    for(size_t i = count - 1; i > 0; i--) {
+        segment_t* segment = window_segment(interpolator, i);
+        segment->entry_velocity = fmin(
+            segment->max_entry_velocity,
+            reachable_velocity(exit_velocity, segment->length, segment->max_acceleration, segment->max_jerk)
+        );
+        exit_velocity = segment->entry_velocity;
+    }
+
+    // forward pass (the first entry speed is already committed)
+    for(size_t i = 0; i + 1 < count; i++) {
+        segment_t* segment = window_segment(interpolator, i);
+        segment_t* next = window_segment(interpolator, i + 1);
+        double length = (i == 0) ? first_length : segment->length;
+        next->entry_velocity = fmin(
+            next->entry_velocity,
+            reachable_velocity(segment->entry_velocity, length, segment->max_acceleration, segment->max_jerk)
+        );
+    }
+}
+
+// returns true if `a` and `b` are equal to within rounding
+static bool is_same_limit(double a, double b) {
+    return a == b || fabs(a - b) <= 1e-9*fmax(fabs(a), fabs(b));
+}
+
+bool is_smooth_junction(const segment_t* previous, const segment_t* next) {
+    return next->max_entry_velocity >= fmin(previous->max_velocity, next->max_velocity)
+        && is_same_limit(previous->max_velocity, next->max_velocity)
+        && is_same_limit(previous->max_acceleration, next->max_acceleration)
+        && is_same_limit(previous->max_jerk, next->max_jerk);
+}
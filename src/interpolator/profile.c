@@ -0,0 +1,278 @@
+/*
+    interpolator/profile.c
+
+    Velocity profiles along a single path. Profiles are planned in closed
+    form (or with a fixed number of bisection steps), so planning a path
+    takes constant time.
+
+    S-curve profiles are built from ramps. A ramp changes the speed with the
+    acceleration starting and ending at zero:
+     * a long ramp (speed change >= a^2/j) raises the acceleration at the
+       jerk limit, holds it at the acceleration limit, then lowers it
+     * a short ramp only raises and lowers the acceleration (never reaching
+       the limit)
+    A ramp covers its average speed times its duration, since it's
+    symmetric.
+*/
+
+#include <math.h>
+#include "interpolator.h"
+
+// appends a phase (skipping empty ones) that starts where the last one ended
+static void add_phase(profile_t* profile, double duration, double acceleration, double jerk) {
+    if(duration <= 0) {
+        return;
+    }
+
+    profile_phase_t* phase = &profile->phases[profile->num_phases++];
+    phase->duration = duration;
+    phase->acceleration = acceleration;
+    phase->jerk = jerk;
+    if(profile->num_phases == 1) {
+        phase->distance = 0;
+        phase->velocity = profile->phases[0].velocity;
+        return;
+    }
+
+    const profile_phase_t* previous = phase - 1;
+    double t = previous->duration;
+    phase->distance = previous->distance + previous->velocity*t + previous->acceleration*t*t/2 + previous->jerk*t*t*t/6;
+    phase->velocity = previous->velocity + previous->acceleration*t + previous->jerk*t*t/2;
+}
+
+// starts an empty profile at `entry_velocity`
+static void begin_profile(profile_t* profile, double length, double entry_velocity) {
+    profile->num_phases = 0;
+    profile->phases[0].velocity = entry_velocity;
+    profile->length = length;
+}
+
+// returns true if `needed` fits in `length` (to within rounding)
+static bool fits_length(double needed, double length) {
+    return needed <= length*(1 + FIT_TOLERANCE) + MIN_SEGMENT_LENGTH;
+}
+
+// sums up the phase durations
+static void finish_profile(profile_t* profile) {
+    profile->duration = 0;
+    for(int i = 0; i < profile->num_phases; i++) {
+        profile->duration += profile->phases[i].duration;
+    }
+}
+
+
+
+/*
+    Accelerate to the cruise speed, cruise, then decelerate to the exit
+    speed. If the path is too short to reach `max_velocity`, the cruise
+    speed is where the acceleration and deceleration meet:
+        v^2 = (2*a*length + entry^2 + exit^2) / 2
+*/
+bool plan_trapezoid(profile_t* profile, double length, double entry_velocity, double exit_velocity, double max_velocity, double max_acceleration) {
+    double a = max_acceleration;
+    double peak_velocity = sqrt((2*a*length + entry_velocity*entry_velocity + exit_velocity*exit_velocity) / 2);
+    double cruise_velocity = fmin(max_velocity, peak_velocity);
+    cruise_velocity = fmax(cruise_velocity, fmax(entry_velocity, exit_velocity));
+
+    double accel_length = (cruise_velocity*cruise_velocity - entry_velocity*entry_velocity) / (2*a);
+    double decel_length = (cruise_velocity*cruise_velocity - exit_velocity*exit_velocity) / (2*a);
+    double cruise_length = fmax(length - accel_length - decel_length, 0);
+
+    begin_profile(profile, length, entry_velocity);
+    add_phase(profile, (cruise_velocity - entry_velocity) / a, a, 0);
+    add_phase(profile, (cruise_velocity > 0) ? cruise_length / cruise_velocity : 0, 0, 0);
+    add_phase(profile, (cruise_velocity - exit_velocity) / a, -a, 0);
+    finish_profile(profile);
+
+    double change_length = fabs(entry_velocity*entry_velocity - exit_velocity*exit_velocity) / (2*a);
+    return fits_length(change_length, length);
+}
+
+
+
+/*
+    S-curve ramps
+*/
+// returns the duration of a ramp between two speeds (and its peak
+// acceleration)
+static double ramp_duration(double from_velocity, double to_velocity, double max_acceleration, double max_jerk, double* peak_acceleration) {
+    double change = fabs(to_velocity - from_velocity);
+    double a = max_acceleration;
+    double j = max_jerk;
+
+    if(change >= a*a/j) {
+        *peak_acceleration = a;
+        return change/a + a/j;
+    }
+
+    *peak_acceleration = sqrt(change*j);
+    return 2*sqrt(change/j);
+}
+
+double ramp_length(double from_velocity, double to_velocity, double max_acceleration, double max_jerk) {
+    double peak_acceleration;
+    double duration = ramp_duration(from_velocity, to_velocity, max_acceleration, max_jerk, &peak_acceleration);
+    return (from_velocity + to_velocity) / 2 * duration;
+}
+
+// appends the phases of a ramp (`sign` is 1 to speed up and -1 to slow down)
+static void add_ramp(profile_t* profile, double from_velocity, double to_velocity, double max_acceleration, double max_jerk, double sign) {
+    double peak_acceleration;
+    double duration = ramp_duration(from_velocity, to_velocity, max_acceleration, max_jerk, &peak_acceleration);
+    double jerk_duration = peak_acceleration / max_jerk;
+
+    add_phase(profile, jerk_duration, 0, sign*max_jerk);
+    add_phase(profile, duration - 2*jerk_duration, sign*peak_acceleration, 0);
+    add_phase(profile, jerk_duration, sign*peak_acceleration, -sign*max_jerk);
+}
+
+/*
+    The highest speed v reachable over `length` by a ramp:
+     * long ramp: length = (v^2 - v0^2)/(2a) + (v0 + v)*a/(2j), which is a
+       quadratic in v
+     * short ramp: with x = sqrt((v - v0)/j), length = (2*v0 + j*x^2)*x,
+       which is a cubic in x with a single real root (Cardano's formula)
+    With an infinite jerk limit, this is the usual sqrt(v0^2 + 2*a*length).
+*/
+double reachable_velocity(double velocity, double length, double acceleration, double jerk) {
+    double v0 = velocity;
+    double a = acceleration;
+    double j = jerk;
+
+    // a ramp that just reaches full acceleration
+    double shortest_long_ramp = (2*v0 + a*a/j) * a/j;
+
+    if(length >= shortest_long_ramp) {
+        double b = a*a/j;
+        return (-b + sqrt(b*b + 4*(2*a*length + v0*v0 - v0*b))) / 2;
+    }
+
+    double p = 2*v0/j;
+    double q = -length/j;
+    double root = sqrt(q*q/4 + p*p*p/27);
+    double x = cbrt(-q/2 + root) + cbrt(-q/2 - root);
+    return v0 + j*x*x;
+}
+
+
+
+/*
+    Ramp up to the cruise speed, cruise, then ramp down to the exit speed.
+    The ramps' total length only grows with the cruise speed, so when the
+    path is too short to reach `max_velocity`, the cruise speed is where the
+    ramps fill the whole path. When both are long ramps, that's a quadratic:
+        v^2/a + v*a/j = length + (v0^2 + v1^2)/(2a) - (v0 + v1)*a/(2j)
+    Otherwise, it's found by bisection (a fixed number of steps).
+*/
+#define CRUISE_BISECTION_STEPS 64
+
+static double ramps_length(double cruise_velocity, double entry_velocity, double exit_velocity, double max_acceleration, double max_jerk) {
+    return ramp_length(entry_velocity, cruise_velocity, max_acceleration, max_jerk)
+        + ramp_length(cruise_velocity, exit_velocity, max_acceleration, max_jerk);
+}
+
+static double s_curve_cruise_velocity(double length, double entry_velocity, double exit_velocity, double max_velocity, double max_acceleration, double max_jerk) {
+    double v0 = entry_velocity;
+    double v1 = exit_velocity;
+    double a = max_acceleration;
+    double j = max_jerk;
+
+    double low = fmax(v0, v1);
+    double high = fmax(max_velocity, low);
+    if(ramps_length(high, v0, v1, a, j) <= length) {
+        return high;
+    }
+
+    // both long ramps
+    double b = a/j;
+    double c = -(length + (v0*v0 + v1*v1)/(2*a) - (v0 + v1)*a/(2*j));
+    double velocity = a/2 * (-b + sqrt(b*b - 4*c/a));
+    if(velocity - v0 >= a*b && velocity - v1 >= a*b && velocity >= low && velocity <= high) {
+        return velocity;
+    }
+
+    for(int i = 0; i < CRUISE_BISECTION_STEPS; i++) {
+        double middle = (low + high) / 2;
+        if(ramps_length(middle, v0, v1, a, j) <= length) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// appends the ramps and cruise of an S-curve that starts at zero acceleration
+static void add_s_curve(profile_t* profile, double length, double entry_velocity, double exit_velocity, double max_velocity, double max_acceleration, double max_jerk) {
+    double a = max_acceleration;
+    double j = max_jerk;
+    double cruise_velocity = s_curve_cruise_velocity(length, entry_velocity, exit_velocity, max_velocity, a, j);
+    double cruise_length = fmax(length - ramps_length(cruise_velocity, entry_velocity, exit_velocity, a, j), 0);
+
+    add_ramp(profile, entry_velocity, cruise_velocity, a, j, 1);
+    add_phase(profile, (cruise_velocity > 0) ? cruise_length / cruise_velocity : 0, 0, 0);
+    add_ramp(profile, cruise_velocity, exit_velocity, a, j, -1);
+}
+
+/*
+    Starting mid-ramp, a lead-in first brings the acceleration back to zero
+    as quickly as the jerk limit allows, and the rest is an ordinary S-curve.
+    The lead-in changes the speed by a0^2/(2j), so the exit speed might no
+    longer be reachable in what's left of the path. (Starting at zero
+    acceleration, the planner only hands out reachable exit speeds, unless
+    a corner has lowered the limits since.)
+*/
+bool plan_s_curve_from(profile_t* profile, double length, double entry_velocity, double entry_acceleration, double exit_velocity, double max_velocity, double max_acceleration, double max_jerk) {
+    double a0 = entry_acceleration;
+    double j = (a0 > 0) ? -max_jerk : max_jerk;
+    double t = fabs(a0) / max_jerk;
+    double velocity = entry_velocity + a0*t + j*t*t/2;
+    double lead_in_length = entry_velocity*t + a0*t*t/2 + j*t*t*t/6;
+    double rest = fmax(length - lead_in_length, 0);
+    velocity = fmax(velocity, 0);
+
+    begin_profile(profile, length, entry_velocity);
+    add_phase(profile, t, a0, j);
+    add_s_curve(profile, rest, velocity, exit_velocity, max_velocity, max_acceleration, max_jerk);
+    finish_profile(profile);
+
+    return lead_in_length <= length && fits_length(ramp_length(velocity, exit_velocity, max_acceleration, max_jerk), rest);
+}
+
+
+
+double profile_distance(const profile_t* profile, double t, double* velocity) {
+    for(int i = 0; i < profile->num_phases; i++) {
+        const profile_phase_t* phase = &profile->phases[i];
+        if(t < phase->duration) {
+            *velocity = phase->velocity + phase->acceleration*t + phase->jerk*t*t/2;
+            double distance = phase->distance + phase->velocity*t + phase->acceleration*t*t/2 + phase->jerk*t*t*t/6;
+            return fmin(distance, profile->length);
+        }
+        t -= phase->duration;
+    }
+
+    // past the end
+    if(profile->num_phases > 0) {
+        const profile_phase_t* last = &profile->phases[profile->num_phases - 1];
+        double d = last->duration;
+        *velocity = last->velocity + last->acceleration*d + last->jerk*d*d/2;
+    }
+    else {
+        *velocity = profile->phases[0].velocity;
+    }
+    return profile->length;
+}
+
+double profile_acceleration(const profile_t* profile, double t) {
+    for(int i = 0; i < profile->num_phases; i++) {
+        const profile_phase_t* phase = &profile->phases[i];
+        if(t < phase->duration) {
+            return phase->acceleration + phase->jerk*t;
+        }
+        t -= phase->duration;
+    }
+
+    return 0;
+}
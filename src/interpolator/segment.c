@@ -0,0 +1,170 @@
+/*
+    interpolator/segment.c
+
+    Path geometry. Paths are parameterized by s (0 to 1), not by distance,
+    so the arc length is integrated numerically: each path is split into
+    panels, and each panel is integrated with 5-point Gauss-Legendre
+    quadrature. The panel boundaries double as a lookup table for converting
+    distance back to s, which is exact for constant-speed paths (lines and
+    arcs) and close for the rest.
+*/
+
+#include <math.h>
+#include "interpolator.h"
+#include "rtmc_math.h"
+#include "rtmc_path.h"
+
+// 5-point Gauss-Legendre nodes and weights on [-1, 1]
+static const double gauss_nodes[NUM_GAUSS_POINTS] = {
+    -0.9061798459386640, -0.5384693101056831, 0.0,
+    0.5384693101056831, 0.9061798459386640
+};
+static const double gauss_weights[NUM_GAUSS_POINTS] = {
+    0.2369268850561891, 0.4786286704993665, 0.5688888888888889,
+    0.4786286704993665, 0.2369268850561891
+};
+
+
+
+// computes the first and second derivatives of the path with respect to s
+static void path_derivatives(const rtmc_path_t* path, double s, double* first, double* second) {
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        double A = path->coefficients[i][0];
+        double B = path->coefficients[i][1];
+        double C = path->coefficients[i][2];
+
+        if(rtmc_path_is_trigonometric_axis(path->type, i)) {
+            first[i] = A*B*cos(B*(s - C));
+            second[i] = -A*B*B*sin(B*(s - C));
+        }
+        else {
+            first[i] = 3*A*s*s + 2*B*s + C;
+            second[i] = 6*A*s + 2*B;
+        }
+    }
+}
+
+// returns the curvature given the derivatives (works in any dimension)
+static double curvature(const double* first, const double* second) {
+    double speed_squared = rtmc_dot_product(first, first, RTMC_NUM_AXES);
+    if(speed_squared == 0) {
+        return 0;
+    }
+
+    double dot = rtmc_dot_product(first, second, RTMC_NUM_AXES);
+    double cross_squared = speed_squared*rtmc_dot_product(second, second, RTMC_NUM_AXES) - dot*dot;
+    return sqrt(fmax(cross_squared, 0)) / (speed_squared*sqrt(speed_squared));
+}
+
+// finds the unit tangent at `s` (all zeros where the path doesn't move)
+static void unit_tangent(const rtmc_path_t* path, double s, double* tangent) {
+    double first[RTMC_NUM_AXES], second[RTMC_NUM_AXES];
+    path_derivatives(path, s, first, second);
+
+    double speed = rtmc_vector_magnitude(first, RTMC_NUM_AXES);
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        tangent[i] = (speed > 0) ? first[i] / speed : 0;
+    }
+}
+
+
+
+bool init_segment(segment_t* segment, const rtmc_path_t* path, const rtmc_interpolator_config_t* config) {
+    segment->path = *path;
+
+    // integrate the length, and track the largest share of the motion each
+    // axis takes on (|unit tangent|) and the tightest curve along the way
+    double max_tangent[RTMC_NUM_AXES] = {0};
+    double max_curvature = 0;
+
+    segment->panel_lengths[0] = 0;
+    for(int panel = 0; panel < NUM_LENGTH_PANELS; panel++) {
+        double half_width = 0.5 / NUM_LENGTH_PANELS;
+        double center = (panel + 0.5) / NUM_LENGTH_PANELS;
+
+        double panel_length = 0;
+        for(int k = 0; k < NUM_GAUSS_POINTS; k++) {
+            double first[RTMC_NUM_AXES], second[RTMC_NUM_AXES];
+            path_derivatives(path, center + half_width*gauss_nodes[k], first, second);
+
+            double speed = rtmc_vector_magnitude(first, RTMC_NUM_AXES);
+            panel_length += gauss_weights[k]*speed*half_width;
+
+            if(speed > 0) {
+                for(int i = 0; i < RTMC_NUM_AXES; i++) {
+                    max_tangent[i] = fmax(max_tangent[i], fabs(first[i]) / speed);
+                }
+            }
+            max_curvature = fmax(max_curvature, curvature(first, second));
+        }
+
+        segment->panel_lengths[panel + 1] = segment->panel_lengths[panel] + panel_length;
+    }
+
+    segment->length = segment->panel_lengths[NUM_LENGTH_PANELS];
+    if(segment->length < MIN_SEGMENT_LENGTH) {
+        return false;
+    }
+
+    unit_tangent(path, 0, segment->start_tangent);
+    unit_tangent(path, 1, segment->end_tangent);
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        max_tangent[i] = fmax(max_tangent[i], fabs(segment->start_tangent[i]));
+        max_tangent[i] = fmax(max_tangent[i], fabs(segment->end_tangent[i]));
+    }
+
+    // an axis moving at `max_tangent` of the path speed caps the path speed
+    // and acceleration at its own limits divided by `max_tangent`
+    segment->max_velocity = (path->feed_rate > 0) ? path->feed_rate : INFINITY;
+    segment->max_acceleration = INFINITY;
+    segment->max_jerk = INFINITY;
+    double min_axis_acceleration = INFINITY;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(max_tangent[i] > 0) {
+            segment->max_velocity = fmin(segment->max_velocity, config->max_velocity[i] / max_tangent[i]);
+            segment->max_acceleration = fmin(segment->max_acceleration, config->max_acceleration[i] / max_tangent[i]);
+            min_axis_acceleration = fmin(min_axis_acceleration, config->max_acceleration[i]);
+            if(config->profile == RTMC_PROFILE_S_CURVE) {
+                segment->max_jerk = fmin(segment->max_jerk, config->max_jerk[i] / max_tangent[i]);
+            }
+        }
+    }
+
+    // on curves, the centripetal acceleration (v^2 * curvature) adds to the
+    // acceleration along the path, so each gets half of the limits
+    segment->limit_share = 1;
+    if(max_curvature > 0) {
+        segment->limit_share = 0.5;
+        segment->max_acceleration *= 0.5;
+        segment->max_jerk *= 0.5;
+        segment->max_velocity = fmin(segment->max_velocity, sqrt(0.5*min_axis_acceleration / max_curvature));
+    }
+
+    // no corners yet (see `join_segments()`)
+    segment->full_acceleration = segment->max_acceleration;
+    segment->full_jerk = segment->max_jerk;
+    segment->corner_reserve = 0;
+    segment->corner_jerk_reserve = 0;
+    return true;
+}
+
+
+
+double segment_parameter(const segment_t* segment, double distance) {
+    if(distance <= 0) {
+        return 0;
+    }
+    if(distance >= segment->length) {
+        return 1;
+    }
+
+    // find the panel, then interpolate within it
+    int panel = 0;
+    while(panel < NUM_LENGTH_PANELS - 1 && segment->panel_lengths[panel + 1] < distance) {
+        panel++;
+    }
+
+    double panel_length = segment->panel_lengths[panel + 1] - segment->panel_lengths[panel];
+    double fraction = (panel_length > 0) ? (distance - segment->panel_lengths[panel]) / panel_length : 0;
+    return (panel + fraction) / NUM_LENGTH_PANELS;
+}
@@ -0,0 +1,88 @@
+/*
+    kins/batch.c
+
+    The portable batch kernel, and picking a kernel.
+*/
+
+#include <math.h>
+#include <string.h>
+#include "batch.h"
+
+double batch_sin(double x) {
+    if(!(fabs(x) < BATCH_SIN_MAX_ARGUMENT)) {
+        return sin(x);
+    }
+
+    double j = (x*BATCH_TWO_OVER_PI + BATCH_ROUNDING_CONSTANT) - BATCH_ROUNDING_CONSTANT;
+    double y = x - j*BATCH_PI_OVER_2_1;
+    y -= j*BATCH_PI_OVER_2_2;
+    y -= j*BATCH_PI_OVER_2_3;
+    double z = y*y;
+
+    double sine = y + y*z*(BATCH_SIN_1 + z*(BATCH_SIN_2 + z*(BATCH_SIN_3 + z*(BATCH_SIN_4 + z*(BATCH_SIN_5 + z*BATCH_SIN_6)))));
+    double cosine = 1 - 0.5*z + z*z*(BATCH_COS_1 + z*(BATCH_COS_2 + z*(BATCH_COS_3 + z*(BATCH_COS_4 + z*(BATCH_COS_5 + z*BATCH_COS_6)))));
+
+    long quadrant = (long)j & 3;
+    double result = (quadrant & 1) ? cosine : sine;
+    return (quadrant & 2) ? -result : result;
+}
+
+
+
+void batch_fill_idle(const batch_path_t* path, size_t start, size_t end, double* poses) {
+    for(size_t k = start; k < end; k++) {
+        memcpy(&poses[k*RTMC_NUM_AXES], path->idle_pose, RTMC_NUM_AXES*sizeof(double));
+    }
+}
+
+void pose_batch_portable(const batch_path_t* path, const double* s, size_t n, double* poses) {
+    batch_fill_idle(path, 0, n, poses);
+
+    for(size_t k = 0; k < n; k++) {
+        double* pose = &poses[k*RTMC_NUM_AXES];
+        for(int m = 0; m < path->num_active_axes; m++) {
+            int i = path->active_axes[m];
+            double A = path->path->coefficients[i][0];
+            double B = path->path->coefficients[i][1];
+            double C = path->path->coefficients[i][2];
+            double D = path->path->coefficients[i][3];
+            if(rtmc_path_is_trigonometric_axis(path->path->type, i)) {
+                pose[i] = A*sin(B*(s[k] - C)) + D;
+            }
+            else {
+                pose[i] = ((A*s[k] + B)*s[k] + C)*s[k] + D;
+            }
+        }
+    }
+}
+
+
+
+batch_kernel_t find_batch_kernel(enum rtmc_kins_batch_kernel kernel) {
+    switch(kernel) {
+        case RTMC_KINS_BATCH_AUTO:
+#ifdef BATCH_HAVE_X86_KERNELS
+            if(find_batch_kernel(RTMC_KINS_BATCH_AVX2)) {
+                return pose_batch_avx2;
+            }
+            if(find_batch_kernel(RTMC_KINS_BATCH_SSE2)) {
+                return pose_batch_sse2;
+            }
+#endif
+            return pose_batch_portable;
+
+        case RTMC_KINS_BATCH_PORTABLE:
+            return pose_batch_portable;
+
+#ifdef BATCH_HAVE_X86_KERNELS
+        case RTMC_KINS_BATCH_SSE2:
+            return __builtin_cpu_supports("sse2") ? pose_batch_sse2 : NULL;
+
+        case RTMC_KINS_BATCH_AVX2:
+            return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) ? pose_batch_avx2 : NULL;
+#endif
+
+        default:
+            return NULL;
+    }
+}
@@ -0,0 +1,100 @@
+/*
+    kins/batch.h
+
+    Kernels for `rtmc_kins_scalar_pose_batch()`. The SIMD kernels vectorize
+    polynomial paths across axes (each pose is a few vectors, evaluated with
+    Horner's rule), and other paths across values of s (each trigonometric
+    axis is evaluated for 2 (SSE2) or 4 (AVX2) values of s at a time, with
+    `batch_sin()`'s algorithm).
+
+    Across values of s, the poses are filled in blocks of
+    `BATCH_BLOCK_SIZE`, so a block's poses stay in cache while each axis is
+    written into them.
+*/
+
+#ifndef KINS_BATCH_H
+#define KINS_BATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "rtmc_kins_scalar.h"
+#include "rtmc_path.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BATCH_HAVE_X86_KERNELS
+#endif
+
+#define BATCH_BLOCK_SIZE 64
+
+// the loaded path (in joint space), as the kernels see it
+typedef struct {
+    const rtmc_path_t* path;
+    const double* idle_pose;
+    const int* active_axes;
+    int num_active_axes;
+} batch_path_t;
+
+typedef void (*batch_kernel_t)(const batch_path_t* path, const double* s, size_t n, double* poses);
+
+void pose_batch_portable(const batch_path_t* path, const double* s, size_t n, double* poses);
+#ifdef BATCH_HAVE_X86_KERNELS
+void pose_batch_sse2(const batch_path_t* path, const double* s, size_t n, double* poses);
+void pose_batch_avx2(const batch_path_t* path, const double* s, size_t n, double* poses);
+#endif
+
+// returns the kernel (NULL if it isn't supported here)
+batch_kernel_t find_batch_kernel(enum rtmc_kins_batch_kernel kernel);
+
+
+
+/*
+    sin(x), as computed by the SIMD kernels (for their leftover values):
+     1. x = j*pi/2 + y, with |y| <= pi/4 (pi/2 is split into three parts,
+        so j*pi/2 is exact for |x| < BATCH_SIN_MAX_ARGUMENT)
+     2. sin(y) or cos(y) from minimax polynomials (fdlibm's), depending on
+        the quadrant j mod 4, negated in the lower half-plane
+    Larger arguments (and NaNs) fall back to `sin()`.
+*/
+#define BATCH_SIN_MAX_ARGUMENT 1e5
+
+#define BATCH_TWO_OVER_PI 6.36619772367581382433e-01
+#define BATCH_PI_OVER_2_1 1.57079632673412561417e+00
+#define BATCH_PI_OVER_2_2 6.07710050630396597660e-11
+#define BATCH_PI_OVER_2_3 2.02226624879595063154e-21
+
+// rounds to the nearest integer (for |x| < 2^51) when added and subtracted
+#define BATCH_ROUNDING_CONSTANT 6755399441055744.0 // 1.5 * 2^52
+
+#define BATCH_SIN_1 -1.66666666666666324348e-01
+#define BATCH_SIN_2  8.33333333332248946124e-03
+#define BATCH_SIN_3 -1.98412698298579493134e-04
+#define BATCH_SIN_4  2.75573137070700676789e-06
+#define BATCH_SIN_5 -2.50507602534068634195e-08
+#define BATCH_SIN_6  1.58969099521155010221e-10
+
+#define BATCH_COS_1  4.16666666666666019037e-02
+#define BATCH_COS_2 -1.38888888888741095749e-03
+#define BATCH_COS_3  2.48015872894767294178e-05
+#define BATCH_COS_4 -2.75573143513906633035e-07
+#define BATCH_COS_5  2.08757232129817482790e-09
+#define BATCH_COS_6 -1.13596475577881948265e-11
+
+double batch_sin(double x);
+
+// copies the idle pose into poses `start` to `end` (minus one)
+void batch_fill_idle(const batch_path_t* path, size_t start, size_t end, double* poses);
+
+// evaluates one axis with Horner's rule or `batch_sin()` (for the SIMD
+// kernels' leftover values of s)
+static inline double batch_evaluate(const double* coefficients, bool is_trigonometric, double s) {
+    double A = coefficients[0];
+    double B = coefficients[1];
+    double C = coefficients[2];
+    double D = coefficients[3];
+    if(is_trigonometric) {
+        return A*batch_sin(B*(s - C)) + D;
+    }
+    return ((A*s + B)*s + C)*s + D;
+}
+
+#endif // KINS_BATCH_H
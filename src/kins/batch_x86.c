@@ -0,0 +1,297 @@
+/*
+    kins/batch_x86.c
+
+    SSE2 and AVX2 batch kernels. They're compiled for their instruction
+    sets with target attributes (so the rest of the library doesn't need
+    them), and only called after checking the CPU (see
+    `find_batch_kernel()`).
+*/
+
+#include "batch.h"
+
+#ifdef BATCH_HAVE_X86_KERNELS
+
+#include <immintrin.h>
+#include <math.h>
+#include <stdint.h>
+
+#define SIGN_BIT 0x8000000000000000LL
+
+// a polynomial path's coefficients by power (rather than by axis), so they
+// can be loaded a few axes at a time
+typedef struct {
+    double coefficients[RTMC_NUM_PATH_COEFFICIENTS][RTMC_NUM_AXES];
+    int64_t is_active[RTMC_NUM_AXES]; // all ones if active, else zero
+} polynomial_axes_t;
+
+static void transpose_polynomial(const batch_path_t* path, polynomial_axes_t* axes) {
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        for(int j = 0; j < RTMC_NUM_PATH_COEFFICIENTS; j++) {
+            axes->coefficients[j][i] = path->path->coefficients[i][j];
+        }
+        axes->is_active[i] = 0;
+    }
+    for(int m = 0; m < path->num_active_axes; m++) {
+        axes->is_active[path->active_axes[m]] = -1;
+    }
+}
+
+// evaluates the axes a vector kernel doesn't cover
+static void polynomial_leftover(const polynomial_axes_t* axes, int first_axis, double s, double* pose) {
+    for(int i = first_axis; i < RTMC_NUM_AXES; i++) {
+        double A = axes->coefficients[0][i];
+        double B = axes->coefficients[1][i];
+        double C = axes->coefficients[2][i];
+        double D = axes->coefficients[3][i];
+        pose[i] = axes->is_active[i] ? ((A*s + B)*s + C)*s + D : D;
+    }
+}
+
+/*
+    SSE2 (2 values of s at a time)
+*/
+__attribute__((target("sse2")))
+static __m128d sin_sse2(__m128d x) {
+    __m128d t = _mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(BATCH_TWO_OVER_PI)), _mm_set1_pd(BATCH_ROUNDING_CONSTANT));
+    __m128d j = _mm_sub_pd(t, _mm_set1_pd(BATCH_ROUNDING_CONSTANT));
+    __m128d y = _mm_sub_pd(x, _mm_mul_pd(j, _mm_set1_pd(BATCH_PI_OVER_2_1)));
+    y = _mm_sub_pd(y, _mm_mul_pd(j, _mm_set1_pd(BATCH_PI_OVER_2_2)));
+    y = _mm_sub_pd(y, _mm_mul_pd(j, _mm_set1_pd(BATCH_PI_OVER_2_3)));
+    __m128d z = _mm_mul_pd(y, y);
+
+    __m128d sine = _mm_add_pd(_mm_mul_pd(z, _mm_set1_pd(BATCH_SIN_6)), _mm_set1_pd(BATCH_SIN_5));
+    sine = _mm_add_pd(_mm_mul_pd(z, sine), _mm_set1_pd(BATCH_SIN_4));
+    sine = _mm_add_pd(_mm_mul_pd(z, sine), _mm_set1_pd(BATCH_SIN_3));
+    sine = _mm_add_pd(_mm_mul_pd(z, sine), _mm_set1_pd(BATCH_SIN_2));
+    sine = _mm_add_pd(_mm_mul_pd(z, sine), _mm_set1_pd(BATCH_SIN_1));
+    sine = _mm_add_pd(y, _mm_mul_pd(_mm_mul_pd(y, z), sine));
+
+    __m128d cosine = _mm_add_pd(_mm_mul_pd(z, _mm_set1_pd(BATCH_COS_6)), _mm_set1_pd(BATCH_COS_5));
+    cosine = _mm_add_pd(_mm_mul_pd(z, cosine), _mm_set1_pd(BATCH_COS_4));
+    cosine = _mm_add_pd(_mm_mul_pd(z, cosine), _mm_set1_pd(BATCH_COS_3));
+    cosine = _mm_add_pd(_mm_mul_pd(z, cosine), _mm_set1_pd(BATCH_COS_2));
+    cosine = _mm_add_pd(_mm_mul_pd(z, cosine), _mm_set1_pd(BATCH_COS_1));
+    cosine = _mm_add_pd(_mm_sub_pd(_mm_set1_pd(1), _mm_mul_pd(_mm_set1_pd(0.5), z)), _mm_mul_pd(_mm_mul_pd(z, z), cosine));
+
+    // the low bits of `t` are j, so bit 0 picks cos and bit 1 negates (SSE2
+    // has no 64-bit compare, so bit 0 is spread over the whole lane)
+    __m128i quadrant = _mm_castpd_si128(t);
+    __m128i odd = _mm_and_si128(quadrant, _mm_set1_epi64x(1));
+    __m128i use_cosine = _mm_shuffle_epi32(_mm_cmpeq_epi32(odd, _mm_set1_epi64x(1)), _MM_SHUFFLE(2, 2, 0, 0));
+    __m128d result = _mm_or_pd(
+        _mm_and_pd(_mm_castsi128_pd(use_cosine), cosine),
+        _mm_andnot_pd(_mm_castsi128_pd(use_cosine), sine)
+    );
+    __m128i sign = _mm_and_si128(_mm_slli_epi64(quadrant, 62), _mm_set1_epi64x(SIGN_BIT));
+    result = _mm_xor_pd(result, _mm_castsi128_pd(sign));
+
+    // large arguments (and NaNs) fall back to `sin()`
+    __m128d magnitude = _mm_andnot_pd(_mm_castsi128_pd(_mm_set1_epi64x(SIGN_BIT)), x);
+    if(_mm_movemask_pd(_mm_cmplt_pd(magnitude, _mm_set1_pd(BATCH_SIN_MAX_ARGUMENT))) != 0x3) {
+        double lanes[2];
+        _mm_storeu_pd(lanes, x);
+        return _mm_setr_pd(batch_sin(lanes[0]), batch_sin(lanes[1]));
+    }
+
+    return result;
+}
+
+// polynomial paths, across axes (idle axes are blended back to their pose,
+// so they hold it even if s isn't finite)
+__attribute__((target("sse2")))
+static void polynomial_sse2(const batch_path_t* path, const double* s, size_t n, double* poses) {
+    polynomial_axes_t axes;
+    transpose_polynomial(path, &axes);
+
+    const int vector_axes = RTMC_NUM_AXES - RTMC_NUM_AXES%2;
+    for(size_t k = 0; k < n; k++) {
+        double* pose = &poses[k*RTMC_NUM_AXES];
+        __m128d x = _mm_set1_pd(s[k]);
+        for(int i = 0; i < vector_axes; i += 2) {
+            __m128d D = _mm_loadu_pd(&axes.coefficients[3][i]);
+            __m128d value = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(&axes.coefficients[0][i]), x), _mm_loadu_pd(&axes.coefficients[1][i]));
+            value = _mm_add_pd(_mm_mul_pd(value, x), _mm_loadu_pd(&axes.coefficients[2][i]));
+            value = _mm_add_pd(_mm_mul_pd(value, x), D);
+
+            __m128d is_active = _mm_loadu_pd((const double*)&axes.is_active[i]);
+            _mm_storeu_pd(&pose[i], _mm_or_pd(_mm_and_pd(is_active, value), _mm_andnot_pd(is_active, D)));
+        }
+        polynomial_leftover(&axes, vector_axes, s[k], pose);
+    }
+}
+
+// other paths, across values of s
+__attribute__((target("sse2")))
+static void mixed_sse2(const batch_path_t* path, const double* s, size_t n, double* poses) {
+    for(size_t start = 0; start < n; start += BATCH_BLOCK_SIZE) {
+        size_t end = (n - start > BATCH_BLOCK_SIZE) ? start + BATCH_BLOCK_SIZE : n;
+        batch_fill_idle(path, start, end, poses);
+
+        for(int m = 0; m < path->num_active_axes; m++) {
+            int i = path->active_axes[m];
+            const double* coefficients = path->path->coefficients[i];
+            bool is_trigonometric = rtmc_path_is_trigonometric_axis(path->path->type, i);
+            __m128d A = _mm_set1_pd(coefficients[0]);
+            __m128d B = _mm_set1_pd(coefficients[1]);
+            __m128d C = _mm_set1_pd(coefficients[2]);
+            __m128d D = _mm_set1_pd(coefficients[3]);
+
+            size_t k = start;
+            for(; k + 2 <= end; k += 2) {
+                __m128d x = _mm_loadu_pd(&s[k]);
+                __m128d value;
+                if(is_trigonometric) {
+                    value = _mm_add_pd(_mm_mul_pd(A, sin_sse2(_mm_mul_pd(B, _mm_sub_pd(x, C)))), D);
+                }
+                else {
+                    value = _mm_add_pd(_mm_mul_pd(A, x), B);
+                    value = _mm_add_pd(_mm_mul_pd(value, x), C);
+                    value = _mm_add_pd(_mm_mul_pd(value, x), D);
+                }
+
+                // the poses are RTMC_NUM_AXES apart
+                _mm_storel_pd(&poses[k*RTMC_NUM_AXES + i], value);
+                _mm_storeh_pd(&poses[(k + 1)*RTMC_NUM_AXES + i], value);
+            }
+            for(; k < end; k++) {
+                poses[k*RTMC_NUM_AXES + i] = batch_evaluate(coefficients, is_trigonometric, s[k]);
+            }
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+void pose_batch_sse2(const batch_path_t* path, const double* s, size_t n, double* poses) {
+    if(path->path->type == RTMC_PATH_TYPE_POLYNOMIAL) {
+        polynomial_sse2(path, s, n, poses);
+    }
+    else {
+        mixed_sse2(path, s, n, poses);
+    }
+}
+
+
+
+/*
+    AVX2 and FMA (4 values of s at a time)
+*/
+__attribute__((target("avx2,fma")))
+static __m256d sin_avx2(__m256d x) {
+    __m256d t = _mm256_fmadd_pd(x, _mm256_set1_pd(BATCH_TWO_OVER_PI), _mm256_set1_pd(BATCH_ROUNDING_CONSTANT));
+    __m256d j = _mm256_sub_pd(t, _mm256_set1_pd(BATCH_ROUNDING_CONSTANT));
+    __m256d y = _mm256_fnmadd_pd(j, _mm256_set1_pd(BATCH_PI_OVER_2_1), x);
+    y = _mm256_fnmadd_pd(j, _mm256_set1_pd(BATCH_PI_OVER_2_2), y);
+    y = _mm256_fnmadd_pd(j, _mm256_set1_pd(BATCH_PI_OVER_2_3), y);
+    __m256d z = _mm256_mul_pd(y, y);
+
+    __m256d sine = _mm256_fmadd_pd(z, _mm256_set1_pd(BATCH_SIN_6), _mm256_set1_pd(BATCH_SIN_5));
+    sine = _mm256_fmadd_pd(z, sine, _mm256_set1_pd(BATCH_SIN_4));
+    sine = _mm256_fmadd_pd(z, sine, _mm256_set1_pd(BATCH_SIN_3));
+    sine = _mm256_fmadd_pd(z, sine, _mm256_set1_pd(BATCH_SIN_2));
+    sine = _mm256_fmadd_pd(z, sine, _mm256_set1_pd(BATCH_SIN_1));
+    sine = _mm256_fmadd_pd(_mm256_mul_pd(y, z), sine, y);
+
+    __m256d cosine = _mm256_fmadd_pd(z, _mm256_set1_pd(BATCH_COS_6), _mm256_set1_pd(BATCH_COS_5));
+    cosine = _mm256_fmadd_pd(z, cosine, _mm256_set1_pd(BATCH_COS_4));
+    cosine = _mm256_fmadd_pd(z, cosine, _mm256_set1_pd(BATCH_COS_3));
+    cosine = _mm256_fmadd_pd(z, cosine, _mm256_set1_pd(BATCH_COS_2));
+    cosine = _mm256_fmadd_pd(z, cosine, _mm256_set1_pd(BATCH_COS_1));
+    cosine = _mm256_fmadd_pd(_mm256_mul_pd(z, z), cosine, _mm256_fnmadd_pd(_mm256_set1_pd(0.5), z, _mm256_set1_pd(1)));
+
+    // the low bits of `t` are j, so bit 0 picks cos and bit 1 negates
+    __m256i quadrant = _mm256_castpd_si256(t);
+    __m256i odd = _mm256_and_si256(quadrant, _mm256_set1_epi64x(1));
+    __m256d use_cosine = _mm256_castsi256_pd(_mm256_cmpeq_epi64(odd, _mm256_set1_epi64x(1)));
+    __m256d result = _mm256_blendv_pd(sine, cosine, use_cosine);
+    __m256i sign = _mm256_and_si256(_mm256_slli_epi64(quadrant, 62), _mm256_set1_epi64x(SIGN_BIT));
+    result = _mm256_xor_pd(result, _mm256_castsi256_pd(sign));
+
+    // large arguments (and NaNs) fall back to `sin()`
+    __m256d magnitude = _mm256_andnot_pd(_mm256_castsi256_pd(_mm256_set1_epi64x(SIGN_BIT)), x);
+    if(_mm256_movemask_pd(_mm256_cmp_pd(magnitude, _mm256_set1_pd(BATCH_SIN_MAX_ARGUMENT), _CMP_LT_OQ)) != 0xf) {
+        double lanes[4];
+        _mm256_storeu_pd(lanes, x);
+        return _mm256_setr_pd(batch_sin(lanes[0]), batch_sin(lanes[1]), batch_sin(lanes[2]), batch_sin(lanes[3]));
+    }
+
+    return result;
+}
+
+// polynomial paths, across axes
+__attribute__((target("avx2,fma")))
+static void polynomial_avx2(const batch_path_t* path, const double* s, size_t n, double* poses) {
+    polynomial_axes_t axes;
+    transpose_polynomial(path, &axes);
+
+    const int vector_axes = RTMC_NUM_AXES - RTMC_NUM_AXES%4;
+    for(size_t k = 0; k < n; k++) {
+        double* pose = &poses[k*RTMC_NUM_AXES];
+        __m256d x = _mm256_set1_pd(s[k]);
+        for(int i = 0; i < vector_axes; i += 4) {
+            __m256d D = _mm256_loadu_pd(&axes.coefficients[3][i]);
+            __m256d value = _mm256_fmadd_pd(_mm256_loadu_pd(&axes.coefficients[0][i]), x, _mm256_loadu_pd(&axes.coefficients[1][i]));
+            value = _mm256_fmadd_pd(value, x, _mm256_loadu_pd(&axes.coefficients[2][i]));
+            value = _mm256_fmadd_pd(value, x, D);
+
+            __m256d is_active = _mm256_loadu_pd((const double*)&axes.is_active[i]);
+            _mm256_storeu_pd(&pose[i], _mm256_blendv_pd(D, value, is_active));
+        }
+        polynomial_leftover(&axes, vector_axes, s[k], pose);
+    }
+}
+
+// other paths, across values of s
+__attribute__((target("avx2,fma")))
+static void mixed_avx2(const batch_path_t* path, const double* s, size_t n, double* poses) {
+    for(size_t start = 0; start < n; start += BATCH_BLOCK_SIZE) {
+        size_t end = (n - start > BATCH_BLOCK_SIZE) ? start + BATCH_BLOCK_SIZE : n;
+        batch_fill_idle(path, start, end, poses);
+
+        for(int m = 0; m < path->num_active_axes; m++) {
+            int i = path->active_axes[m];
+            const double* coefficients = path->path->coefficients[i];
+            bool is_trigonometric = rtmc_path_is_trigonometric_axis(path->path->type, i);
+            __m256d A = _mm256_set1_pd(coefficients[0]);
+            __m256d B = _mm256_set1_pd(coefficients[1]);
+            __m256d C = _mm256_set1_pd(coefficients[2]);
+            __m256d D = _mm256_set1_pd(coefficients[3]);
+
+            size_t k = start;
+            for(; k + 4 <= end; k += 4) {
+                __m256d x = _mm256_loadu_pd(&s[k]);
+                __m256d value;
+                if(is_trigonometric) {
+                    value = _mm256_fmadd_pd(A, sin_avx2(_mm256_mul_pd(B, _mm256_sub_pd(x, C))), D);
+                }
+                else {
+                    value = _mm256_fmadd_pd(A, x, B);
+                    value = _mm256_fmadd_pd(value, x, C);
+                    value = _mm256_fmadd_pd(value, x, D);
+                }
+
+                // the poses are RTMC_NUM_AXES apart
+                __m128d low = _mm256_castpd256_pd128(value);
+                __m128d high = _mm256_extractf128_pd(value, 1);
+                _mm_storel_pd(&poses[k*RTMC_NUM_AXES + i], low);
+                _mm_storeh_pd(&poses[(k + 1)*RTMC_NUM_AXES + i], low);
+                _mm_storel_pd(&poses[(k + 2)*RTMC_NUM_AXES + i], high);
+                _mm_storeh_pd(&poses[(k + 3)*RTMC_NUM_AXES + i], high);
+            }
+            for(; k < end; k++) {
+                poses[k*RTMC_NUM_AXES + i] = batch_evaluate(coefficients, is_trigonometric, s[k]);
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+void pose_batch_avx2(const batch_path_t* path, const double* s, size_t n, double* poses) {
+    if(path->path->type == RTMC_PATH_TYPE_POLYNOMIAL) {
+        polynomial_avx2(path, s, n, poses);
+    }
+    else {
+        mixed_avx2(path, s, n, poses);
+    }
+}
+
+#endif // BATCH_HAVE_X86_KERNELS
@@ -3,13 +3,26 @@
 */
 
 #include <math.h>
+#include <stdatomic.h>
 #include "rtmc_kins_scalar.h"
 #include "rtmc_magic_numbers.h"
+#include "../trace.h"
+#include "batch.h"
 
 
 static rtmc_path_t scaled_path;
 static double scale_factors[RTMC_NUM_AXES];
 
+// idle axes don't move, so their pose is computed once in `load()`
+static double idle_pose[RTMC_NUM_AXES];
+static int active_axes[RTMC_NUM_AXES];
+static int num_active_axes;
+
+// picked on first use, unless `rtmc_kins_scalar_set_batch_kernel()` is
+// called first (atomic, since either can happen on any thread; it only
+// points at code, so relaxed ordering is enough)
+static _Atomic(batch_kernel_t) batch_kernel = NULL;
+
 
 
 void rtmc_kins_scalar_setup(const double* sf) {
@@ -21,36 +34,51 @@ void rtmc_kins_scalar_setup(const double* sf) {
 
 
 void rtmc_kins_scalar_load(rtmc_path_t path) {
+    TRACE_BEGIN();
+
     // initialize the path
     scaled_path = path;
 
-    // scale the coefficients
-    switch(scaled_path.type) {
-        case RTMC_PATH_TYPE_POLYNOMIAL:
-            // for polynomial, scale every coefficient
-            for(int i = 0; i < RTMC_NUM_AXES; i++) {
-                for(int j = 0; j < RTMC_NUM_PATH_COEFFICIENTS; j++) {
-                    scaled_path.coefficients[i][j] *= scale_factors[i];
-                }
+    // scale the coefficients (for polynomial axes, every coefficient, and
+    // for trigonometric axes, the first and last)
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(rtmc_path_is_trigonometric_axis(scaled_path.type, i)) {
+            scaled_path.coefficients[i][0] *= scale_factors[i];
+            scaled_path.coefficients[i][3] *= scale_factors[i];
+        }
+        else {
+            for(int j = 0; j < RTMC_NUM_PATH_COEFFICIENTS; j++) {
+                scaled_path.coefficients[i][j] *= scale_factors[i];
             }
-            break;
+        }
+    }
 
-        case RTMC_PATH_TYPE_TRIGONOMETRIC:
-            // for trigonometric, scale the first and last coefficients
-            for(int i = 0; i < RTMC_NUM_AXES; i++) {
-                scaled_path.coefficients[i][0] *= scale_factors[i];
-                scaled_path.coefficients[i][3] *= scale_factors[i];
-            }
-            break;
+    // sort out which axes need to be evaluated
+    uint16_t active_mask = rtmc_path_active_axes(&scaled_path);
+    num_active_axes = 0;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        idle_pose[i] = scaled_path.coefficients[i][3];
+        if(active_mask & (1 << i)) {
+            active_axes[num_active_axes++] = i;
+        }
     }
+
+    TRACE_END(TRACE_KINS_LOAD);
 }
 
 
 
 void rtmc_kins_scalar_pose(double* pose, double s) {
+    TRACE_BEGIN();
+
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        pose[i] = idle_pose[i];
+    }
+
     switch(scaled_path.type) {
         case RTMC_PATH_TYPE_POLYNOMIAL:
-            for(int i = 0; i < RTMC_NUM_AXES; i++) {
+            for(int k = 0; k < num_active_axes; k++) {
+                int i = active_axes[k];
                 double A = scaled_path.coefficients[i][0];
                 double B = scaled_path.coefficients[i][1];
                 double C = scaled_path.coefficients[i][2];
@@ -60,7 +88,8 @@ void rtmc_kins_scalar_pose(double* pose, double s) {
             break;
         
         case RTMC_PATH_TYPE_TRIGONOMETRIC:
-            for(int i = 0; i < RTMC_NUM_AXES; i++) {
+            for(int k = 0; k < num_active_axes; k++) {
+                int i = active_axes[k];
                 double A = scaled_path.coefficients[i][0];
                 double B = scaled_path.coefficients[i][1];
                 double C = scaled_path.coefficients[i][2];
@@ -68,5 +97,60 @@ void rtmc_kins_scalar_pose(double* pose, double s) {
                 pose[i] = A*sin(B*(s - C)) + D;
             }
             break;
+
+        default:
+            // helical paths mix both forms
+            for(int k = 0; k < num_active_axes; k++) {
+                int i = active_axes[k];
+                double A = scaled_path.coefficients[i][0];
+                double B = scaled_path.coefficients[i][1];
+                double C = scaled_path.coefficients[i][2];
+                double D = scaled_path.coefficients[i][3];
+                if(rtmc_path_is_trigonometric_axis(scaled_path.type, i)) {
+                    pose[i] = A*sin(B*(s - C)) + D;
+                }
+                else {
+                    pose[i] = A*pow(s, 3) + B*pow(s, 2) + C*s + D;
+                }
+            }
+            break;
+    }
+
+    TRACE_END(TRACE_KINS_POSE);
+}
+
+
+
+void rtmc_kins_scalar_stepper_init(rtmc_path_stepper_t* stepper, double s0, double ds) {
+    rtmc_path_stepper_init(stepper, &scaled_path, s0, ds);
+}
+
+
+
+void rtmc_kins_scalar_pose_batch(const double* s, size_t n, double* poses) {
+    TRACE_BEGIN();
+
+    batch_kernel_t kernel = atomic_load_explicit(&batch_kernel, memory_order_relaxed);
+    if(kernel == NULL) {
+        // if another thread got there first, its kernel is kept
+        batch_kernel_t found = find_batch_kernel(RTMC_KINS_BATCH_AUTO);
+        if(atomic_compare_exchange_strong_explicit(&batch_kernel, &kernel, found, memory_order_relaxed, memory_order_relaxed)) {
+            kernel = found;
+        }
     }
+
+    batch_path_t path = {&scaled_path, idle_pose, active_axes, num_active_axes};
+    kernel(&path, s, n, poses);
+
+    TRACE_END(TRACE_KINS_POSE_BATCH);
+}
+
+bool rtmc_kins_scalar_set_batch_kernel(enum rtmc_kins_batch_kernel kernel) {
+    batch_kernel_t found = find_batch_kernel(kernel);
+    if(found == NULL) {
+        return false;
+    }
+
+    atomic_store_explicit(&batch_kernel, found, memory_order_relaxed);
+    return true;
 }
@@ -0,0 +1,255 @@
+/*
+    parser/checkpoints.c
+
+    Each checkpoint is a copy of the modal state that carries over between
+    blocks, taken just before a line is parsed. Non-modal data and the start
+    coordinates are reset by every block, so they aren't needed.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../alloc.h"
+#include "parser.h"
+#include "rtmc_checkpoints.h"
+
+// bump whenever `checkpoint_t` or the file layout changes
+#define CHECKPOINT_FILE_VERSION 1
+static const char checkpoint_file_magic[8] = "RTMCCKPT";
+
+typedef struct {
+    size_t line; // the line about to be parsed
+    size_t offset; // index of that line within the program
+    modal_data_t modal_data;
+    double feed_rate;
+    double end_coords[RTMC_NUM_AXES];
+} checkpoint_t;
+
+struct rtmc_checkpoints {
+    size_t interval;
+    checkpoint_t* list; // sorted by line
+    size_t count;
+    size_t capacity;
+};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t checkpoint_size;
+    uint64_t interval;
+    uint64_t count;
+} checkpoint_file_header_t;
+
+
+
+/*
+    Create and destroy sets of checkpoints
+*/
+rtmc_checkpoints_t* rtmc_create_checkpoints(size_t interval) {
+    if(interval == 0) {
+        return NULL;
+    }
+
+    rtmc_checkpoints_t* checkpoints = (rtmc_checkpoints_t*)rtmc_malloc(sizeof(rtmc_checkpoints_t));
+    if(checkpoints) {
+        checkpoints->interval = interval;
+        checkpoints->list = NULL;
+        checkpoints->count = 0;
+        checkpoints->capacity = 0;
+    }
+
+    return checkpoints;
+}
+
+void rtmc_destroy_checkpoints(rtmc_checkpoints_t* checkpoints) {
+    if(checkpoints) {
+        rtmc_free(checkpoints->list);
+        rtmc_free(checkpoints);
+    }
+}
+
+size_t rtmc_checkpoint_count(const rtmc_checkpoints_t* checkpoints) {
+    return checkpoints->count;
+}
+
+void rtmc_set_parser_checkpoints(rtmc_parser_t* parser, rtmc_checkpoints_t* checkpoints) {
+    parser->checkpoints = checkpoints;
+}
+
+
+
+/*
+    Record and restore checkpoints
+*/
+void record_checkpoint(rtmc_parser_t* parser, size_t line, size_t offset) {
+    rtmc_checkpoints_t* checkpoints = parser->checkpoints;
+    if((line - 1) % checkpoints->interval != 0) {
+        return;
+    }
+
+    // parsing a program again replaces its later checkpoints
+    while(checkpoints->count > 0 && checkpoints->list[checkpoints->count - 1].line >= line) {
+        checkpoints->count--;
+    }
+
+    if(checkpoints->count == checkpoints->capacity) {
+        size_t new_capacity = (checkpoints->capacity == 0) ? 64 : checkpoints->capacity * 2;
+        checkpoint_t* new_list = (checkpoint_t*)rtmc_realloc(checkpoints->list, new_capacity * sizeof(checkpoint_t));
+        if(!new_list) {
+            // restoring still works from an earlier checkpoint (just slower)
+            return;
+        }
+        checkpoints->list = new_list;
+        checkpoints->capacity = new_capacity;
+    }
+
+    checkpoint_t* checkpoint = &checkpoints->list[checkpoints->count++];
+    checkpoint->line = line;
+    checkpoint->offset = offset;
+    checkpoint->modal_data = parser->modal_data;
+    checkpoint->feed_rate = parser->feed_rate;
+    memcpy(checkpoint->end_coords, parser->end_coords, sizeof(checkpoint->end_coords));
+}
+
+size_t checkpoints_interval(const rtmc_checkpoints_t* checkpoints) {
+    return checkpoints->interval;
+}
+
+size_t checkpoints_data_size(size_t count) {
+    return count * sizeof(checkpoint_t);
+}
+
+void copy_checkpoints_out(const rtmc_checkpoints_t* checkpoints, void* data) {
+    memcpy(data, checkpoints->list, checkpoints_data_size(checkpoints->count));
+}
+
+// replaces every checkpoint (as parsing a program from the start does)
+bool copy_checkpoints_in(rtmc_checkpoints_t* checkpoints, const void* data, size_t count) {
+    if(count > checkpoints->capacity) {
+        checkpoint_t* new_list = (checkpoint_t*)rtmc_realloc(checkpoints->list, checkpoints_data_size(count));
+        if(!new_list) {
+            return false;
+        }
+        checkpoints->list = new_list;
+        checkpoints->capacity = count;
+    }
+
+    memcpy(checkpoints->list, data, checkpoints_data_size(count));
+    checkpoints->count = count;
+    return true;
+}
+
+bool rtmc_restore_checkpoint(
+    const rtmc_checkpoints_t* checkpoints, rtmc_parser_t* parser,
+    const char* buffer, size_t length, size_t line, size_t* offset
+) {
+    // binary search for the last checkpoint at or before `line`
+    size_t low = 0;
+    size_t high = checkpoints->count;
+    while(low < high) {
+        size_t middle = low + (high - low) / 2;
+        if(checkpoints->list[middle].line <= line) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    if(low == 0) {
+        return false;
+    }
+    const checkpoint_t* checkpoint = &checkpoints->list[low - 1];
+
+    // the rest of the program is parsed as if it started at `line`, which
+    // would record checkpoints with the wrong line numbers and offsets
+    parser->checkpoints = NULL;
+
+    // load the checkpoint
+    rtmc_flush_parser_data_ctx(parser);
+    parser->modal_data = checkpoint->modal_data;
+    parser->feed_rate = checkpoint->feed_rate;
+    memcpy(parser->end_coords, checkpoint->end_coords, sizeof(parser->end_coords));
+
+    // parse the gap, throwing the paths away as they're generated
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_parsed_block_t parsed_block;
+    size_t i = checkpoint->offset;
+    for(size_t current_line = checkpoint->line; current_line < line && i < length; current_line++) {
+        size_t line_start = i;
+        i += find_line_end(buffer + i, length - i);
+        parse_block(parser, &queue, buffer + line_start, i - line_start, &parsed_block);
+        rtmc_path_queue_release(&queue);
+
+        i = skip_terminator(buffer, length, i);
+    }
+    rtmc_flush_path_queue(&queue);
+
+    // the program ended before `line`
+    if(i >= length) {
+        return false;
+    }
+
+    *offset = i;
+    return true;
+}
+
+
+
+/*
+    Save and load checkpoints
+*/
+bool rtmc_save_checkpoints(const rtmc_checkpoints_t* checkpoints, const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if(file == NULL) {
+        return false;
+    }
+
+    checkpoint_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, checkpoint_file_magic, sizeof(header.magic));
+    header.version = CHECKPOINT_FILE_VERSION;
+    header.checkpoint_size = sizeof(checkpoint_t);
+    header.interval = checkpoints->interval;
+    header.count = checkpoints->count;
+
+    bool is_written = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(checkpoints->list, sizeof(checkpoint_t), checkpoints->count, file) == checkpoints->count;
+
+    // closing flushes the data, which can fail too
+    return (fclose(file) == 0) && is_written;
+}
+
+rtmc_checkpoints_t* rtmc_load_checkpoints(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if(file == NULL) {
+        return NULL;
+    }
+
+    // only accept files written by a matching build
+    checkpoint_file_header_t header;
+    if(fread(&header, sizeof(header), 1, file) != 1
+        || memcmp(header.magic, checkpoint_file_magic, sizeof(header.magic)) != 0
+        || header.version != CHECKPOINT_FILE_VERSION
+        || header.checkpoint_size != sizeof(checkpoint_t)
+        || header.count > SIZE_MAX / sizeof(checkpoint_t)) {
+        fclose(file);
+        return NULL;
+    }
+
+    rtmc_checkpoints_t* checkpoints = rtmc_create_checkpoints((size_t)header.interval);
+    if(checkpoints && header.count > 0) {
+        checkpoints->list = (checkpoint_t*)rtmc_malloc((size_t)header.count * sizeof(checkpoint_t));
+        checkpoints->capacity = (size_t)header.count;
+        if(!checkpoints->list
+            || fread(checkpoints->list, sizeof(checkpoint_t), (size_t)header.count, file) != header.count) {
+            rtmc_destroy_checkpoints(checkpoints);
+            checkpoints = NULL;
+        }
+        else {
+            checkpoints->count = (size_t)header.count;
+        }
+    }
+
+    fclose(file);
+    return checkpoints;
+}
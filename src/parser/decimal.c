@@ -0,0 +1,237 @@
+/*
+    parser/decimal.c
+
+    Converts g-code numbers to doubles without an intermediate string and
+    without depending on the C locale.
+
+    Grammar: [+-] ( digits [ '.' [digits] ] | '.' digits ) [ (e|E) [+-] digits ]
+
+    How the conversion works
+    ------------------------
+    While reading, the significant digits (leading zeros don't count) are
+    collected into a 64-bit integer `mantissa`, along with a power of ten
+    `exponent` so that value = mantissa * 10^exponent.
+
+    Fast path: if there are at most 19 significant digits, the mantissa fits
+    in a double exactly (<= 2^53), and |exponent| <= 22 (10^22 is the largest
+    exact power of ten in a double), a single multiplication or division
+    gives the correctly rounded result. This covers practically every number
+    found in g-code.
+
+    Slow path: the significant digits are kept as text (without a decimal
+    point, so the locale doesn't matter) and handed to `strtod()`. Up to
+    DECIMAL_MAX_DIGITS digits are kept; if any non-zero digits are dropped,
+    a trailing '1' is appended so rounding still goes the right way. That's
+    only safe if the kept digits already tell which side of a halfway point
+    (between two doubles) the value is on. A halfway point has at most 767
+    significant digits, so 768 are kept. (Fewer would round values just
+    above a long halfway point down.)
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "parser.h"
+
+#define MAX_FAST_DIGITS 19
+#define MAX_FAST_EXPONENT 22
+#define MAX_FAST_MANTISSA (1ULL << 53)
+
+// keeps huge exponents from overflowing an int (the result is 0 or INFINITY
+// long before this anyway)
+#define MAX_EXPONENT_VALUE 100000
+
+static const double powers_of_ten[MAX_FAST_EXPONENT + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+
+// adds one significant (or leading zero) digit to the number
+static inline void push_digit(decimal_t* decimal, int digit, bool is_fraction) {
+    decimal->has_digits = true;
+
+    if(decimal->num_digits == 0 && digit == 0) {
+        // leading zeros only shift the decimal point
+        if(is_fraction) {
+            decimal->exponent--;
+        }
+        return;
+    }
+
+    if(decimal->num_digits < MAX_FAST_DIGITS) {
+        decimal->mantissa = decimal->mantissa * 10 + digit;
+    }
+
+    if(decimal->num_digits < DECIMAL_MAX_DIGITS) {
+        decimal->digits[decimal->num_digits] = (char)('0' + digit);
+        if(is_fraction) {
+            decimal->exponent--;
+        }
+    }
+    else {
+        // the digit is dropped, but its place value still counts
+        if(!is_fraction) {
+            decimal->exponent++;
+        }
+        if(digit != 0) {
+            decimal->is_truncated = true;
+        }
+    }
+
+    decimal->num_digits++;
+}
+
+// feeds one char to the number (see the grammar above)
+static inline void push_char(decimal_t* decimal, char c) {
+    bool is_digit = (c >= '0' && c <= '9');
+
+    switch(decimal->state) {
+        case DECIMAL_START:
+        case DECIMAL_SIGN:
+            if(is_digit) {
+                decimal->state = DECIMAL_INTEGER;
+                push_digit(decimal, c - '0', false);
+            }
+            else if(c == '.') {
+                decimal->state = DECIMAL_FRACTION;
+            }
+            else if((c == '+' || c == '-') && decimal->state == DECIMAL_START) {
+                decimal->state = DECIMAL_SIGN;
+                decimal->is_negative = (c == '-');
+            }
+            else {
+                decimal->state = DECIMAL_ERROR;
+            }
+            break;
+
+        case DECIMAL_INTEGER:
+        case DECIMAL_FRACTION:
+            if(is_digit) {
+                push_digit(decimal, c - '0', decimal->state == DECIMAL_FRACTION);
+            }
+            else if(c == '.' && decimal->state == DECIMAL_INTEGER) {
+                decimal->state = DECIMAL_FRACTION;
+            }
+            else if((c == 'e' || c == 'E') && decimal->has_digits) {
+                decimal->state = DECIMAL_EXPONENT_START;
+            }
+            else {
+                decimal->state = DECIMAL_ERROR;
+            }
+            break;
+
+        case DECIMAL_EXPONENT_START:
+        case DECIMAL_EXPONENT_SIGN:
+        case DECIMAL_EXPONENT:
+            if(is_digit) {
+                decimal->state = DECIMAL_EXPONENT;
+                if(decimal->exponent_value < MAX_EXPONENT_VALUE) {
+                    decimal->exponent_value = decimal->exponent_value * 10 + (c - '0');
+                }
+            }
+            else if((c == '+' || c == '-') && decimal->state == DECIMAL_EXPONENT_START) {
+                decimal->state = DECIMAL_EXPONENT_SIGN;
+                decimal->is_exponent_negative = (c == '-');
+            }
+            else {
+                decimal->state = DECIMAL_ERROR;
+            }
+            break;
+
+        case DECIMAL_ERROR:
+            break;
+    }
+}
+
+
+
+void decimal_init(decimal_t* decimal) {
+    decimal->state = DECIMAL_START;
+    decimal->is_negative = false;
+    decimal->has_digits = false;
+    decimal->is_truncated = false;
+    decimal->is_exponent_negative = false;
+    decimal->num_digits = 0;
+    decimal->mantissa = 0;
+    decimal->exponent = 0;
+    decimal->exponent_value = 0;
+}
+
+void decimal_push(decimal_t* decimal, char c) {
+    push_char(decimal, c);
+}
+
+bool decimal_finish(const decimal_t* decimal, double* value) {
+    // the number must end after a digit
+    bool is_complete = decimal->has_digits && (
+        decimal->state == DECIMAL_INTEGER ||
+        decimal->state == DECIMAL_FRACTION ||
+        decimal->state == DECIMAL_EXPONENT
+    );
+    if(!is_complete) {
+        return false;
+    }
+
+    int exponent = decimal->exponent + (decimal->is_exponent_negative
+        ? -decimal->exponent_value
+        : decimal->exponent_value);
+
+    // zero (of either sign)
+    if(decimal->num_digits == 0) {
+        *value = decimal->is_negative ? -0.0 : 0.0;
+        return true;
+    }
+
+    // fast path (the mantissa and power of ten are both exact)
+    if(decimal->num_digits <= MAX_FAST_DIGITS &&
+        decimal->mantissa <= MAX_FAST_MANTISSA &&
+        exponent >= -MAX_FAST_EXPONENT && exponent <= MAX_FAST_EXPONENT) {
+
+        double result = (double)decimal->mantissa;
+        if(exponent < 0) {
+            result /= powers_of_ten[-exponent];
+        }
+        else {
+            result *= powers_of_ten[exponent];
+        }
+
+        *value = decimal->is_negative ? -result : result;
+        return true;
+    }
+
+    // slow path: "[-]<digits>[1]e<exponent>"
+    char str[DECIMAL_MAX_DIGITS + 16];
+    int length = 0;
+    int num_stored = (decimal->num_digits < DECIMAL_MAX_DIGITS)
+        ? decimal->num_digits
+        : DECIMAL_MAX_DIGITS;
+
+    if(decimal->is_negative) {
+        str[length++] = '-';
+    }
+    for(int i = 0; i < num_stored; i++) {
+        str[length++] = decimal->digits[i];
+    }
+    if(decimal->is_truncated) {
+        // sticky digit (just below the last stored digit)
+        str[length++] = '1';
+        exponent--;
+    }
+    snprintf(str + length, sizeof(str) - length, "e%d", exponent);
+
+    *value = strtod(str, NULL);
+    return true;
+}
+
+bool parse_decimal(const char* str, size_t length, double* value) {
+    decimal_t decimal;
+    decimal_init(&decimal);
+
+    for(size_t i = 0; i < length; i++) {
+        push_char(&decimal, str[i]);
+    }
+
+    return decimal_finish(&decimal, value);
+}
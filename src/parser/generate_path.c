@@ -3,6 +3,7 @@
 */
 
 #include <math.h>
+#include "../trace.h"
 #include "parser.h"
 #include "rtmc_math.h"
 #include "rtmc_parser.h"
@@ -45,18 +46,19 @@
     the Z-Axis would be polynomial-type (moving in a straight line), while the
     X and Y axes would be trigonometric-type (moving together in a circle).
 */
-void set_line_coefficients(rtmc_path_t* path) {
+void set_line_coefficients(const rtmc_parser_t* parser, rtmc_path_t* path) {
     for(int i = 0; i < RTMC_NUM_AXES; i++) {
         path->coefficients[i][0] = 0;
         path->coefficients[i][1] = 0;
-        path->coefficients[i][2] = end_coords[i] - start_coords[i];
-        path->coefficients[i][3] = start_coords[i];
+        path->coefficients[i][2] = parser->end_coords[i] - parser->start_coords[i];
+        path->coefficients[i][3] = parser->start_coords[i];
     }
 }
 
 
 
-void generate_path(rtmc_path_t* path, rtmc_parsed_block_t* parsed_block) {
+void generate_path(rtmc_parser_t* parser, rtmc_path_t* path, rtmc_parsed_block_t* parsed_block) {
+    TRACE_BEGIN();
 
     // set type to modal data by default
     parsed_block->type = RTMC_BLOCK_TYPE_MODAL;
@@ -64,23 +66,23 @@ void generate_path(rtmc_path_t* path, rtmc_parsed_block_t* parsed_block) {
     // handle motion mode (only if start/end coords are different)
     // TODO: this if statement only applies to arcs, not full circles!!
     //  (because start == end for full circles)
-    if(!rtmc_are_vectors_equal(start_coords, end_coords, RTMC_NUM_AXES)) {
+    if(!rtmc_are_vectors_equal(parser->start_coords, parser->end_coords, RTMC_NUM_AXES)) {
 
         // Rapid linear interpolation
-        if(modal_data.motion_mode == G00) {
+        if(parser->modal_data.motion_mode == G00) {
             parsed_block->type = RTMC_BLOCK_TYPE_PATH;
             path->type = RTMC_PATH_TYPE_POLYNOMIAL;
             path->feed_rate = RTMC_RAPID_RATE;
-            set_line_coefficients(path);
+            set_line_coefficients(parser, path);
         }
 
         // Linear interpolation
-        else if(modal_data.motion_mode == G01) {
-            if(rtmc_is_greater(feed_rate, 0)) {
+        else if(parser->modal_data.motion_mode == G01) {
+            if(rtmc_is_greater(parser->feed_rate, 0)) {
                 parsed_block->type = RTMC_BLOCK_TYPE_PATH;
                 path->type = RTMC_PATH_TYPE_POLYNOMIAL;
-                path->feed_rate = feed_rate;
-                set_line_coefficients(path);
+                path->feed_rate = parser->feed_rate;
+                set_line_coefficients(parser, path);
             }
             else {
                 // invalid feed rate, invalidate the block
@@ -91,14 +93,14 @@ void generate_path(rtmc_path_t* path, rtmc_parsed_block_t* parsed_block) {
     }
 
     // Circular interpolation
-    if(modal_data.motion_mode == G02 || modal_data.motion_mode == G03) {
+    if(parser->modal_data.motion_mode == G02 || parser->modal_data.motion_mode == G03) {
         // error handling
-        if(modal_data.plane_mode == UNDEFINED_PLANE_MODE) {
+        if(parser->modal_data.plane_mode == UNDEFINED_PLANE_MODE) {
             // invalid plane, invalidate the block
             parsed_block->is_valid = false;
             parsed_block->error_msg = "No plane selected";
         }
-        else if(rtmc_is_less_equal(feed_rate, 0)) {
+        else if(rtmc_is_less_equal(parser->feed_rate, 0)) {
             // invalid feed rate, invalidate the block
             parsed_block->is_valid = false;
             parsed_block->error_msg = "Feed rate is zero or negative";
@@ -107,7 +109,7 @@ void generate_path(rtmc_path_t* path, rtmc_parsed_block_t* parsed_block) {
             // determine plane
             int axis_0;
             int axis_1;
-            switch(modal_data.plane_mode) {
+            switch(parser->modal_data.plane_mode) {
                 case G17:
                     axis_0 = RTMC_X_AXIS;
                     axis_1 = RTMC_Y_AXIS;
@@ -128,12 +130,12 @@ void generate_path(rtmc_path_t* path, rtmc_parsed_block_t* parsed_block) {
             double start_point[2];
             double end_point[2];
             double offset_point[2];
-            start_point[0] = start_coords[axis_0];
-            start_point[1] = start_coords[axis_1];
-            end_point[0] = end_coords[axis_0];
-            end_point[1] = end_coords[axis_1];
-            offset_point[0] = non_modal_data.relative_offset[axis_0] + start_point[0];
-            offset_point[1] = non_modal_data.relative_offset[axis_1] + start_point[1];
+            start_point[0] = parser->start_coords[axis_0];
+            start_point[1] = parser->start_coords[axis_1];
+            end_point[0] = parser->end_coords[axis_0];
+            end_point[1] = parser->end_coords[axis_1];
+            offset_point[0] = parser->non_modal_data.relative_offset[axis_0] + start_point[0];
+            offset_point[1] = parser->non_modal_data.relative_offset[axis_1] + start_point[1];
 
             // more error handling (check if offset_point is valid)
             if(rtmc_are_vectors_equal(offset_point, start_point, 2)) {
@@ -148,9 +150,19 @@ void generate_path(rtmc_path_t* path, rtmc_parsed_block_t* parsed_block) {
                 // set basic path data
                 parsed_block->type = RTMC_BLOCK_TYPE_PATH;
                 path->type = RTMC_PATH_TYPE_TRIGONOMETRIC;
-                path->feed_rate = feed_rate;
+                path->feed_rate = parser->feed_rate;
 
-                bool is_clockwise = (modal_data.motion_mode == G02);
+                bool is_clockwise = (parser->modal_data.motion_mode == G02);
+
+                // axes outside of the plane stay where they are
+                double actual_end_coords[RTMC_NUM_AXES];
+                for(int i = 0; i < RTMC_NUM_AXES; i++) {
+                    path->coefficients[i][0] = 0;
+                    path->coefficients[i][1] = 0;
+                    path->coefficients[i][2] = 0;
+                    path->coefficients[i][3] = parser->start_coords[i];
+                    actual_end_coords[i] = parser->start_coords[i];
+                }
 
                 // find the coefficients
                 double A = rtmc_distance(start_point, offset_point, 2);
@@ -195,14 +207,15 @@ void generate_path(rtmc_path_t* path, rtmc_parsed_block_t* parsed_block) {
 
                 // find position error and set true end coordinates
                 // Note: `end_coords` represents the target position
-                double actual_end_coords[12] = {0};
                 actual_end_coords[axis_0] = A*sin(B*(1-C_x)) + D_x;
                 actual_end_coords[axis_1] = A*sin(B*(1-C_y)) + D_y;
                 for(int i = 0; i < RTMC_NUM_AXES; i++) {
-                    parsed_block->position_error[i] = actual_end_coords[i] - end_coords[i];
-                    end_coords[i] = actual_end_coords[i];
+                    parsed_block->position_error[i] = actual_end_coords[i] - parser->end_coords[i];
+                    parser->end_coords[i] = actual_end_coords[i];
                 }
             }
         }
     }
+
+    TRACE_END(TRACE_GENERATE_PATH);
 }
@@ -0,0 +1,237 @@
+/*
+    parser/lexer.c
+
+    Splits a g-code block into words using a table-driven FSM. Each input
+    char is classified with a 256-entry lookup table, and the next state is
+    looked up in a state-transition table, so there are no per-char calls to
+    `isalpha()`/`isdigit()` and no nested switches.
+
+    Runs of blanks and the search for line terminators are handled 16 bytes
+    at a time with SSE2 when it's available.
+*/
+
+#include <ctype.h>
+#include "parser.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// FSM states
+typedef enum {
+    IDLE_STATE,
+    KEY_STATE,
+    VALUE_STATE,
+    PARSE_STATE,
+    ERROR_STATE, // only catches grammar errors
+    NUM_STATES
+} state_t;
+
+/*
+    FSM input char types
+
+    invalid - anything else
+    E - 'e', 'E' (special since it can be either a letter or digit)
+    letter - a-z, A-Z (excluding 'e' and 'E')
+    digit - 0-9, '.', '+', '-'
+    empty - ' ', '\t', '\n', '\r', '\0'
+*/
+typedef enum {
+    INVALID_TYPE, // must be zero (see `char_types`)
+    E_TYPE,
+    LETTER_TYPE,
+    DIGIT_TYPE,
+    EMPTY_TYPE,
+    NUM_CHAR_TYPES
+} char_type_t;
+
+
+
+/*
+    Classify the FSM input chars. Only ASCII is listed; the remaining entries
+    (0x80-0xFF) are zero, which is INVALID_TYPE.
+*/
+#define X INVALID_TYPE
+#define E E_TYPE
+#define L LETTER_TYPE
+#define D DIGIT_TYPE
+#define W EMPTY_TYPE
+static const unsigned char char_types[256] = {
+    W, X, X, X, X, X, X, X, X, W, W, X, X, W, X, X, // 0x00
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, // 0x10
+    W, X, X, X, X, X, X, X, X, X, X, D, X, D, D, X, // 0x20
+    D, D, D, D, D, D, D, D, D, D, X, X, X, X, X, X, // 0x30
+    X, L, L, L, L, E, L, L, L, L, L, L, L, L, L, L, // 0x40
+    L, L, L, L, L, L, L, L, L, L, L, X, X, X, X, X, // 0x50
+    X, L, L, L, L, E, L, L, L, L, L, L, L, L, L, L, // 0x60
+    L, L, L, L, L, L, L, L, L, L, L, X, X, X, X, X, // 0x70
+};
+#undef X
+#undef E
+#undef L
+#undef D
+#undef W
+
+
+
+/*
+    The FSM's next state based on the current state (row) and input
+    character's type (column).
+*/
+static const unsigned char next_states[NUM_STATES][NUM_CHAR_TYPES] = {
+    //                invalid      E            letter       digit        empty
+    [IDLE_STATE]  = { ERROR_STATE, KEY_STATE,   KEY_STATE,   ERROR_STATE, IDLE_STATE  },
+    [KEY_STATE]   = { ERROR_STATE, ERROR_STATE, ERROR_STATE, VALUE_STATE, ERROR_STATE },
+    [VALUE_STATE] = { ERROR_STATE, VALUE_STATE, ERROR_STATE, VALUE_STATE, PARSE_STATE },
+    [PARSE_STATE] = { ERROR_STATE, KEY_STATE,   KEY_STATE,   ERROR_STATE, IDLE_STATE  },
+    [ERROR_STATE] = { ERROR_STATE, ERROR_STATE, ERROR_STATE, ERROR_STATE, ERROR_STATE },
+};
+
+
+
+// returns the number of leading ' ' and '\t' chars
+static inline size_t skip_blanks(const char* str, size_t length) {
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i spaces = _mm_set1_epi8(' ');
+    const __m128i tabs = _mm_set1_epi8('\t');
+    for(; i + 16 <= length; i += 16) {
+        __m128i chars = _mm_loadu_si128((const __m128i*)(str + i));
+        __m128i blanks = _mm_or_si128(
+            _mm_cmpeq_epi8(chars, spaces),
+            _mm_cmpeq_epi8(chars, tabs)
+        );
+
+        // each bit of `mask` is set for a char that isn't blank
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(blanks) & 0xFFFF;
+        if(mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    while(i < length && (str[i] == ' ' || str[i] == '\t')) {
+        i++;
+    }
+    return i;
+}
+
+
+
+size_t find_line_end(const char* str, size_t length) {
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i carriage_returns = _mm_set1_epi8('\r');
+    const __m128i newlines = _mm_set1_epi8('\n');
+    const __m128i nulls = _mm_setzero_si128();
+    for(; i + 16 <= length; i += 16) {
+        __m128i chars = _mm_loadu_si128((const __m128i*)(str + i));
+        __m128i terminators = _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(chars, carriage_returns),
+                _mm_cmpeq_epi8(chars, newlines)
+            ),
+            _mm_cmpeq_epi8(chars, nulls)
+        );
+
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(terminators);
+        if(mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    while(i < length && !is_terminator(str[i])) {
+        i++;
+    }
+    return i;
+}
+
+size_t find_string_end(const char* str) {
+    size_t i = 0;
+    while(!is_terminator(str[i])) {
+        i++;
+    }
+    return i;
+}
+
+
+
+lex_result_t lex_word(const char* block, size_t length, size_t* index, word_t* word) {
+    state_t state = IDLE_STATE;
+    size_t value_start = 0;
+
+    for(size_t i = *index; ; i++) {
+        // blanks between words don't change anything
+        if(state == IDLE_STATE && i < length) {
+            i += skip_blanks(block + i, length - i);
+        }
+
+        // isolate the current character (the end of the block acts like '\0')
+        char c = (i < length) ? block[i] : '\0';
+
+        state = next_states[state][char_types[(unsigned char)c]];
+
+        if(state == KEY_STATE) {
+            // store the char as a key (the value starts right after it)
+            word->key = toupper((unsigned char)c);
+            value_start = i + 1;
+        }
+        else if(state == PARSE_STATE) {
+            // the char that ended the value is read again by the next call
+            // (from IDLE_STATE, which handles it the same way PARSE_STATE
+            // would)
+            *index = i;
+
+            // convert the value in place
+            bool valid_value = parse_decimal(block + value_start, i - value_start, &word->value);
+            return valid_value ? LEX_WORD : LEX_VALUE_ERROR;
+        }
+        else if(state == ERROR_STATE) {
+            *index = i;
+            return LEX_GRAMMAR_ERROR;
+        }
+        else if(state == IDLE_STATE && is_terminator(c)) {
+            *index = i;
+            return LEX_END;
+        }
+        // note: KEY_STATE and VALUE_STATE just move on to the next char
+    }
+}
+
+
+
+void stream_lexer_init(stream_lexer_t* lexer) {
+    lexer->state = IDLE_STATE;
+}
+
+lex_result_t lex_char(stream_lexer_t* lexer, char c, word_t* word) {
+    state_t state = next_states[lexer->state][char_types[(unsigned char)c]];
+
+    if(state == KEY_STATE) {
+        // store the char as a key (the value starts right after it)
+        lexer->word.key = toupper((unsigned char)c);
+        decimal_init(&lexer->value);
+    }
+    else if(state == VALUE_STATE) {
+        decimal_push(&lexer->value, c);
+    }
+    else if(state == PARSE_STATE) {
+        // the char that ended the value is blank or a terminator, both of
+        // which IDLE_STATE would just pass over (see `lex_word()`)
+        lexer->state = IDLE_STATE;
+
+        *word = lexer->word;
+        bool valid_value = decimal_finish(&lexer->value, &word->value);
+        return valid_value ? LEX_WORD : LEX_VALUE_ERROR;
+    }
+    else if(state == ERROR_STATE) {
+        lexer->state = ERROR_STATE;
+        return LEX_GRAMMAR_ERROR;
+    }
+
+    lexer->state = state;
+    return (state == IDLE_STATE && is_terminator(c)) ? LEX_END : LEX_MORE;
+}
@@ -0,0 +1,69 @@
+/*
+    parser/parse_buffer.c
+*/
+
+#include "parser.h"
+#include "rtmc_parser.h"
+
+size_t record_error(rtmc_parse_error_t* errors, size_t max_errors, size_t num_errors, size_t line, char* error_msg) {
+    // only the first `max_errors` fit
+    if(num_errors < max_errors) {
+        errors[num_errors].line = line;
+        errors[num_errors].error_msg = error_msg;
+    }
+
+    return num_errors + 1;
+}
+
+size_t skip_terminator(const char* buffer, size_t length, size_t i) {
+    if(i < length) {
+        // "\r\n" is a single line break
+        if(buffer[i] == '\r' && i + 1 < length && buffer[i + 1] == '\n') {
+            i++;
+        }
+        i++;
+    }
+
+    return i;
+}
+
+size_t parse_lines(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue,
+    const char* buffer, size_t length, size_t offset, size_t* line,
+    rtmc_parse_error_t* errors, size_t max_errors, size_t num_errors
+) {
+    // reused for every block
+    rtmc_parsed_block_t parsed_block;
+
+    size_t i = 0;
+    while(i < length) {
+        // find the end of the line
+        size_t line_start = i;
+        i += find_line_end(buffer + i, length - i);
+
+        if(parser->checkpoints) {
+            record_checkpoint(parser, *line, offset + line_start);
+        }
+
+        parse_block(parser, queue, buffer + line_start, i - line_start, &parsed_block);
+        if(!parsed_block.is_valid) {
+            num_errors = record_error(errors, max_errors, num_errors, *line, parsed_block.error_msg);
+        }
+
+        i = skip_terminator(buffer, length, i);
+        (*line)++;
+    }
+
+    return num_errors;
+}
+
+
+
+size_t rtmc_parse_buffer(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue,
+    const char* buffer, size_t length,
+    rtmc_parse_error_t* errors, size_t max_errors
+) {
+    size_t line = 1;
+    return parse_lines(parser, queue, buffer, length, 0, &line, errors, max_errors, 0);
+}
@@ -0,0 +1,103 @@
+/*
+    parser/parse_file.c
+
+    On POSIX systems, the file is memory-mapped and parsed in place, so it's
+    never copied into a user-space buffer. The kernel is told the file will
+    be read sequentially, so it can read ahead aggressively and drop pages
+    that have already been parsed.
+
+    Elsewhere, the file is read into memory in one go and then parsed.
+*/
+
+#include <stdio.h>
+#include "../alloc.h"
+#include "parser.h"
+#include "rtmc_parser.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// records a file-level error (reported as line 0)
+static size_t file_error(rtmc_parse_error_t* errors, size_t max_errors) {
+    if(max_errors > 0) {
+        errors[0].line = 0;
+        errors[0].error_msg = "Unable to read file";
+    }
+
+    return 1;
+}
+
+
+
+size_t rtmc_parse_file(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue, const char* filename,
+    rtmc_parse_error_t* errors, size_t max_errors
+) {
+#ifdef USE_MMAP
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0) {
+        return file_error(errors, max_errors);
+    }
+
+    struct stat file_info;
+    if(fstat(fd, &file_info) != 0) {
+        close(fd);
+        return file_error(errors, max_errors);
+    }
+
+    // an empty file is an empty program (and can't be mapped)
+    size_t length = (size_t)file_info.st_size;
+    if(length == 0) {
+        close(fd);
+        return 0;
+    }
+
+    void* data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid after closing
+    if(data == MAP_FAILED) {
+        return file_error(errors, max_errors);
+    }
+    posix_madvise(data, length, POSIX_MADV_SEQUENTIAL);
+
+    size_t num_errors = rtmc_parse_buffer(
+        parser, queue, (const char*)data, length, errors, max_errors
+    );
+
+    munmap(data, length);
+    return num_errors;
+
+#else
+    FILE* file = fopen(filename, "rb");
+    if(file == NULL) {
+        return file_error(errors, max_errors);
+    }
+
+    // read the whole file
+    char* data = NULL;
+    long length = -1;
+    if(fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    if(length >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = (char*)rtmc_malloc(length > 0 ? (size_t)length : 1);
+    }
+    if(data == NULL || fread(data, 1, (size_t)length, file) != (size_t)length) {
+        rtmc_free(data);
+        fclose(file);
+        return file_error(errors, max_errors);
+    }
+    fclose(file);
+
+    size_t num_errors = rtmc_parse_buffer(
+        parser, queue, data, (size_t)length, errors, max_errors
+    );
+
+    rtmc_free(data);
+    return num_errors;
+#endif
+}
@@ -0,0 +1,413 @@
+/*
+    parser/parse_parallel.c
+
+    Lexing (splitting blocks into words and converting their values) doesn't
+    depend on modal state, so it can run on several threads at once. Only the
+    second pass, which applies the words in order, has to be sequential.
+
+    The buffer is split into chunks at line boundaries. Each chunk is lexed
+    into a list of words plus one record per line. The other chunks are
+    queued for the pool's threads while the calling thread lexes the first
+    one, then the calling thread applies every chunk's words in order. When
+    it gets to a chunk no thread has picked up yet (e.g., the pool is busy
+    with another parse), it lexes that chunk itself rather than waiting.
+*/
+
+#include <stdint.h>
+#include "../alloc.h"
+#include "parser.h"
+#include "rtmc_parser.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define USE_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// chunks smaller than this aren't worth a thread
+#define MIN_CHUNK_LENGTH 65536
+
+// initial capacity of the word and line lists (they grow as needed)
+#define INITIAL_CAPACITY 1024
+
+
+
+/*
+    Each line is recorded as a run of words in the chunk's word list. If the
+    lexer failed partway through the line, `result` holds the error (and
+    only the words before it are recorded). Otherwise, it's `LEX_END`.
+*/
+typedef struct {
+    size_t offset; // index of the line within the chunk
+    size_t first_word;
+    uint32_t num_words;
+    lex_result_t result;
+} lexed_line_t;
+
+typedef struct chunk {
+    const char* buffer;
+    size_t length;
+
+    word_t* words;
+    size_t num_words;
+    size_t words_capacity;
+
+    lexed_line_t* lines;
+    size_t num_lines;
+    size_t lines_capacity;
+
+    // if lexing ran out of memory, the chunk is parsed straight from text
+    bool out_of_memory;
+
+    enum {CHUNK_QUEUED, CHUNK_LEXING, CHUNK_LEXED} state;
+    struct chunk* next_job;
+} chunk_t;
+
+struct rtmc_parse_pool {
+    int num_threads; // counting the calling thread
+
+#ifdef USE_PTHREADS
+    pthread_mutex_t mutex;
+    pthread_cond_t has_work; // signaled when chunks are queued (or on stop)
+    pthread_cond_t chunk_lexed;
+
+    // chunks waiting for a thread (a FIFO)
+    chunk_t* first_job;
+    chunk_t* last_job;
+    bool is_stopping;
+
+    pthread_t* workers;
+    int num_workers;
+#endif
+};
+
+
+
+// doubles the capacity of a list (returns false if out of memory)
+static bool grow(void** list, size_t* capacity, size_t element_size) {
+    size_t new_capacity = (*capacity == 0) ? INITIAL_CAPACITY : *capacity * 2;
+    void* new_list = rtmc_realloc(*list, new_capacity * element_size);
+    if(!new_list) {
+        return false;
+    }
+
+    *list = new_list;
+    *capacity = new_capacity;
+    return true;
+}
+
+// phase 1: lex every line in the chunk (runs on any thread)
+static void lex_chunk(chunk_t* chunk) {
+    const char* buffer = chunk->buffer;
+    size_t length = chunk->length;
+
+    size_t i = 0;
+    while(i < length) {
+        // find the end of the line
+        size_t line_start = i;
+        i += find_line_end(buffer + i, length - i);
+
+        if(chunk->num_lines == chunk->lines_capacity
+            && !grow((void**)&chunk->lines, &chunk->lines_capacity, sizeof(lexed_line_t))) {
+            chunk->out_of_memory = true;
+            return;
+        }
+        lexed_line_t* line = &chunk->lines[chunk->num_lines++];
+        line->offset = line_start;
+        line->first_word = chunk->num_words;
+        line->num_words = 0;
+
+        // read the line word by word (stopping at the first error)
+        const char* block = buffer + line_start;
+        size_t block_length = i - line_start;
+        size_t index = 0;
+        while(true) {
+            if(chunk->num_words == chunk->words_capacity
+                && !grow((void**)&chunk->words, &chunk->words_capacity, sizeof(word_t))) {
+                chunk->out_of_memory = true;
+                return;
+            }
+
+            line->result = lex_word(block, block_length, &index, &chunk->words[chunk->num_words]);
+            if(line->result != LEX_WORD) {
+                break;
+            }
+            chunk->num_words++;
+            line->num_words++;
+        }
+
+        i = skip_terminator(buffer, length, i);
+    }
+}
+
+// phase 2: apply the chunk's words in order (runs on the calling thread)
+static size_t apply_chunk(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue, chunk_t* chunk, size_t offset, size_t* line,
+    rtmc_parse_error_t* errors, size_t max_errors, size_t num_errors
+) {
+    if(chunk->out_of_memory) {
+        return parse_lines(parser, queue, chunk->buffer, chunk->length, offset, line, errors, max_errors, num_errors);
+    }
+
+    // reused for every block
+    rtmc_parsed_block_t parsed_block;
+
+    for(size_t i = 0; i < chunk->num_lines; i++) {
+        lexed_line_t* lexed_line = &chunk->lines[i];
+        word_t* words = chunk->words + lexed_line->first_word;
+
+        if(parser->checkpoints) {
+            record_checkpoint(parser, *line, offset + lexed_line->offset);
+        }
+
+        begin_block(parser, &parsed_block);
+
+        bool is_valid = true;
+        for(uint32_t j = 0; j < lexed_line->num_words && is_valid; j++) {
+            is_valid = apply_word(parser, LEX_WORD, &words[j], &parsed_block);
+        }
+        if(is_valid && lexed_line->result != LEX_END) {
+            apply_word(parser, lexed_line->result, NULL, &parsed_block);
+        }
+
+        finish_block(parser, queue, &parsed_block);
+        if(!parsed_block.is_valid) {
+            num_errors = record_error(errors, max_errors, num_errors, *line, parsed_block.error_msg);
+        }
+
+        (*line)++;
+    }
+
+    return num_errors;
+}
+
+// returns the start of the line after the one containing `i`
+static size_t next_line_start(const char* buffer, size_t length, size_t i) {
+    i += find_line_end(buffer + i, length - i);
+    return skip_terminator(buffer, length, i);
+}
+
+
+
+/*
+    The pool
+*/
+#ifdef USE_PTHREADS
+// removes a chunk from the job queue (the mutex must be held)
+static void remove_job(rtmc_parse_pool_t* pool, chunk_t* chunk) {
+    chunk_t** link = &pool->first_job;
+    chunk_t* previous = NULL;
+    while(*link != chunk) {
+        previous = *link;
+        link = &(*link)->next_job;
+    }
+
+    *link = chunk->next_job;
+    if(pool->last_job == chunk) {
+        pool->last_job = previous;
+    }
+}
+
+static void* run_worker(void* arg) {
+    rtmc_parse_pool_t* pool = (rtmc_parse_pool_t*)arg;
+
+    pthread_mutex_lock(&pool->mutex);
+    while(true) {
+        while(!pool->first_job && !pool->is_stopping) {
+            pthread_cond_wait(&pool->has_work, &pool->mutex);
+        }
+        if(pool->is_stopping) {
+            break;
+        }
+
+        chunk_t* chunk = pool->first_job;
+        remove_job(pool, chunk);
+        chunk->state = CHUNK_LEXING;
+
+        pthread_mutex_unlock(&pool->mutex);
+        lex_chunk(chunk);
+        pthread_mutex_lock(&pool->mutex);
+
+        chunk->state = CHUNK_LEXED;
+        pthread_cond_broadcast(&pool->chunk_lexed);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+#endif
+
+rtmc_parse_pool_t* rtmc_create_parse_pool(int num_threads) {
+#ifdef USE_PTHREADS
+    if(num_threads <= 0) {
+        long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (num_cpus > 0) ? (int)num_cpus : 1;
+    }
+#else
+    num_threads = 1;
+#endif
+
+    rtmc_parse_pool_t* pool = (rtmc_parse_pool_t*)rtmc_calloc(1, sizeof(rtmc_parse_pool_t));
+    if(!pool) {
+        return NULL;
+    }
+    pool->num_threads = num_threads;
+
+#ifdef USE_PTHREADS
+    if(num_threads > 1) {
+        pool->workers = (pthread_t*)rtmc_calloc((size_t)num_threads - 1, sizeof(pthread_t));
+        if(!pool->workers) {
+            rtmc_free(pool);
+            return NULL;
+        }
+    }
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->has_work, NULL);
+    pthread_cond_init(&pool->chunk_lexed, NULL);
+
+    // if a thread can't be started, the calling thread lexes its share
+    for(int i = 0; i < num_threads - 1; i++) {
+        if(pthread_create(&pool->workers[pool->num_workers], NULL, run_worker, pool) != 0) {
+            break;
+        }
+        pool->num_workers++;
+    }
+#endif
+
+    return pool;
+}
+
+void rtmc_destroy_parse_pool(rtmc_parse_pool_t* pool) {
+    if(!pool) {
+        return;
+    }
+
+#ifdef USE_PTHREADS
+    pthread_mutex_lock(&pool->mutex);
+    pool->is_stopping = true;
+    pthread_cond_broadcast(&pool->has_work);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for(int i = 0; i < pool->num_workers; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->chunk_lexed);
+    pthread_cond_destroy(&pool->has_work);
+    pthread_mutex_destroy(&pool->mutex);
+    rtmc_free(pool->workers);
+#endif
+
+    rtmc_free(pool);
+}
+
+// queues chunks for the pool's threads
+static void queue_chunks(rtmc_parse_pool_t* pool, chunk_t* chunks, size_t num_chunks) {
+#ifdef USE_PTHREADS
+    pthread_mutex_lock(&pool->mutex);
+    for(size_t i = 0; i < num_chunks; i++) {
+        chunks[i].state = CHUNK_QUEUED;
+        chunks[i].next_job = NULL;
+        if(pool->last_job) {
+            pool->last_job->next_job = &chunks[i];
+        }
+        else {
+            pool->first_job = &chunks[i];
+        }
+        pool->last_job = &chunks[i];
+    }
+    pthread_cond_broadcast(&pool->has_work);
+    pthread_mutex_unlock(&pool->mutex);
+#else
+    (void)pool;
+    for(size_t i = 0; i < num_chunks; i++) {
+        chunks[i].state = CHUNK_QUEUED;
+    }
+#endif
+}
+
+// waits for a chunk to be lexed (lexing it here if no thread has started)
+static void finish_lexing(rtmc_parse_pool_t* pool, chunk_t* chunk) {
+#ifdef USE_PTHREADS
+    pthread_mutex_lock(&pool->mutex);
+    if(chunk->state == CHUNK_QUEUED) {
+        remove_job(pool, chunk);
+        chunk->state = CHUNK_LEXING;
+        pthread_mutex_unlock(&pool->mutex);
+        lex_chunk(chunk);
+        return;
+    }
+
+    while(chunk->state != CHUNK_LEXED) {
+        pthread_cond_wait(&pool->chunk_lexed, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+#else
+    (void)pool;
+    if(chunk->state == CHUNK_QUEUED) {
+        lex_chunk(chunk);
+    }
+#endif
+}
+
+
+
+size_t rtmc_parse_buffer_parallel(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue,
+    const char* buffer, size_t length,
+    rtmc_parse_error_t* errors, size_t max_errors, rtmc_parse_pool_t* pool
+) {
+    // small programs don't need every thread
+    size_t num_chunks = length / MIN_CHUNK_LENGTH;
+    if(!pool) {
+        num_chunks = 1;
+    }
+    else if(num_chunks > (size_t)pool->num_threads) {
+        num_chunks = (size_t)pool->num_threads;
+    }
+    if(num_chunks <= 1) {
+        return rtmc_parse_buffer(parser, queue, buffer, length, errors, max_errors);
+    }
+
+    chunk_t* chunks = (chunk_t*)rtmc_calloc(num_chunks, sizeof(chunk_t));
+    if(!chunks) {
+        return rtmc_parse_buffer(parser, queue, buffer, length, errors, max_errors);
+    }
+
+    // split at line boundaries (so "\r\n" is never split either)
+    size_t chunk_start = 0;
+    for(size_t i = 0; i < num_chunks; i++) {
+        size_t chunk_end = length;
+        if(i + 1 < num_chunks) {
+            size_t target = length / num_chunks * (i + 1);
+            chunk_end = next_line_start(buffer, length, (target > chunk_start) ? target : chunk_start);
+        }
+
+        chunks[i].buffer = buffer + chunk_start;
+        chunks[i].length = chunk_end - chunk_start;
+        chunk_start = chunk_end;
+    }
+
+    // phase 1: lex every chunk except the first in the background
+    queue_chunks(pool, &chunks[1], num_chunks - 1);
+    lex_chunk(&chunks[0]);
+
+    // phase 2: apply each chunk in order, as soon as it's lexed
+    size_t line = 1;
+    size_t num_errors = 0;
+    for(size_t i = 0; i < num_chunks; i++) {
+        if(i > 0) {
+            finish_lexing(pool, &chunks[i]);
+        }
+
+        size_t offset = (size_t)(chunks[i].buffer - buffer);
+        num_errors = apply_chunk(parser, queue, &chunks[i], offset, &line, errors, max_errors, num_errors);
+
+        rtmc_free(chunks[i].words);
+        rtmc_free(chunks[i].lines);
+    }
+
+    rtmc_free(chunks);
+    return num_errors;
+}
@@ -0,0 +1,120 @@
+/*
+    parser/parse_stream.c
+
+    Parses g-code that arrives in arbitrary chunks (e.g., from a serial
+    link), where a block can be split anywhere, even in the middle of a
+    number. Blocks that fit entirely within a chunk are parsed in place, just
+    like `rtmc_parse_buffer()`. Only a block that straddles chunks is fed to
+    the lexer one char at a time, and its state is kept in the parser context
+    until the rest arrives. Nothing is copied into a line buffer.
+*/
+
+#include "parser.h"
+#include "rtmc_parser.h"
+
+// starts a block that continues into the next chunk
+static void begin_stream_block(rtmc_parser_t* parser) {
+    stream_data_t* stream_data = &parser->stream_data;
+
+    begin_block(parser, &stream_data->parsed_block);
+    stream_lexer_init(&stream_data->lexer);
+    stream_data->is_in_block = true;
+}
+
+// ends the block (with `terminator`) and returns the new number of errors
+static size_t end_stream_block(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue, char terminator,
+    rtmc_parse_error_t* errors, size_t max_errors, size_t num_errors
+) {
+    stream_data_t* stream_data = &parser->stream_data;
+
+    if(stream_data->is_in_block) {
+        finish_block(parser, queue, &stream_data->parsed_block);
+    }
+    if(!stream_data->parsed_block.is_valid) {
+        num_errors = record_error(errors, max_errors, num_errors, stream_data->line, stream_data->parsed_block.error_msg);
+    }
+
+    stream_data->line++;
+    stream_data->is_in_block = false;
+    stream_data->after_carriage_return = (terminator == '\r');
+    return num_errors;
+}
+
+// feeds one char of a block that straddles chunks
+static void push_stream_char(rtmc_parser_t* parser, char c) {
+    stream_data_t* stream_data = &parser->stream_data;
+
+    // the rest of the block is ignored after the first error
+    if(!stream_data->parsed_block.is_valid) {
+        return;
+    }
+
+    word_t word;
+    lex_result_t result = lex_char(&stream_data->lexer, c, &word);
+    if(result != LEX_MORE && result != LEX_END) {
+        apply_word(parser, result, &word, &stream_data->parsed_block);
+    }
+}
+
+
+
+size_t rtmc_parse_stream(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue,
+    const char* chunk, size_t length,
+    rtmc_parse_error_t* errors, size_t max_errors
+) {
+    stream_data_t* stream_data = &parser->stream_data;
+    size_t num_errors = 0;
+
+    size_t i = 0;
+    while(i < length) {
+        // "\r\n" is a single line break, even if it's split between chunks
+        if(stream_data->after_carriage_return) {
+            stream_data->after_carriage_return = false;
+            if(chunk[i] == '\n') {
+                i++;
+                continue;
+            }
+        }
+
+        size_t line_end = i + find_line_end(chunk + i, length - i);
+
+        if(!stream_data->is_in_block && line_end < length) {
+            // the whole block is in this chunk
+            parse_block(parser, queue, chunk + i, line_end - i, &stream_data->parsed_block);
+        }
+        else {
+            // the block started in an earlier chunk or ends in a later one
+            if(!stream_data->is_in_block) {
+                begin_stream_block(parser);
+            }
+            for(; i < line_end; i++) {
+                push_stream_char(parser, chunk[i]);
+            }
+
+            // wait for the rest of the block
+            if(line_end == length) {
+                break;
+            }
+            push_stream_char(parser, chunk[line_end]);
+        }
+
+        num_errors = end_stream_block(parser, queue, chunk[line_end], errors, max_errors, num_errors);
+        i = line_end + 1;
+    }
+
+    return num_errors;
+}
+
+size_t rtmc_end_stream(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue,
+    rtmc_parse_error_t* errors, size_t max_errors
+) {
+    // an unterminated block ends with the stream
+    if(parser->stream_data.is_in_block) {
+        return rtmc_parse_stream(parser, queue, "\n", 1, errors, max_errors);
+    }
+
+    return 0;
+}
@@ -1,110 +1,164 @@
 /*
     parser/parse_word.c
+
+    Words are dispatched through two lookup tables instead of if/else chains:
+     * `word_handlers` is indexed by the key ('A' to 'Z')
+     * `g_code_handlers` is indexed by the G-code as a fixed-point integer
+       with one decimal place (G1 -> 10, G17 -> 170, G38.2 -> 382)
+
+    Adding a new key or G-code only adds a table entry, so it doesn't make
+    any other word slower to parse.
 */
 
+#include <math.h>
 #include "parser.h"
 #include "rtmc_math.h"
 #include "rtmc_parser.h"
 
+// covers G0 to G99.9
+#define NUM_G_CODES 1000
+
+typedef bool (*word_handler_t)(rtmc_parser_t* parser, const word_t* word);
+typedef void (*g_code_handler_t)(rtmc_parser_t* parser);
+
+
+
+/*
+    G-words
+*/
+static void set_g00(rtmc_parser_t* parser) { parser->modal_data.motion_mode = G00; }
+static void set_g01(rtmc_parser_t* parser) { parser->modal_data.motion_mode = G01; }
+static void set_g02(rtmc_parser_t* parser) { parser->modal_data.motion_mode = G02; }
+static void set_g03(rtmc_parser_t* parser) { parser->modal_data.motion_mode = G03; }
+static void set_g17(rtmc_parser_t* parser) { parser->modal_data.plane_mode = G17; }
+static void set_g18(rtmc_parser_t* parser) { parser->modal_data.plane_mode = G18; }
+static void set_g19(rtmc_parser_t* parser) { parser->modal_data.plane_mode = G19; }
+static void set_g90(rtmc_parser_t* parser) { parser->modal_data.distance_mode = G90; }
+static void set_g91(rtmc_parser_t* parser) { parser->modal_data.distance_mode = G91; }
+
+// indexed by 10 * G-code (unlisted codes are NULL, meaning unrecognized)
+static const g_code_handler_t g_code_handlers[NUM_G_CODES] = {
+    [0] = set_g00,
+    [10] = set_g01,
+    [20] = set_g02,
+    [30] = set_g03,
+    [170] = set_g17,
+    [180] = set_g18,
+    [190] = set_g19,
+    [900] = set_g90,
+    [910] = set_g91
+};
+
+// converts a G/M value to a fixed-point integer (returns -1 if it isn't
+// a valid code, i.e., negative or with more than one decimal place)
+static int decode_code(double value) {
+    double scaled_value = value * 10;
+
+    // anything equal to zero (even slightly negative) is G00, as it always was
+    if(rtmc_is_equal(scaled_value, 0)) {
+        return 0;
+    }
+
+    if(!(scaled_value >= 0 && scaled_value < NUM_G_CODES)) {
+        return -1;
+    }
+
+    double code = round(scaled_value);
+    return rtmc_is_equal(scaled_value, code) ? (int)code : -1;
+}
+
+static bool parse_g_word(rtmc_parser_t* parser, const word_t* word) {
+    int code = decode_code(word->value);
+    if(code < 0 || g_code_handlers[code] == NULL) { // unrecognized value
+        return false;
+    }
+
+    g_code_handlers[code](parser);
+    return true;
+}
+
+
+
+/*
+    Other words
+*/
+// axis that each key moves (indexed by key - 'A')
+static const int key_axes[26] = {
+    ['A' - 'A'] = RTMC_A_AXIS,
+    ['B' - 'A'] = RTMC_B_AXIS,
+    ['C' - 'A'] = RTMC_C_AXIS,
+    ['P' - 'A'] = RTMC_P_AXIS,
+    ['Q' - 'A'] = RTMC_Q_AXIS,
+    ['R' - 'A'] = RTMC_R_AXIS,
+    ['U' - 'A'] = RTMC_U_AXIS,
+    ['V' - 'A'] = RTMC_V_AXIS,
+    ['W' - 'A'] = RTMC_W_AXIS,
+    ['X' - 'A'] = RTMC_X_AXIS,
+    ['Y' - 'A'] = RTMC_Y_AXIS,
+    ['Z' - 'A'] = RTMC_Z_AXIS
+};
+
+// A, B, C, P, Q, R, U, V, W, X, Y, and Z words
+// TODO: P, Q, and R can also be parameters
+// use if(modal_data.motion_mode == SOMETHING) to determine behavior
+static bool parse_axis_word(rtmc_parser_t* parser, const word_t* word) {
+    parser->end_coords[key_axes[word->key - 'A']] = word->value;
+    return true;
+}
+
+static bool parse_f_word(rtmc_parser_t* parser, const word_t* word) {
+    parser->feed_rate = word->value;
+    return true;
+}
+
+// I, J, and K words
+static bool parse_offset_word(rtmc_parser_t* parser, const word_t* word) {
+    parser->non_modal_data.relative_offset[word->key - 'I'] = word->value;
+    return true;
+}
+
+// indexed by key - 'A' (unlisted keys are NULL, meaning unrecognized)
+static const word_handler_t word_handlers[26] = {
+    ['A' - 'A'] = parse_axis_word,
+    ['B' - 'A'] = parse_axis_word,
+    ['C' - 'A'] = parse_axis_word,
+    ['F' - 'A'] = parse_f_word,
+    ['G' - 'A'] = parse_g_word,
+    ['I' - 'A'] = parse_offset_word,
+    ['J' - 'A'] = parse_offset_word,
+    ['K' - 'A'] = parse_offset_word,
+    ['P' - 'A'] = parse_axis_word,
+    ['Q' - 'A'] = parse_axis_word,
+    ['R' - 'A'] = parse_axis_word,
+    ['U' - 'A'] = parse_axis_word,
+    ['V' - 'A'] = parse_axis_word,
+    ['W' - 'A'] = parse_axis_word,
+    ['X' - 'A'] = parse_axis_word,
+    ['Y' - 'A'] = parse_axis_word,
+    ['Z' - 'A'] = parse_axis_word
+};
+
+
+
 /*
     Parse the key/value pairs (a.k.a., words) and update the modal data
 
     Note: some keys have multiple meanings based on context. For example,
     'P' is typically an axis, but can be the dwell time if G04 is active.
 
-    Returns `true` for valid words and `false` for invalid words. 
-    `modal_data`, `feed_rate`, and `end_coords` are all passed by reference
-    and can be modified by this function.
+    Returns `true` for valid words and `false` for invalid words. The
+    parser's `modal_data`, `feed_rate`, and `end_coords` can be modified by
+    this function.
 */
-bool parse_word(word_t* word) {
-
-    if(word->key == 'A') // A-words
-        end_coords[RTMC_A_AXIS] = word->value;
-    
-    else if(word->key == 'B') // B-words
-        end_coords[RTMC_B_AXIS] = word->value;
-    
-    else if(word->key == 'C') // C-words
-        end_coords[RTMC_C_AXIS] = word->value;
-    
-    else if(word->key == 'F') // F-words
-        feed_rate = word->value;
-    
-    else if(word->key == 'G') { // G-words
-        if(rtmc_is_equal(word->value, 0)) // G00 word
-            modal_data.motion_mode = G00;
-        
-        else if(rtmc_is_equal(word->value, 1)) // G01 word
-            modal_data.motion_mode = G01;
-        
-        else if(rtmc_is_equal(word->value, 2)) // G02 word
-            modal_data.motion_mode = G02;
-        
-        else if(rtmc_is_equal(word->value, 3)) // G03 word
-            modal_data.motion_mode = G03;
-        
-        else if(rtmc_is_equal(word->value, 17)) // G17 word
-            modal_data.plane_mode = G17;
-        
-        else if(rtmc_is_equal(word->value, 18)) // G18 word
-            modal_data.plane_mode = G18;
-        
-        else if(rtmc_is_equal(word->value, 19)) // G19 word
-            modal_data.plane_mode = G19;
-        
-        else if(rtmc_is_equal(word->value, 90)) // G90 word
-            modal_data.distance_mode = G90;
-        
-        else if(rtmc_is_equal(word->value, 91)) // G91 word
-            modal_data.distance_mode = G91;
-        
-        else // unrecognized value
-            return false;
-    }
-    else if(word->key == 'I')
-        non_modal_data.relative_offset[RTMC_X_AXIS] = word->value;
-    
-    else if(word->key == 'J')
-        non_modal_data.relative_offset[RTMC_Y_AXIS] = word->value;
-
-    else if(word->key == 'K')
-        non_modal_data.relative_offset[RTMC_Z_AXIS] = word->value;
-        
-    else if(word->key == 'P') { // P-words
-        // TODO: can also be a parameter
-        // use if(modal_data.motion_mode == SOMETHING) to determine behavior
-        end_coords[RTMC_P_AXIS] = word->value;
-    }
-    else if(word->key == 'Q') { // Q-words
-        // TODO: can also be a parameter
-        end_coords[RTMC_Q_AXIS] = word->value;
-    }
-    else if(word->key == 'R') { // R-words
-        // TODO: can also be a parameter
-        end_coords[RTMC_R_AXIS] = word->value;
+bool parse_word(rtmc_parser_t* parser, word_t* word) {
+    if(word->key < 'A' || word->key > 'Z') { // not a letter
+        return false;
     }
 
-    else if(word->key == 'U') // U-words
-        end_coords[RTMC_U_AXIS] = word->value;
-    
-    else if(word->key == 'V') // V-words
-        end_coords[RTMC_V_AXIS] = word->value;
-    
-    else if(word->key == 'W') // W-words
-        end_coords[RTMC_W_AXIS] = word->value;
-    
-    else if(word->key == 'X') // X-words
-        end_coords[RTMC_X_AXIS] = word->value;
-    
-    else if(word->key == 'Y') // Y-words
-        end_coords[RTMC_Y_AXIS] = word->value;
-    
-    else if(word->key == 'Z') // Z-words
-        end_coords[RTMC_Z_AXIS] = word->value;
-    
-    else // unrecognized key
+    word_handler_t handler = word_handlers[word->key - 'A'];
+    if(handler == NULL) { // unrecognized key
         return false;
+    }
 
-    // no errors found
-    return true;
+    return handler(parser, word);
 }
@@ -2,247 +2,166 @@
     parser/parser.c
 */
 
-#include <ctype.h>
-#include <stdlib.h>
+#include "../alloc.h"
+#include "../trace.h"
 #include "parser.h"
 #include "rtmc_parser.h"
 
-// global variables (modal data)
-modal_data_t modal_data;
-non_modal_data_t non_modal_data;
-double feed_rate = 0;
-double start_coords[RTMC_NUM_AXES] = {0};
-double end_coords[RTMC_NUM_AXES] = {0};
+// context used by `rtmc_parse()` and `rtmc_flush_parser_data()`
+static rtmc_parser_t default_parser;
 
 
 
-// FSM states
-typedef enum {
-    IDLE_STATE,
-    KEY_STATE,
-    VALUE_STATE,
-    PARSE_STATE,
-    ERROR_STATE // only catches grammar errors
-} state_t;
-
 /*
-    FSM input char types
-
-    E - 'e', 'E' (special since it can be either a letter or digit)
-    letter - a-z, A-Z (excluding 'e' and 'E')
-    digit - 0-9, '.', '+', '-'
-    empty - ' ', '\t', '\n', '\r', '\0'
-    invalid - anything else
+    Create and destroy parser contexts
 */
-typedef enum {
-    E_TYPE,
-    LETTER_TYPE,
-    DIGIT_TYPE,
-    EMPTY_TYPE,
-    INVALID_TYPE
-} char_type_t;
+rtmc_parser_t* rtmc_create_parser() {
+    rtmc_parser_t* parser = (rtmc_parser_t*)rtmc_malloc(sizeof(rtmc_parser_t));
+    if(parser) {
+        rtmc_flush_parser_data_ctx(parser);
+        parser->checkpoints = NULL;
+    }
+
+    return parser;
+}
+
+void rtmc_destroy_parser(rtmc_parser_t* parser) {
+    rtmc_free(parser);
+}
 
 
 
 /*
-    Classify the FSM input chars
+    Steps shared by every way of parsing a block
 */
-char_type_t get_char_type(char c) {
+// resets per-block data before any words are read
+void begin_block(rtmc_parser_t* parser, rtmc_parsed_block_t* parsed_block) {
+    // make path valid by default
+    parsed_block->is_valid = true;
+    parsed_block->type = RTMC_BLOCK_TYPE_MODAL;
+    for(int i = 0; i < RTMC_NUM_AXES; i++)
+        parsed_block->position_error[i] = 0;
 
-    if(c == 'e' || c == 'E')
-        return E_TYPE;
+    // reset non-modal data
+    parser->non_modal_data.mode = UNDEFINED_NON_MODAL_MODE;
+    for(int i = 0; i < NUM_RELATIVE_OFFSETS; i++)
+        parser->non_modal_data.relative_offset[i] = 0;
 
-    else if(isalpha(c))
-        return LETTER_TYPE;
+    // initialize start coordinates (to previous end coordinates)
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        parser->start_coords[i] = parser->end_coords[i];
+    }
+}
 
-    else if(isdigit(c) || c == '.' || c == '+' || c == '-') 
-        return DIGIT_TYPE;
+// applies one lexed word (returns false and flags an error if invalid)
+bool apply_word(rtmc_parser_t* parser, lex_result_t result, word_t* word, rtmc_parsed_block_t* parsed_block) {
+    if(result == LEX_GRAMMAR_ERROR) {
+        parsed_block->is_valid = false;
+        parsed_block->error_msg = "Grammar error in G-code block";
+        return false;
+    }
+    else if(result == LEX_VALUE_ERROR) {
+        parsed_block->is_valid = false;
+        parsed_block->error_msg = "Invalid decimal value";
+        return false;
+    }
 
-    else if(c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\0')
-        return EMPTY_TYPE;
+    // update modal data based on new g-code word (key/value pair)
+    if(!parse_word(parser, word)) {
+        parsed_block->is_valid = false;
+        parsed_block->error_msg = "Invalid G-code word";
+        return false;
+    }
 
-    else
-        return INVALID_TYPE;
+    return true;
 }
 
+// generates the path and adds it to the queue (if the block has one)
+void finish_block(rtmc_parser_t* parser, rtmc_path_queue_t* queue, rtmc_parsed_block_t* parsed_block) {
+    // the path is written straight into the queue's next slot
+    rtmc_path_t* path = rtmc_path_queue_reserve(queue);
 
+    // if parsing was successful, generate the path
+    if(parsed_block->is_valid) {
+        generate_path(parser, path, parsed_block);
+    }
 
-/*
-    Return the FSM's next state based on the current state and
-    input character's type.
-*/
-state_t get_next_state(state_t current_state, char c) {
-    char_type_t char_type = get_char_type(c);
-
-    switch(current_state) {
-        case IDLE_STATE:
-            switch(char_type) {
-                case E_TYPE: return KEY_STATE;
-                case LETTER_TYPE: return KEY_STATE;
-                case DIGIT_TYPE: return ERROR_STATE;
-                case EMPTY_TYPE: return IDLE_STATE;
-                case INVALID_TYPE: return ERROR_STATE;
-            }
-
-        case KEY_STATE:
-            switch(char_type) {
-                case E_TYPE: return ERROR_STATE;
-                case LETTER_TYPE: return ERROR_STATE;
-                case DIGIT_TYPE: return VALUE_STATE;
-                case EMPTY_TYPE: return ERROR_STATE;
-                case INVALID_TYPE: return ERROR_STATE;
-            }
-
-        case VALUE_STATE:
-            switch(char_type) {
-                case E_TYPE: return VALUE_STATE;
-                case LETTER_TYPE: return ERROR_STATE;
-                case DIGIT_TYPE: return VALUE_STATE;
-                case EMPTY_TYPE: return PARSE_STATE;
-                case INVALID_TYPE: return ERROR_STATE;
-            }
-
-        case PARSE_STATE:
-            switch(char_type) {
-                case E_TYPE: return KEY_STATE;
-                case LETTER_TYPE: return KEY_STATE;
-                case DIGIT_TYPE: return ERROR_STATE;
-                case EMPTY_TYPE: return IDLE_STATE;
-                case INVALID_TYPE: return ERROR_STATE;
-            }
-
-        case ERROR_STATE:
-            return ERROR_STATE;
+    // if the block is a path, enqueue it
+    if(parsed_block->is_valid && parsed_block->type == RTMC_BLOCK_TYPE_PATH) {
+        rtmc_path_queue_commit(queue);
     }
 }
 
 
 
 /*
-    Parse a g-code string (called a block) and directly modify the
-    `parsed_block` argument. Strings must be properly terminated with the
-    null character ('\0').
+    Parse a g-code block into `parsed_block`. The block ends at the first
+    '\r', '\n', or '\0', or after `length` chars (whichever comes first).
+    The lexer never reads past `length`.
 */
-rtmc_parsed_block_t rtmc_parse(rtmc_path_queue_t* queue, const char* block) {
-    // object to be returned
-    rtmc_parsed_block_t parsed_block;
+void parse_block(rtmc_parser_t* parser, rtmc_path_queue_t* queue, const char* block, size_t length, rtmc_parsed_block_t* parsed_block) {
+    TRACE_BEGIN();
+    begin_block(parser, parsed_block);
 
-    // object to enqueue
-    rtmc_path_t path;
-
-    // g-code word (key/value pair)
+    // read the block word by word (stopping at the first error)
     word_t word;
-
-    // initialize FSM state
-    state_t state = IDLE_STATE;
-
-    // used to parse decimal values (later converted to doubles)
-    char value_str[RTMC_MAX_DECIMAL_LENGTH + 1]; 
-    int value_str_index = 0;
-
-    // make path valid by default
-    parsed_block.is_valid = true;
-
-    // reset non-modal data
-    non_modal_data.mode = UNDEFINED_NON_MODAL_MODE;
-    for(int i = 0; i < NUM_RELATIVE_OFFSETS; i++)
-        non_modal_data.relative_offset[i] = 0;
-
-    // initialize start coordinates (to previous end coordinates)
-    for(int i = 0; i < RTMC_NUM_AXES; i++) {
-        start_coords[i] = end_coords[i];
-    }
-
-    // loop until the end of the line, counting number of iterations
-    bool end_of_line = false;
-    for(int i = 0; !end_of_line; i++) {
-
-        // isolate the current character
-        char c = block[i];
-
-        // setting `end_of_line` after checking the loop's exit condition
-        // ensures there is an iteration that processes the terminating char
-        end_of_line = (c == '\r' || c == '\n' || c == '\0');
-
-        // update state (this is safe on the first iteration because 
-        // IDLE_STATE doesn't do anything)
-        state = get_next_state(state, c);
-
-        if(state == KEY_STATE) {
-            // store the char as a key
-            word.key = toupper(c);
-        }
-        else if(state == VALUE_STATE) {
-            // build `value_str` until max length is reached
-            if(value_str_index < RTMC_MAX_DECIMAL_LENGTH) {
-                value_str[value_str_index++] = c;
-            }
-            else {
-                // max value length has been exceeded
-                // might truncate an exponent, so throw an error
-                parsed_block.is_valid = false;
-                parsed_block.error_msg = "Decimal value exceeded max length";
-            }
-        }
-        else if(state == PARSE_STATE) {
-            // reset value_str null characters after index
-            for(int i = value_str_index; i < RTMC_MAX_DECIMAL_LENGTH; i++) {
-                value_str[i] = '\0';
-            }
-
-            // reset value_str_index
-            value_str_index = 0;
-
-            // convert value_str to double
-            word.value = strtod(value_str, NULL); // TODO: strtod() could use error handling
-
-            // update modal data based on new g-code word (key/value pair)
-            bool valid_word = parse_word(&word);
-            if(!valid_word) {
-                // flag error and stop parsing
-                parsed_block.is_valid = false;
-                parsed_block.error_msg = "Invalid G-code word";
-                break;
-            }
-        }
-        else if(state == ERROR_STATE) {
-            // flag error and stop parsing
-            parsed_block.is_valid = false;
-            parsed_block.error_msg = "Grammar error in G-code block";
+    size_t index = 0;
+    lex_result_t result;
+    while((result = lex_word(block, length, &index, &word)) != LEX_END) {
+        if(!apply_word(parser, result, &word, parsed_block)) {
             break;
         }
-        // note: there is no `else if(state == IDLE_STATE)` because
-        // IDLE_STATE doesn't do anything
     }
 
-    // if parsing was successful, generate the path
-    if(parsed_block.is_valid) {
-        generate_path(&path, &parsed_block);
-    }
+    finish_block(parser, queue, parsed_block);
+    TRACE_END(TRACE_PARSE);
+}
+
 
-    // if the block is a path, enqueue it
-    if(parsed_block.type == RTMC_BLOCK_TYPE_PATH) {
-        rtmc_path_enqueue(queue, path);
-    }
 
+/*
+    Parse a g-code string (called a block) using the given parser context.
+    Blocks must be terminated with '\r', '\n', or '\0'.
+*/
+rtmc_parsed_block_t rtmc_parse_ctx(rtmc_parser_t* parser, rtmc_path_queue_t* queue, const char* block) {
+    rtmc_parsed_block_t parsed_block;
+    parse_block(parser, queue, block, find_string_end(block), &parsed_block);
     return parsed_block;
 }
 
+rtmc_parsed_block_t rtmc_parse(rtmc_path_queue_t* queue, const char* block) {
+    return rtmc_parse_ctx(&default_parser, queue, block);
+}
+
 
 
 /*
     A g-code block's meaning depends on previous g-code  blocks.
     This function clears that data.
 */
-void rtmc_flush_parser_data() {
-    feed_rate = 0;
+void rtmc_flush_parser_data_ctx(rtmc_parser_t* parser) {
+    parser->feed_rate = 0;
+
+    parser->modal_data.motion_mode = UNDEFINED_MOTION_MODE;
+    parser->modal_data.plane_mode = UNDEFINED_PLANE_MODE;
+    parser->modal_data.distance_mode = UNDEFINED_DISTANCE_MODE;
+
+    parser->non_modal_data.mode = UNDEFINED_NON_MODAL_MODE;
+    for(int i = 0; i < NUM_RELATIVE_OFFSETS; i++) {
+        parser->non_modal_data.relative_offset[i] = 0;
+    }
 
-    modal_data.motion_mode = UNDEFINED_MOTION_MODE;
-    modal_data.plane_mode = UNDEFINED_PLANE_MODE;
-    modal_data.distance_mode = UNDEFINED_DISTANCE_MODE;
-    
     for(int i = 0; i < RTMC_NUM_AXES; i++) {
-        start_coords[i] = 0;
-        end_coords[i] = 0;
+        parser->start_coords[i] = 0;
+        parser->end_coords[i] = 0;
     }
+
+    // forget any partially streamed block
+    parser->stream_data.line = 1;
+    parser->stream_data.is_in_block = false;
+    parser->stream_data.after_carriage_return = false;
+}
+
+void rtmc_flush_parser_data() {
+    rtmc_flush_parser_data_ctx(&default_parser);
 }
@@ -6,7 +6,15 @@
 
     This header helps to break up the parser into several bite-sized files.
     These files and their purposes are described below.
-     * parser.c --------- functions from `rtmc_parser.h` and FSM logic
+     * parser.c --------- functions from `rtmc_parser.h`
+     * lexer.c ---------- FSM logic (splits blocks into words)
+     * parse_buffer.c --- splits whole programs into blocks
+     * parse_file.c ----- maps g-code files into memory for parsing
+     * parse_parallel.c - multi-threaded version of `parse_buffer.c`
+     * parse_stream.c --- parses g-code pushed in arbitrary chunks
+     * checkpoints.c ---- snapshots of modal state for restarting programs
+     * program_cache.c -- on-disk cache of compiled programs
+     * decimal.c -------- converts g-code numbers to doubles
      * parse_word.c ----- parse key/value pairs and update modal data
      * generate_path.c -- generates the joint-space path
 */
@@ -17,6 +25,9 @@
 
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "rtmc_checkpoints.h"
 #include "rtmc_parser.h"
 #include "rtmc_path.h"
 
@@ -76,34 +87,185 @@ typedef struct {
 
 
 /*
-    Global modal data
+    Holds a g-code word as key/value pair
 */
-extern modal_data_t modal_data;
-extern non_modal_data_t non_modal_data;
-extern double feed_rate;
-extern double start_coords[RTMC_NUM_AXES];
-extern double end_coords[RTMC_NUM_AXES];
+typedef struct {
+    char key;
+    double value;
+} word_t;
 
 
 
 /*
-    Holds a g-code word as key/value pair
+    Incremental decimal number reader (see `decimal.c` for the details).
+    Chars are pushed one at a time, so a number can be read directly from
+    its source without copying it into a string first.
 */
+#define DECIMAL_MAX_DIGITS 768 // enough to round any double correctly (see `decimal.c`)
+
+typedef enum {
+    DECIMAL_START,
+    DECIMAL_SIGN,
+    DECIMAL_INTEGER,
+    DECIMAL_FRACTION,
+    DECIMAL_EXPONENT_START,
+    DECIMAL_EXPONENT_SIGN,
+    DECIMAL_EXPONENT,
+    DECIMAL_ERROR
+} decimal_state_t;
+
 typedef struct {
-    char key;
-    double value;
-} word_t;
+    decimal_state_t state;
+    bool is_negative;
+    bool has_digits;
+    bool is_truncated;
+    bool is_exponent_negative;
+    int num_digits;
+    uint64_t mantissa;
+    int exponent;
+    int exponent_value;
+    char digits[DECIMAL_MAX_DIGITS];
+} decimal_t;
+
+
+
+/*
+    Lexer state that's kept between chunks when streaming (see
+    `parse_stream.c`), so a block can be split anywhere, even mid-number.
+*/
+typedef struct {
+    int state; // FSM state (see `lexer.c`)
+    word_t word; // the word being read
+    decimal_t value; // its value so far
+} stream_lexer_t;
+
+typedef struct {
+    stream_lexer_t lexer;
+    rtmc_parsed_block_t parsed_block; // the block being read
+    size_t line; // line number of that block
+    bool is_in_block; // true if part of a block has been read
+    bool after_carriage_return; // true if the last char was '\r'
+} stream_data_t;
+
+
+
+/*
+    Parser context (declared as `rtmc_parser_t` in `rtmc_parser.h`)
+
+    Holds all state that carries over from one g-code block to the next, so
+    independent parsers can run side by side.
+*/
+struct rtmc_parser {
+    modal_data_t modal_data;
+    non_modal_data_t non_modal_data;
+    double feed_rate;
+    double start_coords[RTMC_NUM_AXES];
+    double end_coords[RTMC_NUM_AXES];
+    stream_data_t stream_data;
+    rtmc_checkpoints_t* checkpoints; // NULL unless recording checkpoints
+};
 
 
 
 /*
     Private interface
 */
+// read a decimal number one char at a time
+void decimal_init(decimal_t* decimal);
+void decimal_push(decimal_t* decimal, char c);
+
+// returns false if the chars pushed so far aren't a valid number
+bool decimal_finish(const decimal_t* decimal, double* value);
+
+// converts `length` chars to a double (returns false if they aren't a number)
+bool parse_decimal(const char* str, size_t length, double* value);
+
+/*
+    Lexer
+
+    `lex_word()` reads the next word of a block, starting at `*index`, and
+    moves `*index` past it. Chars at or past `length` are treated as '\0'.
+    LEX_END means the block has no more words.
+*/
+typedef enum {
+    LEX_WORD,
+    LEX_END,
+    LEX_GRAMMAR_ERROR,
+    LEX_VALUE_ERROR,
+    LEX_MORE // only used by `lex_char()`
+} lex_result_t;
+
+lex_result_t lex_word(const char* block, size_t length, size_t* index, word_t* word);
+
+/*
+    Streaming lexer
+
+    `lex_char()` feeds the lexer one char at a time. It returns LEX_WORD (or
+    an error) when `c` completes a word, LEX_END when `c` is a terminator
+    outside of a word, and LEX_MORE otherwise. Blocks end at the same chars
+    as `lex_word()`, and the result for each word is identical.
+*/
+void stream_lexer_init(stream_lexer_t* lexer);
+lex_result_t lex_char(stream_lexer_t* lexer, char c, word_t* word);
+
+// returns true for chars that end a g-code block
+static inline bool is_terminator(char c) {
+    return c == '\r' || c == '\n' || c == '\0';
+}
+
+// returns the index of the first '\r', '\n', or '\0' (or `length` if none)
+size_t find_line_end(const char* str, size_t length);
+
+// same as `find_line_end()`, but for strings of unknown length
+size_t find_string_end(const char* str);
+
+/*
+    Parsing a block is split into three steps, so blocks can be fed from
+    different sources (whole strings, pre-lexed words, or streamed chars):
+     1. `begin_block()` resets the per-block data
+     2. `apply_word()` is called for each word (until it returns false)
+     3. `finish_block()` generates the path and enqueues it
+*/
+void begin_block(rtmc_parser_t* parser, rtmc_parsed_block_t* parsed_block);
+bool apply_word(rtmc_parser_t* parser, lex_result_t result, word_t* word, rtmc_parsed_block_t* parsed_block);
+void finish_block(rtmc_parser_t* parser, rtmc_path_queue_t* queue, rtmc_parsed_block_t* parsed_block);
+
+// parses one block (stopping early after `length` chars) into `parsed_block`
+void parse_block(rtmc_parser_t* parser, rtmc_path_queue_t* queue, const char* block, size_t length, rtmc_parsed_block_t* parsed_block);
+
+/*
+    Helpers for parsing whole programs (see `rtmc_parse_buffer()`)
+*/
+// appends an error (if there's room) and returns the new number of errors
+size_t record_error(rtmc_parse_error_t* errors, size_t max_errors, size_t num_errors, size_t line, char* error_msg);
+
+// returns the index just past the line terminator at `i`
+size_t skip_terminator(const char* buffer, size_t length, size_t i);
+
+// parses every line in `buffer`, numbering them from `*line` (which is
+// advanced), and returns the new number of errors (`offset` is the index
+// of `buffer` within the whole program)
+size_t parse_lines(
+    rtmc_parser_t* parser, rtmc_path_queue_t* queue,
+    const char* buffer, size_t length, size_t offset, size_t* line,
+    rtmc_parse_error_t* errors, size_t max_errors, size_t num_errors
+);
+
+// records a checkpoint before `line` (at `offset`) if one is due
+void record_checkpoint(rtmc_parser_t* parser, size_t line, size_t offset);
+
+// for the program cache, which stores a program's checkpoints as raw bytes
+// (`checkpoints_data_size()` is the size of `count` checkpoints)
+size_t checkpoints_interval(const rtmc_checkpoints_t* checkpoints);
+size_t checkpoints_data_size(size_t count);
+void copy_checkpoints_out(const rtmc_checkpoints_t* checkpoints, void* data);
+bool copy_checkpoints_in(rtmc_checkpoints_t* checkpoints, const void* data, size_t count);
+
 // return false when for invalid words; otherwise assigns key/value to `word`
-bool parse_word(word_t* word);
+bool parse_word(rtmc_parser_t* parser, word_t* word);
 
 // builds the `path` and `parsed_block`
-void generate_path(rtmc_path_t* path, rtmc_parsed_block_t* parsed_block);
+void generate_path(rtmc_parser_t* parser, rtmc_path_t* path, rtmc_parsed_block_t* parsed_block);
 
 
 
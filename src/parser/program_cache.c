@@ -0,0 +1,415 @@
+/*
+    parser/program_cache.c
+
+    Each program is stored as a path file named after its 64-bit FNV-1a
+    hash. The hash covers the parser state the program starts from and the
+    program's bytes. The file's metadata holds both of those too, and a hit
+    only counts if they match exactly, so a hash collision is just a miss
+    (and the colliding program replaces the cached one).
+
+    The metadata also holds:
+     * the parser state after the last block, which is restored on a hit
+     * the checkpoints recorded while parsing (if the parser was recording
+       any), which are copied into the parser's checkpoints on a hit
+     * when the file was last used, as a sequence number that's rewritten
+       in place on every hit (file times only have 1-second resolution)
+
+    New files are written under a temporary name and renamed into place, so
+    a file is never read half-written. Eviction needs to list the directory,
+    so it's only done on POSIX systems.
+*/
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../alloc.h"
+#include "parser.h"
+#include "rtmc_program_cache.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define USE_POSIX
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+// room for the directory, a '/', 16 hex digits, and the extension
+#define MAX_FILENAME_LENGTH 4096
+static const char cache_extension[] = ".rtmcp";
+
+struct rtmc_program_cache {
+    char* directory;
+    uint64_t max_size;
+    uint64_t last_sequence;
+    rtmc_program_cache_stats_t stats;
+};
+
+// the modal state that carries over between blocks (as in a checkpoint)
+typedef struct {
+    modal_data_t modal_data;
+    double feed_rate;
+    double end_coords[RTMC_NUM_AXES];
+} parser_state_t;
+
+// followed by the program's bytes, then its checkpoints
+typedef struct {
+    uint64_t last_used; // sequence number (see `next_sequence()`)
+    uint64_t program_length;
+    uint64_t checkpoint_interval; // 0 if no checkpoints were recorded
+    uint64_t num_checkpoints;
+    parser_state_t initial_state;
+    parser_state_t final_state;
+} cache_metadata_t;
+
+
+
+/*
+    Create and destroy caches
+*/
+rtmc_program_cache_t* rtmc_create_program_cache(const char* directory, uint64_t max_size) {
+    rtmc_program_cache_t* cache = (rtmc_program_cache_t*)rtmc_malloc(sizeof(rtmc_program_cache_t));
+    if(!cache) {
+        return NULL;
+    }
+
+    cache->directory = (char*)rtmc_malloc(strlen(directory) + 1);
+    if(!cache->directory) {
+        rtmc_free(cache);
+        return NULL;
+    }
+    strcpy(cache->directory, directory);
+
+    cache->max_size = max_size;
+    cache->last_sequence = 0;
+    cache->stats.hits = 0;
+    cache->stats.misses = 0;
+    cache->stats.evictions = 0;
+    return cache;
+}
+
+void rtmc_destroy_program_cache(rtmc_program_cache_t* cache) {
+    if(cache) {
+        rtmc_free(cache->directory);
+        rtmc_free(cache);
+    }
+}
+
+rtmc_program_cache_stats_t rtmc_get_program_cache_stats(const rtmc_program_cache_t* cache) {
+    return cache->stats;
+}
+
+
+
+/*
+    Helpers
+*/
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for(size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static parser_state_t get_parser_state(const rtmc_parser_t* parser) {
+    // zeroed first, so struct padding can't change the hash
+    parser_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.modal_data = parser->modal_data;
+    state.feed_rate = parser->feed_rate;
+    memcpy(state.end_coords, parser->end_coords, sizeof(state.end_coords));
+    return state;
+}
+
+static void set_parser_state(rtmc_parser_t* parser, const parser_state_t* state) {
+    parser->modal_data = state->modal_data;
+    parser->feed_rate = state->feed_rate;
+    memcpy(parser->end_coords, state->end_coords, sizeof(parser->end_coords));
+}
+
+/*
+    Returns a sequence number for "now". Sequence numbers count nanoseconds,
+    so they're ordered across processes sharing a directory, and they always
+    go up within a cache (even if the clock doesn't).
+*/
+static uint64_t next_sequence(rtmc_program_cache_t* cache) {
+    struct timespec now;
+    uint64_t sequence = 0;
+    if(timespec_get(&now, TIME_UTC) == TIME_UTC) {
+        sequence = (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+    }
+
+    if(sequence <= cache->last_sequence) {
+        sequence = cache->last_sequence + 1;
+    }
+    cache->last_sequence = sequence;
+    return sequence;
+}
+
+static void clear_view(rtmc_path_view_t* view) {
+    memset(view, 0, sizeof(*view));
+}
+
+// returns true if `name` is a cache file
+static bool is_cache_filename(const char* name) {
+    size_t length = strlen(name);
+    size_t extension_length = sizeof(cache_extension) - 1;
+    return length > extension_length && strcmp(name + length - extension_length, cache_extension) == 0;
+}
+
+#ifdef USE_POSIX
+typedef struct {
+    char* filename;
+    uint64_t size;
+    uint64_t last_used;
+} cache_file_t;
+
+static int compare_last_used(const void* f1, const void* f2) {
+    uint64_t t1 = ((const cache_file_t*)f1)->last_used;
+    uint64_t t2 = ((const cache_file_t*)f2)->last_used;
+    return (t1 > t2) - (t1 < t2);
+}
+
+// returns when a file was last used (0, so it goes first, if it isn't a
+// readable cache file)
+static uint64_t read_last_used(const char* filename) {
+    rtmc_path_view_t view;
+    if(!rtmc_open_path_view(&view, filename)) {
+        return 0;
+    }
+
+    uint64_t last_used = 0;
+    if(view.metadata_size >= sizeof(cache_metadata_t)) {
+        memcpy(&last_used, (const char*)view.metadata + offsetof(cache_metadata_t, last_used), sizeof(last_used));
+    }
+    rtmc_close_path_view(&view);
+    return last_used;
+}
+#endif
+
+// deletes the least recently used files (except `keep`) until the cache fits
+static void evict(rtmc_program_cache_t* cache, const char* keep) {
+#ifdef USE_POSIX
+    DIR* directory = opendir(cache->directory);
+    if(!directory) {
+        return;
+    }
+
+    // list every cache file
+    cache_file_t* files = NULL;
+    size_t num_files = 0;
+    size_t capacity = 0;
+    uint64_t total_size = 0;
+
+    struct dirent* entry;
+    while((entry = readdir(directory))) {
+        if(!is_cache_filename(entry->d_name)) {
+            continue;
+        }
+
+        char filename[MAX_FILENAME_LENGTH];
+        struct stat file_info;
+        if(snprintf(filename, sizeof(filename), "%s/%s", cache->directory, entry->d_name) >= (int)sizeof(filename)
+            || stat(filename, &file_info) != 0) {
+            continue;
+        }
+
+        if(num_files == capacity) {
+            size_t new_capacity = (capacity == 0) ? 64 : capacity * 2;
+            cache_file_t* new_files = (cache_file_t*)rtmc_realloc(files, new_capacity * sizeof(cache_file_t));
+            if(!new_files) {
+                break;
+            }
+            files = new_files;
+            capacity = new_capacity;
+        }
+
+        char* name = (char*)rtmc_malloc(strlen(filename) + 1);
+        if(!name) {
+            break;
+        }
+        strcpy(name, filename);
+
+        files[num_files].filename = name;
+        files[num_files].size = (uint64_t)file_info.st_size;
+        files[num_files].last_used = read_last_used(filename);
+        num_files++;
+        total_size += (uint64_t)file_info.st_size;
+    }
+    closedir(directory);
+
+    // delete the oldest first
+    qsort(files, num_files, sizeof(cache_file_t), compare_last_used);
+    for(size_t i = 0; i < num_files && total_size > cache->max_size; i++) {
+        if(strcmp(files[i].filename, keep) != 0 && remove(files[i].filename) == 0) {
+            total_size -= files[i].size;
+            cache->stats.evictions++;
+        }
+    }
+
+    for(size_t i = 0; i < num_files; i++) {
+        rtmc_free(files[i].filename);
+    }
+    rtmc_free(files);
+#else
+    (void)cache;
+    (void)keep;
+#endif
+}
+
+// returns the size of an entry's metadata
+static size_t metadata_size(size_t length, size_t num_checkpoints) {
+    return sizeof(cache_metadata_t) + length + checkpoints_data_size(num_checkpoints);
+}
+
+// opens the cached program (returns false unless it's the same program,
+// parsed from the same state)
+static bool open_cached(
+    const char* filename, uint64_t hash, const parser_state_t* initial_state,
+    const char* buffer, size_t length, rtmc_path_view_t* view, cache_metadata_t* metadata
+) {
+    if(!rtmc_open_path_view(view, filename)) {
+        return false;
+    }
+
+    // the metadata isn't necessarily aligned for `cache_metadata_t`
+    const char* data = (const char*)view->metadata;
+    bool is_match = view->source_hash == hash && view->metadata_size >= sizeof(cache_metadata_t);
+    if(is_match) {
+        memcpy(metadata, data, sizeof(cache_metadata_t));
+        is_match = metadata->program_length == length
+            && view->metadata_size == metadata_size(length, metadata->num_checkpoints)
+            && memcmp(&metadata->initial_state, initial_state, sizeof(parser_state_t)) == 0
+            && memcmp(data + sizeof(cache_metadata_t), buffer, length) == 0;
+    }
+
+    if(!is_match) {
+        rtmc_close_path_view(view);
+    }
+    return is_match;
+}
+
+// marks a cached program as just used (best effort)
+static void touch_cached(rtmc_program_cache_t* cache, const char* filename, const rtmc_path_view_t* view) {
+    uint64_t last_used = next_sequence(cache);
+    long offset = (long)((const char*)view->metadata - (const char*)view->data) + (long)offsetof(cache_metadata_t, last_used);
+
+    FILE* file = fopen(filename, "r+b");
+    if(file) {
+        if(fseek(file, offset, SEEK_SET) == 0) {
+            fwrite(&last_used, sizeof(last_used), 1, file);
+        }
+        fclose(file);
+    }
+}
+
+// gives the parser's checkpoints the ones a cached program recorded (or, if
+// it recorded them at a different interval, parses the program again just
+// for its checkpoints)
+static void restore_checkpoints(
+    rtmc_parser_t* parser, const cache_metadata_t* metadata, const rtmc_path_view_t* view,
+    const char* buffer, size_t length
+) {
+    rtmc_checkpoints_t* checkpoints = parser->checkpoints;
+    if(!checkpoints) {
+        return;
+    }
+
+    const char* data = (const char*)view->metadata + sizeof(cache_metadata_t) + length;
+    if(metadata->checkpoint_interval == checkpoints_interval(checkpoints)
+        && copy_checkpoints_in(checkpoints, data, (size_t)metadata->num_checkpoints)) {
+        return;
+    }
+
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    size_t line = 1;
+    set_parser_state(parser, &metadata->initial_state);
+    parse_lines(parser, &queue, buffer, length, 0, &line, NULL, 0, 0);
+    rtmc_flush_path_queue(&queue);
+}
+
+
+
+size_t rtmc_cache_parse_buffer(
+    rtmc_program_cache_t* cache, rtmc_parser_t* parser,
+    const char* buffer, size_t length, rtmc_path_view_t* view,
+    rtmc_parse_error_t* errors, size_t max_errors
+) {
+    clear_view(view);
+
+    // the key covers both the starting state and the program
+    parser_state_t initial_state = get_parser_state(parser);
+    uint64_t hash = fnv1a(FNV_OFFSET_BASIS, &initial_state, sizeof(initial_state));
+    hash = fnv1a(hash, buffer, length);
+
+    char filename[MAX_FILENAME_LENGTH];
+    char temp_filename[MAX_FILENAME_LENGTH];
+    int filename_length = snprintf(filename, sizeof(filename), "%s/%016" PRIx64 "%s", cache->directory, hash, cache_extension);
+    int temp_filename_length = snprintf(temp_filename, sizeof(temp_filename), "%s.tmp", filename);
+    if(filename_length < 0 || temp_filename_length < 0 || temp_filename_length >= (int)sizeof(temp_filename)) {
+        return record_error(errors, max_errors, 0, 0, "Unable to write program cache");
+    }
+
+    // hit: restore the final state and mark the file as recently used
+    cache_metadata_t metadata;
+    if(open_cached(filename, hash, &initial_state, buffer, length, view, &metadata)) {
+        cache->stats.hits++;
+        restore_checkpoints(parser, &metadata, view, buffer, length);
+        set_parser_state(parser, &metadata.final_state);
+        touch_cached(cache, filename, view);
+        return 0;
+    }
+
+    // miss: compile the program
+    cache->stats.misses++;
+    struct rtmc_parser saved_parser = *parser;
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    size_t num_errors = rtmc_parse_buffer(parser, &queue, buffer, length, errors, max_errors);
+    if(num_errors > 0) {
+        rtmc_flush_path_queue(&queue);
+        return num_errors;
+    }
+
+    // the metadata is stored along with the program and its checkpoints
+    size_t num_checkpoints = parser->checkpoints ? rtmc_checkpoint_count(parser->checkpoints) : 0;
+    char* stored = (char*)rtmc_malloc(metadata_size(length, num_checkpoints));
+    if(!stored) {
+        rtmc_flush_path_queue(&queue);
+        *parser = saved_parser;
+        return record_error(errors, max_errors, 0, 0, "Unable to write program cache");
+    }
+
+    memset(&metadata, 0, sizeof(metadata));
+    metadata.last_used = next_sequence(cache);
+    metadata.program_length = length;
+    metadata.checkpoint_interval = parser->checkpoints ? checkpoints_interval(parser->checkpoints) : 0;
+    metadata.num_checkpoints = num_checkpoints;
+    metadata.initial_state = initial_state;
+    metadata.final_state = get_parser_state(parser);
+    memcpy(stored, &metadata, sizeof(metadata));
+    memcpy(stored + sizeof(metadata), buffer, length);
+    if(num_checkpoints > 0) {
+        copy_checkpoints_out(parser->checkpoints, stored + sizeof(metadata) + length);
+    }
+
+    // store it, then read it back from the cache
+    bool is_stored = rtmc_write_path_file(temp_filename, &queue, hash, stored, metadata_size(length, num_checkpoints))
+        && rename(temp_filename, filename) == 0
+        && open_cached(filename, hash, &initial_state, buffer, length, view, &metadata);
+    rtmc_free(stored);
+    rtmc_flush_path_queue(&queue);
+    if(!is_stored) {
+        remove(temp_filename);
+        *parser = saved_parser;
+        return record_error(errors, max_errors, 0, 0, "Unable to write program cache");
+    }
+
+    evict(cache, filename);
+    return 0;
+}
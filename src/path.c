@@ -2,68 +2,176 @@
     path.c
 */
 
-#include <stdlib.h>
+#include "alloc.h"
 #include "rtmc_path.h"
+#include "trace.h"
+
+// returns a bit mask of the moving axes
+uint16_t rtmc_path_active_axes(const rtmc_path_t* path) {
+    uint16_t active_axes = 0;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        const double* coefficients = path->coefficients[i];
+        if(coefficients[0] != 0 || coefficients[1] != 0 || coefficients[2] != 0) {
+            active_axes |= (uint16_t)(1 << i);
+        }
+    }
+
+    return active_axes;
+}
+
+bool rtmc_path_is_trigonometric_axis(enum rtmc_path_type type, int axis) {
+    switch(type) {
+        case RTMC_PATH_TYPE_POLYNOMIAL:
+            return false;
+
+        case RTMC_PATH_TYPE_TRIGONOMETRIC:
+            return true;
+
+        case RTMC_PATH_TYPE_HELICAL_XY:
+            return axis == RTMC_X_AXIS || axis == RTMC_Y_AXIS;
+
+        case RTMC_PATH_TYPE_HELICAL_XZ:
+            return axis == RTMC_X_AXIS || axis == RTMC_Z_AXIS;
+
+        case RTMC_PATH_TYPE_HELICAL_YZ:
+            return axis == RTMC_Y_AXIS || axis == RTMC_Z_AXIS;
+    }
+
+    return false;
+}
 
 // create a path queue
 rtmc_path_queue_t rtmc_create_path_queue() {
-    rtmc_path_queue_t queue = {NULL, NULL};
+    rtmc_path_queue_t queue = {NULL, NULL, 0, 0, NULL};
     return queue;
 }
 
-// adds a path to the queue
-void rtmc_path_enqueue(rtmc_path_queue_t* queue, rtmc_path_t path) {
-    rtmc_path_node_t* new_node = (rtmc_path_node_t*)malloc(sizeof(rtmc_path_node_t));
-    new_node->path = path;
-    new_node->next = NULL;
+// takes a chunk from the free list (only allocating if the list is empty)
+static rtmc_path_chunk_t* take_chunk(rtmc_path_queue_t* queue) {
+    rtmc_path_chunk_t* chunk = queue->free_chunks;
 
-    if(queue->tail) { // queue has nodes
-        queue->tail->next = new_node;
+    if(chunk) { // reuse a chunk
+        queue->free_chunks = chunk->next;
     }
-    else { // queue is empty
-        queue->head = new_node;
+    else { // no chunks left to reuse
+        chunk = (rtmc_path_chunk_t*)rtmc_malloc(sizeof(rtmc_path_chunk_t));
     }
 
-    queue->tail = new_node;
+    chunk->next = NULL;
+    return chunk;
 }
 
-// removes a path from the queue
-rtmc_path_t rtmc_path_dequeue(rtmc_path_queue_t* queue) {
-    if(queue->head) { // queue has nodes
-        // get pointer to head node (to free later)
-        rtmc_path_node_t* old_head = queue->head;
+// returns a chunk to the free list
+static void recycle_chunk(rtmc_path_queue_t* queue, rtmc_path_chunk_t* chunk) {
+    chunk->next = queue->free_chunks;
+    queue->free_chunks = chunk;
+}
+
+// returns the slot that the next committed path will occupy
+rtmc_path_t* rtmc_path_queue_reserve(rtmc_path_queue_t* queue) {
+    if(queue->tail && queue->tail_index < RTMC_PATH_CHUNK_SIZE) {
+        // there's room left in the tail chunk
+        return &queue->tail->paths[queue->tail_index];
+    }
 
-        // get head node's path
-        rtmc_path_t path = queue->head->path;
+    // the path goes at the start of the next chunk `take_chunk()` will return
+    if(queue->free_chunks == NULL) {
+        recycle_chunk(queue, (rtmc_path_chunk_t*)rtmc_malloc(sizeof(rtmc_path_chunk_t)));
+    }
+    return &queue->free_chunks->paths[0];
+}
 
-        // remove node from linked list
-        queue->head = queue->head->next;
+// adds the reserved slot to the queue
+void rtmc_path_queue_commit(rtmc_path_queue_t* queue) {
+    TRACE_BEGIN();
 
-        // handle empty queue
-        if(queue->head == NULL) {
-            queue->tail = NULL;
-        }
+    if(queue->tail == NULL) { // queue is empty
+        queue->tail = take_chunk(queue);
+        queue->head = queue->tail;
+        queue->head_index = 0;
+        queue->tail_index = 0;
+    }
+    else if(queue->tail_index == RTMC_PATH_CHUNK_SIZE) { // tail chunk is full
+        queue->tail->next = take_chunk(queue);
+        queue->tail = queue->tail->next;
+        queue->tail_index = 0;
+    }
+
+    queue->tail_index++;
 
-        // free memory for dequeued node
-        free(old_head);
+    TRACE_END(TRACE_PATH_ENQUEUE);
+}
 
-        return path;
+// returns the head of the queue (NULL if empty)
+const rtmc_path_t* rtmc_path_queue_front(const rtmc_path_queue_t* queue) {
+    return queue->head ? &queue->head->paths[queue->head_index] : NULL;
+}
+
+// removes the head of the queue
+void rtmc_path_queue_release(rtmc_path_queue_t* queue) {
+    if(queue->head == NULL) { // queue is already empty
+        return;
     }
-    else { // queue is already empty
-        // silently return an empty path
-        rtmc_path_t path;
-        return path;
+
+    TRACE_BEGIN();
+
+    queue->head_index++;
+
+    if(queue->head == queue->tail && queue->head_index == queue->tail_index) {
+        // queue is now empty
+        recycle_chunk(queue, queue->head);
+        queue->head = NULL;
+        queue->tail = NULL;
+    }
+    else if(queue->head_index == RTMC_PATH_CHUNK_SIZE) {
+        // head chunk is used up, move on to the next one
+        rtmc_path_chunk_t* old_head = queue->head;
+        queue->head = queue->head->next;
+        queue->head_index = 0;
+        recycle_chunk(queue, old_head);
     }
+
+    TRACE_END(TRACE_PATH_DEQUEUE);
+}
+
+// adds a path to the queue
+void rtmc_path_enqueue(rtmc_path_queue_t* queue, rtmc_path_t path) {
+    *rtmc_path_queue_reserve(queue) = path;
+    rtmc_path_queue_commit(queue);
+}
+
+// removes a path from the queue
+rtmc_path_t rtmc_path_dequeue(rtmc_path_queue_t* queue) {
+    rtmc_path_t path;
+
+    const rtmc_path_t* head = rtmc_path_queue_front(queue);
+    if(head) { // queue has paths
+        path = *head;
+        rtmc_path_queue_release(queue);
+    }
+
+    // note: an empty queue silently returns an empty path
+    return path;
 }
 
 rtmc_path_t rtmc_path_queue_peek(const rtmc_path_queue_t* queue) {
-    return queue->head->path;
+    return queue->head->paths[queue->head_index];
 }
 
 // deletes all paths from the queue (freeing the memory)
 void rtmc_flush_path_queue(rtmc_path_queue_t* queue) {
-    // remove everything from the queue
+    // move every chunk onto the free list
     while(queue->head) {
-        rtmc_path_dequeue(queue);
+        rtmc_path_chunk_t* old_head = queue->head;
+        queue->head = queue->head->next;
+        recycle_chunk(queue, old_head);
+    }
+    queue->tail = NULL;
+
+    // then free the whole list
+    while(queue->free_chunks) {
+        rtmc_path_chunk_t* chunk = queue->free_chunks;
+        queue->free_chunks = chunk->next;
+        rtmc_free(chunk);
     }
 }
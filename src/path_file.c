@@ -0,0 +1,213 @@
+/*
+    path_file.c
+
+    File layout:
+     * header (`path_file_header_t`)
+     * metadata (padded to a multiple of 8 bytes, so the paths are aligned)
+     * paths (`count` copies of `rtmc_path_t`)
+
+    Paths are stored in native byte order, so files are only meant to be
+    read on machines like the one that wrote them. The header records the
+    byte order and path size, and files that don't match are rejected.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "alloc.h"
+#include "rtmc_path_file.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// bump whenever `rtmc_path_t` or the file layout changes
+#define PATH_FILE_VERSION 1
+#define PATH_FILE_BYTE_ORDER 0x01020304
+static const char path_file_magic[8] = "RTMCPATH";
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t path_size;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t source_hash;
+    uint64_t metadata_size;
+} path_file_header_t;
+
+// rounds the metadata size up so the paths that follow are aligned
+static uint64_t padded_size(uint64_t size) {
+    return (size + 7) & ~(uint64_t)7;
+}
+
+
+
+bool rtmc_write_path_file(
+    const char* filename, rtmc_path_queue_t* queue, uint64_t source_hash,
+    const void* metadata, size_t metadata_size
+) {
+    FILE* file = fopen(filename, "wb");
+    if(file == NULL) {
+        rtmc_flush_path_queue(queue);
+        return false;
+    }
+
+    // the path count is filled in once the queue has been drained
+    path_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, path_file_magic, sizeof(header.magic));
+    header.version = PATH_FILE_VERSION;
+    header.byte_order = PATH_FILE_BYTE_ORDER;
+    header.path_size = sizeof(rtmc_path_t);
+    header.source_hash = source_hash;
+    header.metadata_size = metadata_size;
+
+    static const char padding[8] = {0};
+    bool is_written = fwrite(&header, sizeof(header), 1, file) == 1
+        && (metadata_size == 0 || fwrite(metadata, 1, metadata_size, file) == metadata_size)
+        && fwrite(padding, 1, padded_size(metadata_size) - metadata_size, file) == padded_size(metadata_size) - metadata_size;
+
+    // paths are copied into a zeroed batch, so struct padding is written as
+    // zeros rather than whatever was left in the queue
+    rtmc_path_t batch[RTMC_PATH_CHUNK_SIZE];
+    memset(batch, 0, sizeof(batch));
+    size_t batch_size = 0;
+
+    const rtmc_path_t* path;
+    while((path = rtmc_path_queue_front(queue))) {
+        batch[batch_size].type = path->type;
+        batch[batch_size].feed_rate = path->feed_rate;
+        memcpy(batch[batch_size].coefficients, path->coefficients, sizeof(path->coefficients));
+        rtmc_path_queue_release(queue);
+
+        header.count++;
+        batch_size++;
+        if(batch_size == RTMC_PATH_CHUNK_SIZE) {
+            is_written = is_written && fwrite(batch, sizeof(rtmc_path_t), batch_size, file) == batch_size;
+            batch_size = 0;
+        }
+    }
+    is_written = is_written && fwrite(batch, sizeof(rtmc_path_t), batch_size, file) == batch_size;
+
+    // go back and fill in the count
+    is_written = is_written
+        && fseek(file, 0, SEEK_SET) == 0
+        && fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // closing flushes the data, which can fail too
+    return (fclose(file) == 0) && is_written;
+}
+
+
+
+// reads the whole file into `view->data` (returns false on failure)
+static bool load_file(rtmc_path_view_t* view, const char* filename) {
+#ifdef USE_MMAP
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat file_info;
+    if(fstat(fd, &file_info) != 0 || (size_t)file_info.st_size < sizeof(path_file_header_t)) {
+        close(fd);
+        return false;
+    }
+
+    size_t length = (size_t)file_info.st_size;
+    void* data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid after closing
+    if(data == MAP_FAILED) {
+        return false;
+    }
+    posix_madvise(data, length, POSIX_MADV_SEQUENTIAL);
+
+#else
+    FILE* file = fopen(filename, "rb");
+    if(file == NULL) {
+        return false;
+    }
+
+    // allocated memory is aligned for any type, including `rtmc_path_t`
+    void* data = NULL;
+    long length = -1;
+    if(fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    if(length >= (long)sizeof(path_file_header_t) && fseek(file, 0, SEEK_SET) == 0) {
+        data = rtmc_malloc((size_t)length);
+    }
+    if(data == NULL || fread(data, 1, (size_t)length, file) != (size_t)length) {
+        rtmc_free(data);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+#endif
+
+    view->data = data;
+    view->data_size = (size_t)length;
+    return true;
+}
+
+bool rtmc_open_path_view(rtmc_path_view_t* view, const char* filename) {
+    if(!load_file(view, filename)) {
+        return false;
+    }
+
+    // only accept files written with the same path layout
+    path_file_header_t header;
+    memcpy(&header, view->data, sizeof(header));
+    uint64_t paths_start = sizeof(header) + padded_size(header.metadata_size);
+    bool is_valid = memcmp(header.magic, path_file_magic, sizeof(header.magic)) == 0
+        && header.version == PATH_FILE_VERSION
+        && header.byte_order == PATH_FILE_BYTE_ORDER
+        && header.path_size == sizeof(rtmc_path_t)
+        && header.metadata_size <= view->data_size
+        && paths_start <= view->data_size
+        && header.count <= (view->data_size - paths_start) / sizeof(rtmc_path_t);
+    if(!is_valid) {
+        rtmc_close_path_view(view);
+        return false;
+    }
+
+    const char* data = (const char*)view->data;
+    view->paths = (const rtmc_path_t*)(data + paths_start);
+    view->count = (size_t)header.count;
+    view->index = 0;
+    view->source_hash = header.source_hash;
+    view->metadata = data + sizeof(header);
+    view->metadata_size = (size_t)header.metadata_size;
+    return true;
+}
+
+const rtmc_path_t* rtmc_path_view_front(const rtmc_path_view_t* view) {
+    return (view->index < view->count) ? &view->paths[view->index] : NULL;
+}
+
+void rtmc_path_view_release(rtmc_path_view_t* view) {
+    if(view->index < view->count) {
+        view->index++;
+    }
+}
+
+void rtmc_close_path_view(rtmc_path_view_t* view) {
+    if(view->data) {
+#ifdef USE_MMAP
+        munmap(view->data, view->data_size);
+#else
+        rtmc_free(view->data);
+#endif
+    }
+
+    view->paths = NULL;
+    view->count = 0;
+    view->index = 0;
+    view->data = NULL;
+    view->data_size = 0;
+}
@@ -0,0 +1,63 @@
+/*
+    path_ring.c
+*/
+
+#include "rtmc_path_ring.h"
+
+// create a ring buffer (rounding the capacity down to a power of two)
+rtmc_path_ring_t rtmc_create_path_ring(rtmc_path_t* buffer, size_t capacity) {
+    size_t power_of_two = 1;
+    while(power_of_two <= capacity / 2) {
+        power_of_two *= 2;
+    }
+
+    rtmc_path_ring_t ring;
+    ring.buffer = buffer;
+    ring.capacity = (capacity == 0) ? 0 : power_of_two;
+    ring.head = 0;
+    ring.tail = 0;
+    return ring;
+}
+
+// adds a path to the ring
+bool rtmc_path_ring_enqueue(rtmc_path_ring_t* ring, rtmc_path_t path) {
+    if(ring->tail - ring->head >= ring->capacity) { // ring is full
+        return false;
+    }
+
+    ring->buffer[ring->tail & (ring->capacity - 1)] = path;
+    ring->tail++;
+    return true;
+}
+
+// removes a path from the ring
+bool rtmc_path_ring_dequeue(rtmc_path_ring_t* ring, rtmc_path_t* path) {
+    if(ring->head == ring->tail) { // ring is empty
+        return false;
+    }
+
+    *path = ring->buffer[ring->head & (ring->capacity - 1)];
+    ring->head++;
+    return true;
+}
+
+// copies the head of the ring without removing it
+bool rtmc_path_ring_peek(const rtmc_path_ring_t* ring, rtmc_path_t* path) {
+    if(ring->head == ring->tail) { // ring is empty
+        return false;
+    }
+
+    *path = ring->buffer[ring->head & (ring->capacity - 1)];
+    return true;
+}
+
+// returns the number of paths in the ring
+size_t rtmc_path_ring_size(const rtmc_path_ring_t* ring) {
+    return ring->tail - ring->head;
+}
+
+// removes all paths from the ring
+void rtmc_flush_path_ring(rtmc_path_ring_t* ring) {
+    ring->head = 0;
+    ring->tail = 0;
+}
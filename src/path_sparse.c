@@ -0,0 +1,263 @@
+/*
+    path_sparse.c
+
+    Record layout
+    -------------
+    Each path is stored as a header followed by the coefficients of its
+    active axes (in axis order):
+
+        | type | num_active | active_axes | feed_rate | A B C D | A B C D | ...
+
+    The header is the size of two doubles, so records stay aligned.
+    Records never straddle two chunks. If a record doesn't fit in what's left
+    of the tail chunk, the rest of that chunk is skipped.
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "alloc.h"
+#include "rtmc_path_sparse.h"
+
+#define CHUNK_LENGTH (RTMC_SPARSE_PATH_CHUNK_SIZE / sizeof(double))
+#define HEADER_LENGTH 2
+
+typedef struct {
+    uint8_t type;
+    uint8_t num_active;
+    uint16_t active_axes;
+    uint32_t reserved;
+    double feed_rate;
+} record_header_t;
+
+_Static_assert(sizeof(record_header_t) == HEADER_LENGTH * sizeof(double),
+    "record header must be the size of two doubles");
+
+// `used` is the number of doubles written into `data`
+struct rtmc_sparse_path_chunk {
+    struct rtmc_sparse_path_chunk* next;
+    size_t used;
+    double data[CHUNK_LENGTH];
+};
+
+typedef struct rtmc_sparse_path_chunk chunk_t;
+
+_Static_assert(
+    CHUNK_LENGTH >= HEADER_LENGTH + RTMC_NUM_AXES * RTMC_NUM_PATH_COEFFICIENTS,
+    "RTMC_SPARSE_PATH_CHUNK_SIZE is too small to hold a full path");
+
+
+
+// returns the position of an axis at the end of a path (s = 1)
+static double get_end_position(const rtmc_path_t* path, int axis) {
+    double A = path->coefficients[axis][0];
+    double B = path->coefficients[axis][1];
+    double C = path->coefficients[axis][2];
+    double D = path->coefficients[axis][3];
+
+    if(rtmc_path_is_trigonometric_axis(path->type, axis)) {
+        return A*sin(B*(1 - C)) + D;
+    }
+    else {
+        return A + B + C + D;
+    }
+}
+
+// moves `pose` to the end of the path (only active axes can change)
+static void update_pose(double* pose, const rtmc_path_t* path, uint16_t active_axes) {
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(active_axes & (1 << i)) {
+            pose[i] = get_end_position(path, i);
+        }
+    }
+}
+
+// takes a chunk from the free list (only allocating if the list is empty)
+static chunk_t* take_chunk(rtmc_sparse_path_queue_t* queue) {
+    chunk_t* chunk = queue->free_chunks;
+
+    if(chunk) { // reuse a chunk
+        queue->free_chunks = chunk->next;
+    }
+    else { // no chunks left to reuse
+        chunk = (chunk_t*)rtmc_malloc(sizeof(chunk_t));
+    }
+
+    chunk->next = NULL;
+    chunk->used = 0;
+    return chunk;
+}
+
+// returns a chunk to the free list
+static void recycle_chunk(rtmc_sparse_path_queue_t* queue, chunk_t* chunk) {
+    chunk->next = queue->free_chunks;
+    queue->free_chunks = chunk;
+}
+
+// rebuilds a full path from the record at `record`
+static void decode(rtmc_path_t* path, const double* record, const double* pose) {
+    record_header_t header;
+    memcpy(&header, record, sizeof(header));
+
+    path->type = (enum rtmc_path_type)header.type;
+    path->feed_rate = header.feed_rate;
+
+    const double* coefficients = record + HEADER_LENGTH;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(header.active_axes & (1 << i)) { // active axis
+            for(int j = 0; j < RTMC_NUM_PATH_COEFFICIENTS; j++) {
+                path->coefficients[i][j] = *coefficients++;
+            }
+        }
+        else { // idle axis
+            path->coefficients[i][0] = 0;
+            path->coefficients[i][1] = 0;
+            path->coefficients[i][2] = 0;
+            path->coefficients[i][3] = pose[i];
+        }
+    }
+}
+
+
+
+// create a sparse path queue
+rtmc_sparse_path_queue_t rtmc_create_sparse_path_queue() {
+    rtmc_sparse_path_queue_t queue;
+    queue.head = NULL;
+    queue.tail = NULL;
+    queue.head_offset = 0;
+    queue.free_chunks = NULL;
+
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        queue.head_pose[i] = 0;
+        queue.tail_pose[i] = 0;
+    }
+
+    return queue;
+}
+
+// adds a path to the queue
+void rtmc_sparse_path_enqueue(rtmc_sparse_path_queue_t* queue, rtmc_path_t path) {
+    // an axis can only be left out if it sits still at the known position
+    uint16_t active_axes = rtmc_path_active_axes(&path);
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(path.coefficients[i][3] != queue->tail_pose[i]) {
+            active_axes |= (uint16_t)(1 << i);
+        }
+    }
+
+    record_header_t header;
+    header.type = (uint8_t)path.type;
+    header.num_active = 0;
+    header.active_axes = active_axes;
+    header.reserved = 0;
+    header.feed_rate = path.feed_rate;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(active_axes & (1 << i)) {
+            header.num_active++;
+        }
+    }
+
+    // find room for the record
+    size_t length = HEADER_LENGTH + header.num_active * RTMC_NUM_PATH_COEFFICIENTS;
+    if(queue->tail == NULL) { // queue is empty
+        queue->tail = take_chunk(queue);
+        queue->head = queue->tail;
+        queue->head_offset = 0;
+    }
+    else if(queue->tail->used + length > CHUNK_LENGTH) { // tail chunk is full
+        queue->tail->next = take_chunk(queue);
+        queue->tail = queue->tail->next;
+    }
+
+    // write the record
+    double* record = queue->tail->data + queue->tail->used;
+    memcpy(record, &header, sizeof(header));
+
+    double* coefficients = record + HEADER_LENGTH;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(active_axes & (1 << i)) {
+            for(int j = 0; j < RTMC_NUM_PATH_COEFFICIENTS; j++) {
+                *coefficients++ = path.coefficients[i][j];
+            }
+        }
+    }
+
+    queue->tail->used += length;
+    update_pose(queue->tail_pose, &path, active_axes);
+}
+
+// removes a path from the queue
+rtmc_path_t rtmc_sparse_path_dequeue(rtmc_sparse_path_queue_t* queue) {
+    rtmc_path_t path;
+
+    if(queue->head) { // queue has paths
+        const double* record = queue->head->data + queue->head_offset;
+        decode(&path, record, queue->head_pose);
+
+        record_header_t header;
+        memcpy(&header, record, sizeof(header));
+        update_pose(queue->head_pose, &path, header.active_axes);
+        queue->head_offset += HEADER_LENGTH + header.num_active * RTMC_NUM_PATH_COEFFICIENTS;
+
+        if(queue->head == queue->tail && queue->head_offset == queue->tail->used) {
+            // queue is now empty
+            recycle_chunk(queue, queue->head);
+            queue->head = NULL;
+            queue->tail = NULL;
+        }
+        else if(queue->head_offset == queue->head->used) {
+            // head chunk is used up, move on to the next one
+            chunk_t* old_head = queue->head;
+            queue->head = queue->head->next;
+            queue->head_offset = 0;
+            recycle_chunk(queue, old_head);
+        }
+    }
+
+    // note: like `rtmc_path_dequeue()`, an empty queue silently returns an
+    // empty path
+    return path;
+}
+
+rtmc_path_t rtmc_sparse_path_queue_peek(const rtmc_sparse_path_queue_t* queue) {
+    rtmc_path_t path;
+    decode(&path, queue->head->data + queue->head_offset, queue->head_pose);
+    return path;
+}
+
+size_t rtmc_sparse_path_queue_memory(const rtmc_sparse_path_queue_t* queue) {
+    size_t num_chunks = 0;
+    for(const chunk_t* chunk = queue->head; chunk; chunk = chunk->next) {
+        num_chunks++;
+    }
+    for(const chunk_t* chunk = queue->free_chunks; chunk; chunk = chunk->next) {
+        num_chunks++;
+    }
+
+    return num_chunks * sizeof(chunk_t);
+}
+
+// deletes all paths from the queue (freeing the memory)
+void rtmc_flush_sparse_path_queue(rtmc_sparse_path_queue_t* queue) {
+    // move every chunk onto the free list
+    while(queue->head) {
+        chunk_t* old_head = queue->head;
+        queue->head = queue->head->next;
+        recycle_chunk(queue, old_head);
+    }
+    queue->tail = NULL;
+    queue->head_offset = 0;
+
+    // then free the whole list
+    while(queue->free_chunks) {
+        chunk_t* chunk = queue->free_chunks;
+        queue->free_chunks = chunk->next;
+        rtmc_free(chunk);
+    }
+
+    // nothing is left to dequeue, so both ends agree on the pose
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        queue->head_pose[i] = queue->tail_pose[i];
+    }
+}
@@ -0,0 +1,87 @@
+/*
+    path_spsc.c
+
+    Memory ordering: the producer writes a path into the buffer, then
+    publishes it with a release store to `tail`. The consumer reads `tail`
+    with an acquire load before touching the buffer, so the path is fully
+    visible. The same happens in reverse for `head`, which tells the producer
+    that a slot may be reused.
+*/
+
+#include "rtmc_path_spsc.h"
+
+_Static_assert(sizeof(atomic_size_t) == sizeof(size_t),
+    "atomic_size_t must have the same layout as size_t");
+
+// initialize a queue (rounding the capacity down to a power of two)
+void rtmc_init_path_spsc(rtmc_path_spsc_t* queue, rtmc_path_t* buffer, size_t capacity) {
+    size_t power_of_two = 1;
+    while(power_of_two <= capacity / 2) {
+        power_of_two *= 2;
+    }
+
+    queue->buffer = buffer;
+    queue->capacity = (capacity == 0) ? 0 : power_of_two;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    queue->cached_head = 0;
+    queue->cached_tail = 0;
+}
+
+// adds a path to the queue (producer only)
+bool rtmc_path_spsc_enqueue(rtmc_path_spsc_t* queue, rtmc_path_t path) {
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    if(tail - queue->cached_head >= queue->capacity) {
+        // queue looks full, so refresh the consumer's index
+        queue->cached_head = atomic_load_explicit(&queue->head, memory_order_acquire);
+        if(tail - queue->cached_head >= queue->capacity) { // queue is full
+            return false;
+        }
+    }
+
+    queue->buffer[tail & (queue->capacity - 1)] = path;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// removes a path from the queue (consumer only)
+bool rtmc_path_spsc_dequeue(rtmc_path_spsc_t* queue, rtmc_path_t* path) {
+    if(!rtmc_path_spsc_peek(queue, path)) {
+        return false;
+    }
+
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+// copies the head of the queue without removing it (consumer only)
+bool rtmc_path_spsc_peek(rtmc_path_spsc_t* queue, rtmc_path_t* path) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    if(head == queue->cached_tail) {
+        // queue looks empty, so refresh the producer's index
+        queue->cached_tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+        if(head == queue->cached_tail) { // queue is empty
+            return false;
+        }
+    }
+
+    *path = queue->buffer[head & (queue->capacity - 1)];
+    return true;
+}
+
+// returns the number of paths in the queue (either side, though it may be
+// stale by the time it returns)
+size_t rtmc_path_spsc_size(rtmc_path_spsc_t* queue) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    return tail - head;
+}
+
+// removes all paths that have been enqueued so far (consumer only)
+void rtmc_flush_path_spsc(rtmc_path_spsc_t* queue) {
+    queue->cached_tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    atomic_store_explicit(&queue->head, queue->cached_tail, memory_order_release);
+}
@@ -0,0 +1,145 @@
+/*
+    path_stepper.c
+
+    Forward differences of p(s) = As^3 + Bs^2 + Cs + D with step h:
+        d1 = p(s + h) - p(s) = h(3As^2 + 3Ash + Ah^2 + 2Bs + Bh + C)
+        d2 = d1(s + h) - d1(s) = h^2(6As + 6Ah + 2B)
+        d3 = d2(s + h) - d2(s) = 6Ah^3 (constant)
+    so each step is p += d1, d1 += d2, d2 += d3.
+
+    For p(s) = A*sin(theta) + D with theta = B(s - C), each step adds
+    B*h to theta, which rotates (sin(theta), cos(theta)) by that angle:
+        sin(theta + B*h) = sin(theta)*cos(B*h) + cos(theta)*sin(B*h)
+        cos(theta + B*h) = cos(theta)*cos(B*h) - sin(theta)*sin(B*h)
+    Round-off slowly changes the length r of (sin, cos), so the radius is
+    off by A(r - 1), or about A(r^2 - 1)/2. When that's over the tolerance,
+    (sin, cos) is scaled by (3 - r^2)/2, a Newton step towards 1/r (exact
+    to second order, and without a square root). The angle's own round-off
+    is only around one ulp of the angle travelled, so trigonometric axes
+    are never re-anchored.
+*/
+
+#include <math.h>
+#include "rtmc_path.h"
+#include "rtmc_path_stepper.h"
+
+// returns the current s (computed fresh, so it doesn't drift)
+static double current_s(const rtmc_path_stepper_t* stepper) {
+    return stepper->s0 + (double)stepper->step*stepper->ds;
+}
+
+// evaluates the polynomial axes exactly at the current s
+static void anchor(rtmc_path_stepper_t* stepper) {
+    double s = current_s(stepper);
+    double h = stepper->ds;
+
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(stepper->trigonometric_axes & (1 << i)) {
+            continue;
+        }
+
+        double A = stepper->path.coefficients[i][0];
+        double B = stepper->path.coefficients[i][1];
+        double C = stepper->path.coefficients[i][2];
+        double D = stepper->path.coefficients[i][3];
+        stepper->value[i] = ((A*s + B)*s + C)*s + D;
+        stepper->differences[i][0] = h*(3*A*s*s + 3*A*s*h + A*h*h + 2*B*s + B*h + C);
+        stepper->differences[i][1] = h*h*(6*A*s + 6*A*h + 2*B);
+        stepper->differences[i][2] = 6*A*h*h*h;
+    }
+
+    stepper->steps_until_anchor = RTMC_PATH_STEPPER_ANCHOR_INTERVAL;
+}
+
+
+
+// evaluates the trigonometric axes' phases at s0, and their rotations
+static void init_phases(rtmc_path_stepper_t* stepper) {
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(!(stepper->trigonometric_axes & (1 << i))) {
+            continue;
+        }
+
+        double B = stepper->path.coefficients[i][1];
+        double C = stepper->path.coefficients[i][2];
+        stepper->phase[i][0] = sin(B*(stepper->s0 - C));
+        stepper->phase[i][1] = cos(B*(stepper->s0 - C));
+        stepper->rotation[i][0] = cos(B*stepper->ds);
+        stepper->rotation[i][1] = sin(B*stepper->ds);
+    }
+}
+
+void rtmc_path_stepper_init(rtmc_path_stepper_t* stepper, const rtmc_path_t* path, double s0, double ds) {
+    stepper->path = *path;
+    stepper->trigonometric_axes = 0;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(!rtmc_path_is_trigonometric_axis(path->type, i)) {
+            continue;
+        }
+
+        // a trigonometric axis that doesn't move is stepped as a constant
+        double* coefficients = stepper->path.coefficients[i];
+        if(coefficients[0] == 0) {
+            coefficients[1] = 0;
+            coefficients[2] = 0;
+        }
+        else {
+            stepper->trigonometric_axes |= (uint16_t)(1 << i);
+        }
+    }
+    stepper->s0 = s0;
+    stepper->ds = ds;
+    stepper->step = 0;
+    anchor(stepper);
+    init_phases(stepper);
+    rtmc_path_stepper_set_radius_tolerance(stepper, RTMC_PATH_STEPPER_RADIUS_TOLERANCE);
+}
+
+void rtmc_path_stepper_set_radius_tolerance(rtmc_path_stepper_t* stepper, double tolerance) {
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        double A = fabs(stepper->path.coefficients[i][0]);
+        stepper->max_drift[i] = (A > 0) ? 2*tolerance / A : INFINITY;
+    }
+}
+
+// rotates an axis's phase one step on (renormalizing it if needed)
+static void rotate_phase(rtmc_path_stepper_t* stepper, int axis) {
+    double* phase = stepper->phase[axis];
+    const double* rotation = stepper->rotation[axis];
+    double sine = phase[0]*rotation[0] + phase[1]*rotation[1];
+    double cosine = phase[1]*rotation[0] - phase[0]*rotation[1];
+
+    double drift = sine*sine + cosine*cosine - 1;
+    if(fabs(drift) > stepper->max_drift[axis]) {
+        double scale = 1 - drift/2;
+        sine *= scale;
+        cosine *= scale;
+    }
+
+    phase[0] = sine;
+    phase[1] = cosine;
+}
+
+void rtmc_path_stepper_next(rtmc_path_stepper_t* stepper, double* pose) {
+    if(stepper->steps_until_anchor == 0) {
+        anchor(stepper);
+    }
+
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(stepper->trigonometric_axes & (1 << i)) {
+            double A = stepper->path.coefficients[i][0];
+            double D = stepper->path.coefficients[i][3];
+            pose[i] = A*stepper->phase[i][0] + D;
+            rotate_phase(stepper, i);
+            continue;
+        }
+
+        pose[i] = stepper->value[i];
+        stepper->value[i] += stepper->differences[i][0];
+        stepper->differences[i][0] += stepper->differences[i][1];
+        stepper->differences[i][1] += stepper->differences[i][2];
+    }
+
+    stepper->step++;
+    stepper->steps_until_anchor--;
+}
@@ -0,0 +1,268 @@
+/*
+    trace.c
+
+    Every thread that hits a trace point claims its own ring buffer, so
+    recording an event is a couple of timestamp reads and one store, with
+    no locks or shared cache lines. Each ring's head counts every event
+    ever written; the buffer keeps the last `RTMC_TRACE_BUFFER_SIZE`.
+
+    A thread gives its ring back when it exits, and the next thread to
+    claim it carries on writing after the old events (so they're still
+    dumped). While every ring is claimed, other threads' events are
+    dropped and counted.
+*/
+
+#include <pthread.h>
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "rtmc_magic_numbers.h"
+#include "rtmc_trace.h"
+#include "trace.h"
+
+#ifdef RTMC_TRACE
+
+#define RING_MASK (RTMC_TRACE_BUFFER_SIZE - 1)
+_Static_assert((RTMC_TRACE_BUFFER_SIZE & RING_MASK) == 0, "trace buffer size must be a power of two");
+
+typedef struct {
+    uint64_t start; // timestamp (see `trace_timestamp()`)
+    uint32_t duration; // in timestamp ticks
+    uint16_t type; // trace_event_type_t
+    uint16_t reserved;
+} trace_event_t;
+
+typedef struct {
+    // true while a thread owns the ring
+    atomic_bool is_claimed;
+
+    // only written by the ring's thread (the dump reads it)
+    _Alignas(64) atomic_size_t head;
+
+    // first event that hasn't been cleared (written by `rtmc_trace_clear()`)
+    _Alignas(64) atomic_size_t tail;
+
+    trace_event_t events[RTMC_TRACE_BUFFER_SIZE];
+} trace_ring_t;
+
+static trace_ring_t rings[RTMC_TRACE_MAX_THREADS];
+
+// events recorded while every ring was claimed
+static atomic_size_t num_dropped = 0;
+
+static _Thread_local trace_ring_t* thread_ring = NULL;
+
+// releases a thread's ring when the thread exits
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+
+static const char* const event_names[NUM_TRACE_EVENTS] = {
+    [TRACE_PARSE] = "parse",
+    [TRACE_GENERATE_PATH] = "generate_path",
+    [TRACE_PATH_ENQUEUE] = "path_enqueue",
+    [TRACE_PATH_DEQUEUE] = "path_dequeue",
+    [TRACE_KINS_LOAD] = "rtmc_kins_scalar_load",
+    [TRACE_KINS_POSE] = "rtmc_kins_scalar_pose",
+    [TRACE_KINS_POSE_BATCH] = "rtmc_kins_scalar_pose_batch",
+};
+
+
+
+static uint64_t wall_clock_ns() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#if !defined(__x86_64__) && !defined(__i386__)
+uint64_t trace_timestamp() {
+    // note: a steady clock would be better, but C11 only has this one
+    return wall_clock_ns();
+}
+#endif
+
+// returns timestamp ticks per microsecond
+static double calibrate_timestamp() {
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t start_ns = wall_clock_ns();
+    uint64_t start_ticks = trace_timestamp();
+
+    // spin for 10 ms
+    uint64_t ns;
+    do {
+        ns = wall_clock_ns();
+    } while(ns - start_ns < 10000000u);
+
+    return (double)(trace_timestamp() - start_ticks) * 1000.0 / (double)(ns - start_ns);
+#else
+    return 1000.0;
+#endif
+}
+
+// runs on the exiting thread (as the `ring_key` destructor)
+static void release_ring(void* ring) {
+    thread_ring = NULL;
+    atomic_store_explicit(&((trace_ring_t*)ring)->is_claimed, false, memory_order_release);
+}
+
+static void create_ring_key() {
+    pthread_key_create(&ring_key, release_ring);
+}
+
+// returns NULL if every ring is claimed
+static trace_ring_t* claim_ring() {
+    for(int i = 0; i < RTMC_TRACE_MAX_THREADS; i++) {
+        trace_ring_t* ring = &rings[i];
+        bool is_claimed = atomic_load_explicit(&ring->is_claimed, memory_order_relaxed);
+
+        // acquire, so writes continue after the previous owner's last event
+        if(!is_claimed && atomic_compare_exchange_strong_explicit(
+            &ring->is_claimed, &is_claimed, true, memory_order_acquire, memory_order_relaxed
+        )) {
+            pthread_once(&ring_key_once, create_ring_key);
+            pthread_setspecific(ring_key, ring);
+            return ring;
+        }
+    }
+    return NULL;
+}
+
+void trace_record(trace_event_type_t type, uint64_t start) {
+    uint64_t end = trace_timestamp();
+
+    trace_ring_t* ring = thread_ring;
+    if(ring == NULL) {
+        // retried on every event, in case another thread has exited since
+        ring = thread_ring = claim_ring();
+        if(ring == NULL) {
+            atomic_fetch_add_explicit(&num_dropped, 1, memory_order_relaxed);
+            return;
+        }
+    }
+
+    uint64_t duration = end - start;
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    trace_event_t* event = &ring->events[head & RING_MASK];
+    event->start = start;
+    event->duration = (duration > UINT32_MAX) ? UINT32_MAX : (uint32_t)duration;
+    event->type = (uint16_t)type;
+
+    // publish the event
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+
+
+// finds the range of buffered events in a ring, as [*first, *last)
+static void ring_range(trace_ring_t* ring, size_t* first, size_t* last) {
+    *last = atomic_load_explicit(&ring->head, memory_order_acquire);
+    *first = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if(*last - *first > RTMC_TRACE_BUFFER_SIZE) {
+        *first = *last - RTMC_TRACE_BUFFER_SIZE;
+    }
+}
+
+bool rtmc_trace_is_enabled() {
+    return true;
+}
+
+size_t rtmc_trace_event_count() {
+    size_t count = 0;
+    for(int i = 0; i < RTMC_TRACE_MAX_THREADS; i++) {
+        size_t first, last;
+        ring_range(&rings[i], &first, &last);
+        count += last - first;
+    }
+    return count;
+}
+
+size_t rtmc_trace_dropped_count() {
+    return atomic_load_explicit(&num_dropped, memory_order_relaxed);
+}
+
+bool rtmc_trace_dump_chrome(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if(file == NULL) {
+        return false;
+    }
+
+    // timestamps are written relative to the earliest event
+    uint64_t origin = UINT64_MAX;
+    for(int i = 0; i < RTMC_TRACE_MAX_THREADS; i++) {
+        size_t first, last;
+        ring_range(&rings[i], &first, &last);
+        for(size_t j = first; j < last; j++) {
+            uint64_t start = rings[i].events[j & RING_MASK].start;
+            origin = (start < origin) ? start : origin;
+        }
+    }
+
+    double ticks_per_us = calibrate_timestamp();
+
+    fprintf(file, "{\"traceEvents\":[");
+    bool is_first_event = true;
+    for(int i = 0; i < RTMC_TRACE_MAX_THREADS; i++) {
+        size_t first, last;
+        ring_range(&rings[i], &first, &last);
+        for(size_t j = first; j < last; j++) {
+            const trace_event_t* event = &rings[i].events[j & RING_MASK];
+            if(event->type >= NUM_TRACE_EVENTS) {
+                continue;
+            }
+
+            fprintf(
+                file,
+                "%s\n{\"name\":\"%s\",\"cat\":\"rtmc\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                is_first_event ? "" : ",",
+                event_names[event->type],
+                (double)(event->start - origin) / ticks_per_us,
+                (double)event->duration / ticks_per_us,
+                i
+            );
+            is_first_event = false;
+        }
+    }
+    fprintf(
+        file,
+        "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":%zu}}\n",
+        rtmc_trace_dropped_count()
+    );
+
+    bool is_written = !ferror(file);
+    return (fclose(file) == 0) && is_written;
+}
+
+void rtmc_trace_clear() {
+    for(int i = 0; i < RTMC_TRACE_MAX_THREADS; i++) {
+        size_t head = atomic_load_explicit(&rings[i].head, memory_order_acquire);
+        atomic_store_explicit(&rings[i].tail, head, memory_order_relaxed);
+    }
+    atomic_store_explicit(&num_dropped, 0, memory_order_relaxed);
+}
+
+#else // without `RTMC_TRACE`, nothing is ever recorded
+
+bool rtmc_trace_is_enabled() {
+    return false;
+}
+
+size_t rtmc_trace_event_count() {
+    return 0;
+}
+
+size_t rtmc_trace_dropped_count() {
+    return 0;
+}
+
+bool rtmc_trace_dump_chrome(const char* filename) {
+    (void)filename;
+    return false;
+}
+
+void rtmc_trace_clear() {}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+    trace.h
+
+    THIS IS NOT A PUBLIC INTERFACE AND SHOULD NOT BE INCLUDED ANYWHERE
+    EXCEPT FOR THE LIBRARY'S OWN SOURCE FILES
+
+    Trace points (see `rtmc_trace.h`). Put `TRACE_BEGIN()` at the start of
+    a function and `TRACE_END(event)` before it returns. Without
+    `RTMC_TRACE`, both expand to nothing.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+
+
+#include <stdint.h>
+
+typedef enum {
+    TRACE_PARSE,
+    TRACE_GENERATE_PATH,
+    TRACE_PATH_ENQUEUE,
+    TRACE_PATH_DEQUEUE,
+    TRACE_KINS_LOAD,
+    TRACE_KINS_POSE,
+    TRACE_KINS_POSE_BATCH,
+    NUM_TRACE_EVENTS
+} trace_event_type_t;
+
+#ifdef RTMC_TRACE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t trace_timestamp() {
+    return __rdtsc();
+}
+#else
+uint64_t trace_timestamp();
+#endif
+
+// records an event that started at `start` and ends now
+void trace_record(trace_event_type_t type, uint64_t start);
+
+#define TRACE_BEGIN() uint64_t trace_start = trace_timestamp()
+#define TRACE_END(type) trace_record((type), trace_start)
+
+#else
+
+#define TRACE_BEGIN()
+#define TRACE_END(type)
+
+#endif
+
+
+
+#endif // TRACE_H
@@ -0,0 +1,207 @@
+/*
+    These tests replace the C library's `malloc()` family to count every
+    heap operation made by the calling thread, so they run in their own
+    executable (glibc only).
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <gtest/gtest.h>
+#include "rtmc_alloc.h"
+#include "rtmc_kins_scalar.h"
+#include "rtmc_magic_numbers.h"
+#include "rtmc_math.h"
+#include "rtmc_parser.h"
+#include "rtmc_path.h"
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+}
+
+// heap operations on this thread while counting is on
+static __thread bool is_counting = false;
+static __thread size_t heap_operations = 0;
+
+extern "C" {
+void* malloc(size_t size) {
+    if(is_counting)
+        heap_operations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    if(is_counting)
+        heap_operations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    if(is_counting)
+        heap_operations++;
+    return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) {
+    if(is_counting && pointer)
+        heap_operations++;
+    __libc_free(pointer);
+}
+}
+
+static void start_counting() {
+    heap_operations = 0;
+    is_counting = true;
+}
+
+static size_t stop_counting() {
+    is_counting = false;
+    return heap_operations;
+}
+
+static rtmc_path_t make_arc() {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_TRIGONOMETRIC;
+    path.feed_rate = 100;
+    path.coefficients[RTMC_X_AXIS][0] = 10;
+    path.coefficients[RTMC_X_AXIS][1] = RTMC_PI / 2;
+    path.coefficients[RTMC_X_AXIS][2] = -1;
+    path.coefficients[RTMC_Y_AXIS][0] = 10;
+    path.coefficients[RTMC_Y_AXIS][1] = RTMC_PI / 2;
+    return path;
+}
+
+
+
+TEST(AllocTests, InterpositionWorks) {
+    // make sure the counters actually see the library's allocations
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    start_counting();
+    rtmc_path_enqueue(&queue, make_arc());
+    EXPECT_GT(stop_counting(), 0);
+    rtmc_flush_path_queue(&queue);
+}
+
+TEST(AllocTests, KinsPoseDoesntAllocate) {
+    double scale_factors[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_NUM_AXES; i++)
+        scale_factors[i] = 1000;
+    rtmc_kins_scalar_setup(scale_factors);
+
+    double pose[RTMC_NUM_AXES];
+    start_counting();
+    rtmc_kins_scalar_load(make_arc());
+    for(int i = 0; i <= 100000; i++) {
+        rtmc_kins_scalar_pose(pose, i / 100000.0);
+    }
+    EXPECT_EQ(stop_counting(), 0);
+}
+
+TEST(AllocTests, DequeueDoesntAllocate) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    for(int i = 0; i < 1000; i++)
+        rtmc_path_enqueue(&queue, make_arc());
+
+    // draining the queue keeps every chunk for reuse
+    start_counting();
+    while(rtmc_path_queue_front(&queue)) {
+        rtmc_path_t path = rtmc_path_queue_peek(&queue);
+        EXPECT_EQ(path.feed_rate, 100);
+        rtmc_path_dequeue(&queue);
+    }
+    rtmc_path_dequeue(&queue); // empty
+    EXPECT_EQ(stop_counting(), 0);
+
+    // so once warmed up, a queue of the same size never allocates
+    start_counting();
+    for(int round = 0; round < 10; round++) {
+        for(int i = 0; i < 1000; i++)
+            rtmc_path_enqueue(&queue, make_arc());
+        for(int i = 0; i < 1000; i++)
+            rtmc_path_queue_release(&queue);
+    }
+    EXPECT_EQ(stop_counting(), 0);
+
+    rtmc_flush_path_queue(&queue);
+}
+
+TEST(AllocTests, RtSection) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_path_enqueue(&queue, make_arc());
+    rtmc_path_dequeue(&queue);
+
+    // reusing a chunk is fine
+    EXPECT_FALSE(rtmc_is_in_rt_section());
+    rtmc_enter_rt_section();
+    rtmc_enter_rt_section();
+    EXPECT_TRUE(rtmc_is_in_rt_section());
+    rtmc_path_enqueue(&queue, make_arc());
+    rtmc_path_dequeue(&queue);
+    rtmc_exit_rt_section();
+    EXPECT_TRUE(rtmc_is_in_rt_section());
+    rtmc_exit_rt_section();
+    EXPECT_FALSE(rtmc_is_in_rt_section());
+
+    // needing a new chunk (or freeing one) is fatal
+    EXPECT_DEATH({
+        rtmc_path_queue_t empty_queue = rtmc_create_path_queue();
+        rtmc_enter_rt_section();
+        rtmc_path_enqueue(&empty_queue, make_arc());
+    }, "allocation of [0-9]+ bytes inside a real-time section");
+    EXPECT_DEATH({
+        rtmc_enter_rt_section();
+        rtmc_flush_path_queue(&queue);
+    }, "free of 0 bytes inside a real-time section");
+
+    rtmc_flush_path_queue(&queue);
+}
+
+
+
+// counts what goes through a custom allocator
+struct allocator_counts {
+    int allocations;
+    int frees;
+};
+
+static void* counting_allocate(size_t size, void* user_data) {
+    ((allocator_counts*)user_data)->allocations++;
+    return __libc_malloc(size);
+}
+
+static void* counting_reallocate(void* pointer, size_t size, void* user_data) {
+    if(pointer == NULL)
+        ((allocator_counts*)user_data)->allocations++;
+    return __libc_realloc(pointer, size);
+}
+
+static void counting_deallocate(void* pointer, void* user_data) {
+    ((allocator_counts*)user_data)->frees++;
+    __libc_free(pointer);
+}
+
+TEST(AllocTests, CustomAllocator) {
+    allocator_counts counts = {0, 0};
+    rtmc_allocator_t allocator = {
+        counting_allocate, counting_reallocate, counting_deallocate, &counts
+    };
+    rtmc_set_allocator(&allocator);
+
+    // nothing reaches the C library's allocator
+    start_counting();
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    const char program[] = "G01 F100 X10\nX20\nX30\n";
+    rtmc_parse_buffer(parser, &queue, program, sizeof(program) - 1, NULL, 0);
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+    EXPECT_EQ(stop_counting(), 0);
+
+    EXPECT_EQ(counts.allocations, 2); // the parser and one chunk
+    EXPECT_EQ(counts.frees, counts.allocations);
+
+    rtmc_set_allocator(NULL);
+}
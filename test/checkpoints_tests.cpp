@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <gtest/gtest.h>
+#include "rtmc_checkpoints.h"
+#include "rtmc_parser.h"
+#include "rtmc_path.h"
+
+// returns a file name that's unique to the current test (tests can run in
+// parallel, so they can't share one)
+static std::string temp_filename() {
+    return testing::TempDir() + "checkpoints_tests_"
+        + testing::UnitTest::GetInstance()->current_test_info()->name() + ".ckpt";
+}
+
+// a program whose modal state keeps changing
+static std::string make_program(int num_lines) {
+    std::string program;
+    for(int i = 0; i < num_lines; i++) {
+        if(i % 7 == 0)
+            program += "G01 F" + std::to_string(100 + i % 50) + "\n";
+        else if(i % 11 == 0)
+            program += (i % 2) ? "G91\n" : "G90\r\n";
+        else if(i % 13 == 0)
+            program += "G00 Z" + std::to_string(i % 5) + "\n";
+        else
+            program += "X" + std::to_string(i % 17) + " Y" + std::to_string(i % 23) + "\n";
+    }
+    return program;
+}
+
+// the paths from resuming at `line` after parsing everything before it
+static rtmc_path_queue_t resume_slowly(const std::string& program, size_t offset) {
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    rtmc_parse_buffer(parser, &queue, program.data(), offset, NULL, 0);
+    rtmc_flush_path_queue(&queue);
+    rtmc_parse_buffer(parser, &queue, program.data() + offset, program.size() - offset, NULL, 0);
+
+    rtmc_destroy_parser(parser);
+    return queue;
+}
+
+static void expect_same_paths(rtmc_path_queue_t* q1, rtmc_path_queue_t* q2) {
+    const rtmc_path_t* p1;
+    while((p1 = rtmc_path_queue_front(q1))) {
+        const rtmc_path_t* p2 = rtmc_path_queue_front(q2);
+        ASSERT_TRUE(p2);
+        ASSERT_EQ(p1->type, p2->type);
+        ASSERT_EQ(p1->feed_rate, p2->feed_rate);
+        ASSERT_EQ(memcmp(p1->coefficients, p2->coefficients, sizeof(p1->coefficients)), 0);
+        rtmc_path_queue_release(q1);
+        rtmc_path_queue_release(q2);
+    }
+    EXPECT_FALSE(rtmc_path_queue_front(q2));
+}
+
+// resumes the program at `line` using checkpoints
+static void expect_resumes(const rtmc_checkpoints_t* checkpoints, const std::string& program, size_t line) {
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    size_t offset;
+    ASSERT_TRUE(rtmc_restore_checkpoint(checkpoints, parser, program.data(), program.size(), line, &offset));
+    rtmc_parse_buffer(parser, &queue, program.data() + offset, program.size() - offset, NULL, 0);
+
+    rtmc_path_queue_t expected = resume_slowly(program, offset);
+    expect_same_paths(&queue, &expected);
+
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+    rtmc_flush_path_queue(&expected);
+}
+
+TEST(CheckpointsTests, Interval) {
+    std::string program = make_program(1000);
+    rtmc_checkpoints_t* checkpoints = rtmc_create_checkpoints(100);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    // one checkpoint before lines 1, 101, ..., 901
+    rtmc_set_parser_checkpoints(parser, checkpoints);
+    rtmc_parse_buffer(parser, &queue, program.data(), program.size(), NULL, 0);
+    EXPECT_EQ(rtmc_checkpoint_count(checkpoints), 10);
+
+    // parsing again replaces them
+    rtmc_flush_parser_data_ctx(parser);
+    rtmc_parse_buffer(parser, &queue, program.data(), program.size(), NULL, 0);
+    EXPECT_EQ(rtmc_checkpoint_count(checkpoints), 10);
+
+    EXPECT_FALSE(rtmc_create_checkpoints(0));
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_checkpoints(checkpoints);
+    rtmc_flush_path_queue(&queue);
+}
+
+TEST(CheckpointsTests, Restore) {
+    std::string program = make_program(5000);
+    rtmc_checkpoints_t* checkpoints = rtmc_create_checkpoints(64);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    rtmc_set_parser_checkpoints(parser, checkpoints);
+    rtmc_parse_buffer(parser, &queue, program.data(), program.size(), NULL, 0);
+
+    // on, just after, and just before checkpoints
+    for(size_t line : {1, 2, 64, 65, 66, 1000, 2401, 4999, 5000}) {
+        SCOPED_TRACE(line);
+        expect_resumes(checkpoints, program, line);
+    }
+
+    // past the end of the program
+    size_t offset;
+    EXPECT_FALSE(rtmc_restore_checkpoint(checkpoints, parser, program.data(), program.size(), 5001, &offset));
+    EXPECT_FALSE(rtmc_restore_checkpoint(checkpoints, parser, program.data(), program.size(), 0, &offset));
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_checkpoints(checkpoints);
+    rtmc_flush_path_queue(&queue);
+}
+
+TEST(CheckpointsTests, RestoreTwiceWithSameParser) {
+    std::string program = make_program(5000);
+    rtmc_checkpoints_t* checkpoints = rtmc_create_checkpoints(100);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    rtmc_set_parser_checkpoints(parser, checkpoints);
+    rtmc_parse_buffer(parser, &queue, program.data(), program.size(), NULL, 0);
+    rtmc_flush_path_queue(&queue);
+    EXPECT_EQ(rtmc_checkpoint_count(checkpoints), 50);
+
+    // resuming the program doesn't touch the checkpoints it's restored from
+    for(size_t line : {2400, 4500}) {
+        SCOPED_TRACE(line);
+        size_t offset;
+        ASSERT_TRUE(rtmc_restore_checkpoint(checkpoints, parser, program.data(), program.size(), line, &offset));
+        rtmc_parse_buffer(parser, &queue, program.data() + offset, program.size() - offset, NULL, 0);
+        EXPECT_EQ(rtmc_checkpoint_count(checkpoints), 50);
+
+        rtmc_path_queue_t expected = resume_slowly(program, offset);
+        expect_same_paths(&queue, &expected);
+        rtmc_flush_path_queue(&queue);
+        rtmc_flush_path_queue(&expected);
+
+        // the offset matches the program's line
+        size_t line_start = 0;
+        for(size_t i = 1; i < line; i++)
+            line_start = program.find('\n', line_start) + 1;
+        EXPECT_EQ(offset, line_start);
+    }
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_checkpoints(checkpoints);
+}
+
+TEST(CheckpointsTests, RestoreAfterParallelParse) {
+    std::string program = make_program(50000);
+    rtmc_checkpoints_t* checkpoints = rtmc_create_checkpoints(1000);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    rtmc_parse_pool_t* pool = rtmc_create_parse_pool(4);
+    rtmc_set_parser_checkpoints(parser, checkpoints);
+    rtmc_parse_buffer_parallel(parser, &queue, program.data(), program.size(), NULL, 0, pool);
+    rtmc_destroy_parse_pool(pool);
+    EXPECT_EQ(rtmc_checkpoint_count(checkpoints), 50);
+
+    for(size_t line : {1, 12345, 40001}) {
+        SCOPED_TRACE(line);
+        expect_resumes(checkpoints, program, line);
+    }
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_checkpoints(checkpoints);
+    rtmc_flush_path_queue(&queue);
+}
+
+TEST(CheckpointsTests, SaveAndLoad) {
+    std::string program = make_program(2000);
+    rtmc_checkpoints_t* checkpoints = rtmc_create_checkpoints(100);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    rtmc_set_parser_checkpoints(parser, checkpoints);
+    rtmc_parse_buffer(parser, &queue, program.data(), program.size(), NULL, 0);
+
+    std::string filename = temp_filename();
+    ASSERT_TRUE(rtmc_save_checkpoints(checkpoints, filename.c_str()));
+    rtmc_checkpoints_t* loaded = rtmc_load_checkpoints(filename.c_str());
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(rtmc_checkpoint_count(loaded), rtmc_checkpoint_count(checkpoints));
+    expect_resumes(loaded, program, 1550);
+
+    // anything else is rejected
+    FILE* file = fopen(filename.c_str(), "wb");
+    fputs("not a checkpoint file", file);
+    fclose(file);
+    EXPECT_FALSE(rtmc_load_checkpoints(filename.c_str()));
+    EXPECT_FALSE(rtmc_load_checkpoints((filename + ".missing").c_str()));
+    remove(filename.c_str());
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_checkpoints(checkpoints);
+    rtmc_destroy_checkpoints(loaded);
+    rtmc_flush_path_queue(&queue);
+}
@@ -0,0 +1,310 @@
+#include <math.h>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "rtmc_interpolator.h"
+#include "rtmc_kins_scalar.h"
+#include "rtmc_parser.h"
+#include "rtmc_path.h"
+
+static const double tick = 0.001;
+
+static rtmc_interpolator_config_t make_config(size_t look_ahead, double max_velocity, double max_acceleration) {
+    double scale_factors[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_NUM_AXES; i++)
+        scale_factors[i] = 1;
+    rtmc_kins_scalar_setup(scale_factors);
+
+    rtmc_interpolator_config_t config;
+    config.tick = tick;
+    config.look_ahead = look_ahead;
+    config.profile = RTMC_PROFILE_TRAPEZOIDAL;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        config.max_velocity[i] = max_velocity;
+        config.max_acceleration[i] = max_acceleration;
+        config.max_jerk[i] = 0;
+    }
+    config.load = rtmc_kins_scalar_load;
+    config.pose = rtmc_kins_scalar_pose;
+    return config;
+}
+
+static rtmc_interpolator_config_t make_s_curve_config(size_t look_ahead, double max_velocity, double max_acceleration, double max_jerk) {
+    rtmc_interpolator_config_t config = make_config(look_ahead, max_velocity, max_acceleration);
+    config.profile = RTMC_PROFILE_S_CURVE;
+    for(int i = 0; i < RTMC_NUM_AXES; i++)
+        config.max_jerk[i] = max_jerk;
+    return config;
+}
+
+// the poses of every tick, plus the largest per-axis speed, acceleration,
+// and jerk
+typedef struct {
+    std::vector<std::vector<double>> poses;
+    double max_velocity;
+    double max_acceleration;
+    double max_jerk;
+} motion_t;
+
+static motion_t run(const std::string& program, const rtmc_interpolator_config_t& config) {
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    EXPECT_EQ(rtmc_parse_buffer(parser, &queue, program.data(), program.size(), NULL, 0), 0);
+    rtmc_destroy_parser(parser);
+
+    rtmc_interpolator_t* interpolator = rtmc_create_interpolator(&config);
+    EXPECT_TRUE(interpolator);
+
+    motion_t motion;
+    motion.poses.push_back(std::vector<double>(RTMC_NUM_AXES, 0));
+    std::vector<double> pose(RTMC_NUM_AXES);
+    while(rtmc_interpolator_tick(interpolator, &queue, pose.data()))
+        motion.poses.push_back(pose);
+    rtmc_destroy_interpolator(interpolator);
+    rtmc_flush_path_queue(&queue);
+
+    // finite differences (the motion starts and ends at rest)
+    motion.max_velocity = 0;
+    motion.max_acceleration = 0;
+    motion.max_jerk = 0;
+    std::vector<double> previous_velocity(RTMC_NUM_AXES, 0);
+    std::vector<double> previous_acceleration(RTMC_NUM_AXES, 0);
+    for(size_t k = 1; k <= motion.poses.size(); k++) {
+        for(int i = 0; i < RTMC_NUM_AXES; i++) {
+            double velocity = 0;
+            if(k < motion.poses.size())
+                velocity = (motion.poses[k][i] - motion.poses[k - 1][i]) / tick;
+            double acceleration = (velocity - previous_velocity[i]) / tick;
+            motion.max_velocity = fmax(motion.max_velocity, fabs(velocity));
+            motion.max_acceleration = fmax(motion.max_acceleration, fabs(acceleration));
+            motion.max_jerk = fmax(motion.max_jerk, fabs(acceleration - previous_acceleration[i]) / tick);
+            previous_velocity[i] = velocity;
+            previous_acceleration[i] = acceleration;
+        }
+    }
+
+    return motion;
+}
+
+TEST(InterpolatorTests, InvalidConfig) {
+    rtmc_interpolator_config_t config = make_config(8, 1, 1);
+    config.tick = 0;
+    EXPECT_FALSE(rtmc_create_interpolator(&config));
+
+    config = make_config(0, 1, 1);
+    EXPECT_FALSE(rtmc_create_interpolator(&config));
+
+    config = make_config(8, 1, 1);
+    config.max_acceleration[RTMC_Z_AXIS] = 0;
+    EXPECT_FALSE(rtmc_create_interpolator(&config));
+
+    config = make_s_curve_config(8, 1, 1, 1);
+    config.max_jerk[RTMC_X_AXIS] = 0;
+    EXPECT_FALSE(rtmc_create_interpolator(&config));
+
+    config = make_config(8, 1, 1);
+    config.pose = NULL;
+    EXPECT_FALSE(rtmc_create_interpolator(&config));
+}
+
+TEST(InterpolatorTests, IdleWithoutPaths) {
+    rtmc_interpolator_config_t config = make_config(8, 1, 1);
+    rtmc_interpolator_t* interpolator = rtmc_create_interpolator(&config);
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    double pose[RTMC_NUM_AXES] = {42};
+    EXPECT_FALSE(rtmc_interpolator_tick(interpolator, &queue, pose));
+    EXPECT_EQ(pose[0], 42);
+    EXPECT_EQ(rtmc_interpolator_velocity(interpolator), 0);
+
+    rtmc_destroy_interpolator(interpolator);
+}
+
+TEST(InterpolatorTests, TrapezoidalLine) {
+    // 0.25 s to reach 0.5 m/s, 1.75 s of cruising, and 0.25 s to stop
+    motion_t motion = run("G17 G01 F0.5\nG01 X1 Y0\n", make_config(8, 1, 2));
+
+    EXPECT_NEAR(motion.poses.size() - 1, 2250, 1);
+    EXPECT_DOUBLE_EQ(motion.poses.back()[RTMC_X_AXIS], 1);
+    EXPECT_DOUBLE_EQ(motion.poses.back()[RTMC_Y_AXIS], 0);
+    EXPECT_LE(motion.max_velocity, 0.5 + 1e-9);
+    EXPECT_LE(motion.max_acceleration, 2 * 1.001);
+}
+
+TEST(InterpolatorTests, AxisLimits) {
+    // X is limited to 0.1 m/s (rapids have no feed rate limit)
+    rtmc_interpolator_config_t config = make_config(8, 1, 2);
+    config.max_velocity[RTMC_X_AXIS] = 0.1;
+    motion_t motion = run("G00 X1\n", config);
+
+    EXPECT_DOUBLE_EQ(motion.poses.back()[RTMC_X_AXIS], 1);
+    EXPECT_LE(motion.max_velocity, 0.1 + 1e-9);
+    EXPECT_NEAR(motion.poses.size() - 1, 10050, 2);
+}
+
+TEST(InterpolatorTests, LookAheadCarriesSpeed) {
+    // 100 collinear 1 cm paths, like CAM output
+    std::string program = "G17 G01 F0.5\n";
+    for(int i = 1; i <= 100; i++)
+        program += "G01 X" + std::to_string(i * 0.01) + "\n";
+
+    motion_t stop_and_go = run(program, make_config(1, 1, 2));
+    motion_t blended = run(program, make_config(32, 1, 2));
+
+    EXPECT_NEAR(stop_and_go.poses.back()[RTMC_X_AXIS], 1, 1e-12);
+    EXPECT_NEAR(blended.poses.back()[RTMC_X_AXIS], 1, 1e-12);
+
+    // without look-ahead, each path stops (never reaching 0.5 m/s)
+    EXPECT_LT(stop_and_go.max_velocity, 0.2);
+
+    // with it, the whole run is one trapezoid
+    EXPECT_NEAR(blended.max_velocity, 0.5, 1e-6);
+    EXPECT_NEAR(blended.poses.size() - 1, 2250, 2);
+    EXPECT_LE(blended.max_acceleration, 2 * 1.001);
+}
+
+TEST(InterpolatorTests, CornerSlowsDown) {
+    motion_t motion = run("G17 G01 F0.5\nG01 X0.5\nG01 Y0.5\n", make_config(8, 1, 2));
+
+    EXPECT_DOUBLE_EQ(motion.poses.back()[RTMC_X_AXIS], 0.5);
+    EXPECT_DOUBLE_EQ(motion.poses.back()[RTMC_Y_AXIS], 0.5);
+
+    EXPECT_LE(motion.max_acceleration, 2 * 1.001);
+
+    // find the tick nearest the corner; both axes are (almost) still there
+    size_t corner = 0;
+    for(size_t k = 0; k < motion.poses.size(); k++) {
+        if(motion.poses[k][RTMC_X_AXIS] >= 0.5 - 1e-12) {
+            corner = k;
+            break;
+        }
+    }
+    // (a right angle can only be taken at 1 mm/s, so it's taken from rest)
+    double speed = fabs(motion.poses[corner + 1][RTMC_Y_AXIS] - motion.poses[corner][RTMC_Y_AXIS]) / tick;
+    EXPECT_LT(speed, 0.01);
+
+    motion_t s_curve = run("G17 G01 F0.5\nG01 X0.5\nG01 Y0.5\n", make_s_curve_config(8, 1, 2, 20));
+    EXPECT_DOUBLE_EQ(s_curve.poses.back()[RTMC_Y_AXIS], 0.5);
+    EXPECT_LE(s_curve.max_acceleration, 2 * 1.001);
+    EXPECT_LE(s_curve.max_jerk, 20 * 1.01);
+}
+
+TEST(InterpolatorTests, ShallowCornersCarrySpeed) {
+    // a circle of radius 0.1 m as 1000 lines, turning 0.36 degrees at each
+    std::string program = "G17 G01 F0.5\n";
+    for(int i = 1; i <= 1000; i++) {
+        double angle = 2 * M_PI * i / 1000;
+        program += "G01 X" + std::to_string(0.1 * sin(angle)) + " Y" + std::to_string(0.1 - 0.1 * cos(angle)) + "\n";
+    }
+
+    motion_t stop_and_go = run(program, make_config(1, 1, 2));
+    motion_t blended = run(program, make_config(32, 1, 2));
+
+    EXPECT_NEAR(blended.poses.back()[RTMC_X_AXIS], stop_and_go.poses.back()[RTMC_X_AXIS], 1e-12);
+    EXPECT_NEAR(blended.poses.back()[RTMC_Y_AXIS], stop_and_go.poses.back()[RTMC_Y_AXIS], 1e-12);
+    EXPECT_GT(blended.max_velocity, 2 * stop_and_go.max_velocity);
+    EXPECT_LT(blended.poses.size(), stop_and_go.poses.size() / 2);
+    EXPECT_LE(blended.max_acceleration, 2 * 1.001);
+
+    // the jerk of each corner (a velocity step within one tick) keeps
+    // S-curves much slower
+    motion_t s_curve = run(program, make_s_curve_config(32, 1, 2, 100));
+    EXPECT_NEAR(s_curve.poses.back()[RTMC_X_AXIS], stop_and_go.poses.back()[RTMC_X_AXIS], 1e-12);
+    EXPECT_LE(s_curve.max_acceleration, 2 * 1.001);
+    EXPECT_LE(s_curve.max_jerk, 100 * 1.01);
+}
+
+TEST(InterpolatorTests, ArcWithinLimits) {
+    // half circle of radius 0.5 m (centripetal acceleration would be
+    // 0.5 m/s^2 at the programmed feed rate)
+    motion_t motion = run("G17 G02 X1 Y0 I0.5 J0 F0.5\n", make_config(8, 1, 0.25));
+
+    EXPECT_NEAR(motion.poses.back()[RTMC_X_AXIS], 1, 1e-9);
+    EXPECT_NEAR(motion.poses.back()[RTMC_Y_AXIS], 0, 1e-9);
+    EXPECT_LE(motion.max_acceleration, 0.25 * 1.01);
+    EXPECT_LE(motion.max_velocity, 0.5);
+}
+
+TEST(InterpolatorTests, SCurveLine) {
+    // each ramp takes 0.35 s (0.1 s of jerk on either side of 0.15 s at
+    // 2 m/s^2) and covers 8.75 cm, leaving 1.65 s of cruising
+    motion_t motion = run("G17 G01 F0.5\nG01 X1\n", make_s_curve_config(8, 1, 2, 20));
+
+    EXPECT_NEAR(motion.poses.size() - 1, 2350, 1);
+    EXPECT_DOUBLE_EQ(motion.poses.back()[RTMC_X_AXIS], 1);
+    EXPECT_LE(motion.max_velocity, 0.5 + 1e-9);
+    EXPECT_LE(motion.max_acceleration, 2 * 1.001);
+    EXPECT_LE(motion.max_jerk, 20 * 1.01);
+}
+
+TEST(InterpolatorTests, SCurveShortPaths) {
+    // too short to reach full acceleration or speed
+    motion_t motion = run("G17 G01 F0.5\nG01 X0.001\nG01 X0.03\n", make_s_curve_config(8, 1, 2, 20));
+
+    EXPECT_DOUBLE_EQ(motion.poses.back()[RTMC_X_AXIS], 0.03);
+    EXPECT_LE(motion.max_acceleration, 2 * 1.001);
+    EXPECT_LE(motion.max_jerk, 20 * 1.01);
+}
+
+TEST(InterpolatorTests, SCurveLookAhead) {
+    // the acceleration is zero at every junction, so collinear paths blend
+    // into the same profile as a single path
+    std::string program = "G17 G01 F0.5\n";
+    for(int i = 1; i <= 100; i++)
+        program += "G01 X" + std::to_string(i * 0.01) + "\n";
+    motion_t motion = run(program, make_s_curve_config(32, 1, 2, 20));
+
+    EXPECT_NEAR(motion.poses.back()[RTMC_X_AXIS], 1, 1e-12);
+    EXPECT_NEAR(motion.poses.size() - 1, 2350, 2);
+    EXPECT_LE(motion.max_acceleration, 2 * 1.001);
+    EXPECT_LE(motion.max_jerk, 20 * 1.01);
+}
+
+TEST(InterpolatorTests, SCurveBeatsDeratedTrapezoid) {
+    // a short-segment contour, run with S-curves at the full acceleration
+    // and with trapezoids derated by 40%
+    std::string program = "G17 G01 F0.5\n";
+    for(int i = 1; i <= 50; i++)
+        program += "G01 X" + std::to_string(i * 0.004) + " Y" + std::to_string((i % 2) * 0.0004) + "\n";
+
+    motion_t s_curve = run(program, make_s_curve_config(32, 1, 2, 100));
+    motion_t derated = run(program, make_config(32, 1, 2 * 0.6));
+
+    EXPECT_LT(s_curve.poses.size(), derated.poses.size());
+    EXPECT_LE(s_curve.max_acceleration, 2 * 1.001);
+    EXPECT_LE(s_curve.max_jerk, 100 * 1.01);
+    EXPECT_LE(derated.max_acceleration, 2 * 0.6 * 1.001);
+}
+
+// returns the lowest X speed once the motion is `margin` from either end
+static double min_inner_speed(const motion_t& motion, double margin) {
+    double start = motion.poses.front()[RTMC_X_AXIS];
+    double end = motion.poses.back()[RTMC_X_AXIS];
+    double speed = INFINITY;
+    for(size_t k = 1; k < motion.poses.size(); k++) {
+        double x = motion.poses[k][RTMC_X_AXIS];
+        if(x > start + margin && x < end - margin)
+            speed = fmin(speed, (x - motion.poses[k - 1][RTMC_X_AXIS]) / tick);
+    }
+    return speed;
+}
+
+TEST(InterpolatorTests, ShortWindowKeepsMoving) {
+    // 1 mm paths with an 8 mm window, which is too short to ever cruise
+    // (stopping within the window caps the speed at about 0.18 m/s)
+    std::string program = "G17 G01 F0.5\n";
+    for(int i = 1; i <= 200; i++)
+        program += "G01 X" + std::to_string(i * 0.001) + "\n";
+
+    motion_t trapezoidal = run(program, make_config(8, 1, 2));
+    EXPECT_NEAR(trapezoidal.poses.back()[RTMC_X_AXIS], 0.2, 1e-12);
+    EXPECT_GT(min_inner_speed(trapezoidal, 0.01), 0.1);
+    EXPECT_LE(trapezoidal.max_velocity, 0.18);
+    EXPECT_LE(trapezoidal.max_acceleration, 2 * 1.001);
+
+    motion_t s_curve = run(program, make_s_curve_config(8, 1, 2, 20));
+    EXPECT_NEAR(s_curve.poses.back()[RTMC_X_AXIS], 0.2, 1e-12);
+    EXPECT_GT(min_inner_speed(s_curve, 0.01), 0.05);
+    EXPECT_LE(s_curve.max_acceleration, 2 * 1.001);
+    EXPECT_LE(s_curve.max_jerk, 20 * 1.01);
+}
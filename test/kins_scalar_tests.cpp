@@ -1,3 +1,6 @@
+#include <math.h>
+#include <string.h>
+#include <vector>
 #include <gtest/gtest.h>
 #include "rtmc_kins_scalar.h"
 #include "rtmc_math.h"
@@ -31,3 +34,150 @@ TEST(KinsScalarTests, TestName) {
     rtmc_kins_scalar_pose(pose, 1);
     EXPECT_TRUE(rtmc_is_equal(pose[RTMC_X_AXIS], -200));
 }
+
+TEST(KinsScalarTests, IdleAxes) {
+    rtmc_path_t path;
+    path.type = RTMC_PATH_TYPE_POLYNOMIAL;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        path.coefficients[i][0] = 0;
+        path.coefficients[i][1] = 0;
+        path.coefficients[i][2] = 0;
+        path.coefficients[i][3] = i;
+    }
+    path.coefficients[RTMC_Y_AXIS][2] = 10;
+
+    double scale_factors[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        scale_factors[i] = 2;
+    }
+
+    rtmc_kins_scalar_setup(scale_factors);
+    rtmc_kins_scalar_load(path);
+
+    // idle axes hold their (scaled) position, active axes move
+    double pose[RTMC_NUM_AXES];
+    rtmc_kins_scalar_pose(pose, 0.5);
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        if(i == RTMC_Y_AXIS) {
+            EXPECT_TRUE(rtmc_is_equal(pose[i], 2 * (i + 5)));
+        }
+        else {
+            EXPECT_TRUE(rtmc_is_equal(pose[i], 2 * i));
+        }
+    }
+}
+
+
+
+static const rtmc_kins_batch_kernel batch_kernels[] = {
+    RTMC_KINS_BATCH_PORTABLE, RTMC_KINS_BATCH_SSE2, RTMC_KINS_BATCH_AVX2
+};
+
+// checks every supported batch kernel against `rtmc_kins_scalar_pose()`
+static void expect_batch_matches_pose(const rtmc_path_t& path, const std::vector<double>& s) {
+    double scale_factors[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        scale_factors[i] = 0.5 + i;
+    }
+    rtmc_kins_scalar_setup(scale_factors);
+    rtmc_kins_scalar_load(path);
+
+    std::vector<double> expected(s.size() * RTMC_NUM_AXES);
+    for(size_t k = 0; k < s.size(); k++) {
+        rtmc_kins_scalar_pose(&expected[k * RTMC_NUM_AXES], s[k]);
+    }
+
+    for(rtmc_kins_batch_kernel kernel : batch_kernels) {
+        if(!rtmc_kins_scalar_set_batch_kernel(kernel)) {
+            continue;
+        }
+
+        // odd sizes leave values over for the scalar tails
+        for(size_t n : {(size_t)0, (size_t)1, (size_t)3, (size_t)7, s.size()}) {
+            std::vector<double> poses(n * RTMC_NUM_AXES, NAN);
+            rtmc_kins_scalar_pose_batch(s.data(), n, poses.data());
+            for(size_t j = 0; j < poses.size(); j++) {
+                EXPECT_NEAR(poses[j], expected[j], 1e-13 * fmax(1, fabs(expected[j])))
+                    << "kernel " << kernel << ", n = " << n << ", index " << j;
+            }
+        }
+    }
+
+    EXPECT_TRUE(rtmc_kins_scalar_set_batch_kernel(RTMC_KINS_BATCH_AUTO));
+}
+
+static std::vector<double> sample_s(size_t n) {
+    std::vector<double> s(n);
+    for(size_t k = 0; k < n; k++) {
+        s[k] = (double)k / (n - 1);
+    }
+    return s;
+}
+
+TEST(KinsScalarTests, BatchPolynomial) {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_POLYNOMIAL;
+    for(int i = 0; i < RTMC_NUM_AXES; i += 2) {
+        path.coefficients[i][0] = 0.75 * (i - 5);
+        path.coefficients[i][1] = -2.5 + i;
+        path.coefficients[i][2] = 10 * i;
+        path.coefficients[i][3] = -i;
+    }
+
+    // more than one block
+    expect_batch_matches_pose(path, sample_s(203));
+}
+
+TEST(KinsScalarTests, BatchTrigonometric) {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_TRIGONOMETRIC;
+    path.coefficients[RTMC_X_AXIS][0] = 25;
+    path.coefficients[RTMC_X_AXIS][1] = 1.75 * RTMC_PI;
+    path.coefficients[RTMC_X_AXIS][2] = -0.3;
+    path.coefficients[RTMC_X_AXIS][3] = 4;
+    path.coefficients[RTMC_Y_AXIS][0] = 25;
+    path.coefficients[RTMC_Y_AXIS][1] = 1.75 * RTMC_PI;
+    path.coefficients[RTMC_Y_AXIS][3] = -1;
+
+    // many revolutions, so every quadrant is covered many times
+    path.coefficients[RTMC_A_AXIS][0] = -3;
+    path.coefficients[RTMC_A_AXIS][1] = 2000 * RTMC_PI;
+    path.coefficients[RTMC_A_AXIS][2] = 0.125;
+
+    expect_batch_matches_pose(path, sample_s(1001));
+}
+
+TEST(KinsScalarTests, BatchHelical) {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_HELICAL_YZ;
+    path.coefficients[RTMC_Y_AXIS][0] = 8;
+    path.coefficients[RTMC_Y_AXIS][1] = -RTMC_PI;
+    path.coefficients[RTMC_Y_AXIS][2] = 0.5;
+    path.coefficients[RTMC_Z_AXIS][0] = 8;
+    path.coefficients[RTMC_Z_AXIS][1] = -RTMC_PI;
+    path.coefficients[RTMC_X_AXIS][2] = 6;
+    path.coefficients[RTMC_X_AXIS][3] = 1;
+
+    expect_batch_matches_pose(path, sample_s(130));
+}
+
+TEST(KinsScalarTests, BatchLargeSineArguments) {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_TRIGONOMETRIC;
+    path.coefficients[RTMC_X_AXIS][0] = 1;
+    path.coefficients[RTMC_X_AXIS][1] = 1;
+
+    // on both sides of the point where the kernels fall back to `sin()`
+    std::vector<double> s = {0, 1e4, -3e4, 99999.5, 1e5 + 0.25, -2e5, 1e9, 7.5e12};
+    expect_batch_matches_pose(path, s);
+}
+
+TEST(KinsScalarTests, BatchKernels) {
+    EXPECT_TRUE(rtmc_kins_scalar_set_batch_kernel(RTMC_KINS_BATCH_PORTABLE));
+    EXPECT_TRUE(rtmc_kins_scalar_set_batch_kernel(RTMC_KINS_BATCH_AUTO));
+    EXPECT_FALSE(rtmc_kins_scalar_set_batch_kernel((rtmc_kins_batch_kernel)-1));
+}
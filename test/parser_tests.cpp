@@ -1,3 +1,7 @@
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <thread>
 #include <gtest/gtest.h>
 #include <math.h>
 #include "rtmc_magic_numbers.h"
@@ -26,10 +30,119 @@ TEST(ParseTests, IllegalWords) {
     EXPECT_FALSE(rtmc_parse(&queue, "O1").is_valid);
 }
 
-TEST(ParseTests, ValueTooLong) {
+// parses "G00 X<value>" on a fresh parser and returns the X coefficient
+// (which is exactly the value, since the start position is zero)
+static bool parse_x_value(const char* value, double* x) {
+    rtmc_parser_t* parser = rtmc_create_parser();
     rtmc_path_queue_t queue = rtmc_create_path_queue();
 
-    EXPECT_FALSE(rtmc_parse(&queue, "G0 X-1.4273956103948e-13").is_valid);
+    std::string block = std::string("G00 X") + value;
+    bool is_valid = rtmc_parse_ctx(parser, &queue, block.c_str()).is_valid;
+    if(is_valid) {
+        *x = rtmc_path_queue_front(&queue)
+            ? rtmc_path_queue_front(&queue)->coefficients[RTMC_X_AXIS][2]
+            : 0;
+    }
+
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+    return is_valid;
+}
+
+TEST(ParseTests, LongValues) {
+    // values are no longer limited to 19 chars
+    double x;
+    EXPECT_TRUE(parse_x_value("-1.4273956103948e-13", &x));
+    EXPECT_EQ(x, -1.4273956103948e-13);
+    EXPECT_TRUE(parse_x_value("0.000000000000000001", &x));
+    EXPECT_EQ(x, 1e-18);
+    EXPECT_TRUE(parse_x_value("3.14159265358979323846264338327950288419716939937510", &x));
+    EXPECT_EQ(x, 3.14159265358979323846264338327950288419716939937510);
+    EXPECT_TRUE(parse_x_value("100000000000000000000000000000", &x));
+    EXPECT_EQ(x, 1e29);
+}
+
+TEST(ParseTests, DecimalSyntax) {
+    double x;
+    EXPECT_TRUE(parse_x_value("+2.", &x));
+    EXPECT_EQ(x, 2);
+    EXPECT_TRUE(parse_x_value("-.5", &x));
+    EXPECT_EQ(x, -0.5);
+    EXPECT_TRUE(parse_x_value("1.5e3", &x));
+    EXPECT_EQ(x, 1500);
+    EXPECT_TRUE(parse_x_value("25E-1", &x));
+    EXPECT_EQ(x, 2.5);
+    EXPECT_TRUE(parse_x_value("007", &x));
+    EXPECT_EQ(x, 7);
+
+    // malformed values are errors (instead of being partially read)
+    EXPECT_FALSE(parse_x_value("1.2.3", &x));
+    EXPECT_FALSE(parse_x_value("1e", &x));
+    EXPECT_FALSE(parse_x_value("1e+", &x));
+    EXPECT_FALSE(parse_x_value("--1", &x));
+    EXPECT_FALSE(parse_x_value("1-2", &x));
+    EXPECT_FALSE(parse_x_value(".", &x));
+    EXPECT_FALSE(parse_x_value("-", &x));
+}
+
+TEST(ParseTests, DecimalRounding) {
+    // compare against strtod() on many random values (fixed seed)
+    srand(1234);
+    char value[128];
+    int num_mismatches = 0;
+    for(int i = 0; i < 20000; i++) {
+        int length = 0;
+        if(rand() % 2) {
+            value[length++] = '-';
+        }
+
+        // 1 to 30 digits with a decimal point somewhere
+        int num_digits = 1 + rand() % 30;
+        int point = rand() % (num_digits + 1);
+        for(int j = 0; j < num_digits; j++) {
+            if(j == point) {
+                value[length++] = '.';
+            }
+            value[length++] = '0' + rand() % 10;
+        }
+
+        // optional exponent
+        if(rand() % 2) {
+            length += snprintf(value + length, sizeof(value) - length, "e%d", rand() % 80 - 40);
+        }
+        value[length] = '\0';
+
+        double x;
+        if(!parse_x_value(value, &x) || x != strtod(value, NULL)) {
+            num_mismatches++;
+            ADD_FAILURE() << "mismatch for " << value;
+        }
+    }
+
+    EXPECT_EQ(num_mismatches, 0);
+}
+
+TEST(ParseTests, DecimalHalfwayCases) {
+    // exactly halfway between 1 and the next double (1 + 2^-52)
+    const std::string halfway = "1.00000000000000011102230246251565404236316680908203125";
+    const double next = 1.0000000000000002;
+    double x;
+
+    // ties go to even
+    EXPECT_TRUE(parse_x_value(halfway.c_str(), &x));
+    EXPECT_EQ(x, 1.0);
+
+    // just above and below, past the 40th significant digit
+    EXPECT_TRUE(parse_x_value((halfway + "0001").c_str(), &x));
+    EXPECT_EQ(x, next);
+    EXPECT_TRUE(parse_x_value("1.000000000000000111022302462515654042363166809082031249999", &x));
+    EXPECT_EQ(x, 1.0);
+
+    // just above, past the last kept digit
+    EXPECT_TRUE(parse_x_value((halfway + std::string(1000, '0') + "1").c_str(), &x));
+    EXPECT_EQ(x, next);
+    EXPECT_TRUE(parse_x_value((halfway + std::string(1000, '0')).c_str(), &x));
+    EXPECT_EQ(x, 1.0);
 }
 
 TEST(ParseTests, FlushModalData) {
@@ -408,3 +521,409 @@ TEST(ParseTests, G19) {
     rtmc_path_queue_t queue = rtmc_create_path_queue();
     EXPECT_TRUE(rtmc_parse(&queue, "G19").is_valid);
 }
+
+TEST(ParseTests, ModalBlocksDontEnqueue) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_flush_parser_data();
+
+    // modal and invalid blocks leave the queue empty
+    EXPECT_TRUE(rtmc_parse(&queue, "G17 G90").is_valid);
+    EXPECT_FALSE(rtmc_parse(&queue, "G01 X10").is_valid);
+    EXPECT_FALSE(rtmc_path_queue_front(&queue));
+
+    // paths are written in place (note: the invalid block above still
+    // updated the end coordinates, so this path starts at X10)
+    EXPECT_TRUE(rtmc_parse(&queue, "G00 X20").is_valid);
+    const rtmc_path_t* path = rtmc_path_queue_front(&queue);
+    ASSERT_TRUE(path);
+    EXPECT_TRUE(rtmc_is_equal(path->coefficients[RTMC_X_AXIS][3], 10));
+    rtmc_path_queue_release(&queue);
+    EXPECT_FALSE(rtmc_path_queue_front(&queue));
+
+    rtmc_flush_path_queue(&queue);
+}
+
+TEST(ParseTests, IndependentContexts) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_parser_t* parser_1 = rtmc_create_parser();
+    rtmc_parser_t* parser_2 = rtmc_create_parser();
+    ASSERT_TRUE(parser_1);
+    ASSERT_TRUE(parser_2);
+
+    // modal data set on one context doesn't leak into the other
+    EXPECT_TRUE(rtmc_parse_ctx(parser_1, &queue, "G01 F100 X10").is_valid);
+    EXPECT_FALSE(rtmc_parse_ctx(parser_2, &queue, "G01 X10").is_valid);
+
+    // each context tracks its own position
+    EXPECT_TRUE(rtmc_parse_ctx(parser_1, &queue, "X20").is_valid);
+    rtmc_path_dequeue(&queue);
+    rtmc_path_t path = rtmc_path_dequeue(&queue);
+    EXPECT_TRUE(rtmc_is_equal(path.coefficients[RTMC_X_AXIS][3], 10));
+
+    // flushing one context leaves the other alone
+    rtmc_flush_parser_data_ctx(parser_2);
+    EXPECT_TRUE(rtmc_parse_ctx(parser_1, &queue, "X30").is_valid);
+    path = rtmc_path_dequeue(&queue);
+    EXPECT_TRUE(rtmc_is_equal(path.coefficients[RTMC_X_AXIS][3], 20));
+
+    rtmc_destroy_parser(parser_1);
+    rtmc_destroy_parser(parser_2);
+    rtmc_flush_path_queue(&queue);
+}
+
+TEST(ParseTests, ParallelContexts) {
+    // each thread parses its own program into its own queue
+    const int NUM_BLOCKS = 10000;
+    bool results[2] = {false, false};
+
+    auto parse_program = [NUM_BLOCKS](double step, bool* result) {
+        rtmc_parser_t* parser = rtmc_create_parser();
+        rtmc_path_queue_t queue = rtmc_create_path_queue();
+        char block[64];
+
+        rtmc_parse_ctx(parser, &queue, "G01 F100");
+        *result = true;
+        for(int i = 1; i <= NUM_BLOCKS; i++) {
+            snprintf(block, sizeof(block), "X%g", i * step);
+            rtmc_parse_ctx(parser, &queue, block);
+
+            rtmc_path_t path = rtmc_path_dequeue(&queue);
+            if(!rtmc_is_equal(path.coefficients[RTMC_X_AXIS][2], step)) {
+                *result = false;
+            }
+        }
+
+        rtmc_destroy_parser(parser);
+        rtmc_flush_path_queue(&queue);
+    };
+
+    std::thread thread_1(parse_program, 1.0, &results[0]);
+    std::thread thread_2(parse_program, 2.0, &results[1]);
+    thread_1.join();
+    thread_2.join();
+
+    EXPECT_TRUE(results[0]);
+    EXPECT_TRUE(results[1]);
+}
+
+TEST(ParseTests, ParseBuffer_MatchesParse) {
+    const char* lines[] = {
+        "G00 X-100 Y-50",
+        "G17 G02 F100 X100 Y250 I100 J100",
+        "G01 X0 Y0 Z-1.5",
+        "",
+        "G00 Z5"
+    };
+    const int NUM_LINES = sizeof(lines) / sizeof(lines[0]);
+
+    // parse line by line
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t expected_queue = rtmc_create_path_queue();
+    for(int i = 0; i < NUM_LINES; i++) {
+        rtmc_parse_ctx(parser, &expected_queue, lines[i]);
+    }
+
+    // parse as one buffer (mixed line breaks, no trailing terminator)
+    std::string program = std::string(lines[0]) + "\r\n" + lines[1] + "\n" +
+        lines[2] + "\r" + lines[3] + "\n" + lines[4];
+    rtmc_flush_parser_data_ctx(parser);
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    size_t num_errors = rtmc_parse_buffer(
+        parser, &queue, program.data(), program.size(), NULL, 0
+    );
+    EXPECT_EQ(num_errors, 0);
+
+    // both queues hold the same paths
+    while(rtmc_path_queue_front(&expected_queue)) {
+        const rtmc_path_t* expected = rtmc_path_queue_front(&expected_queue);
+        const rtmc_path_t* path = rtmc_path_queue_front(&queue);
+        ASSERT_TRUE(path);
+        EXPECT_EQ(path->type, expected->type);
+        EXPECT_EQ(memcmp(path->coefficients, expected->coefficients, sizeof(path->coefficients)), 0);
+        rtmc_path_queue_release(&expected_queue);
+        rtmc_path_queue_release(&queue);
+    }
+    EXPECT_FALSE(rtmc_path_queue_front(&queue));
+
+    rtmc_destroy_parser(parser);
+}
+
+TEST(ParseTests, ParseBuffer_Errors) {
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    // lines 2, 4, and 5 are invalid
+    const char program[] = "G00 X10\nH1\nG00 X20\r\nG01 X30\nG 01\nG00 X0\n";
+    rtmc_parse_error_t errors[2];
+    size_t num_errors = rtmc_parse_buffer(
+        parser, &queue, program, sizeof(program) - 1, errors, 2
+    );
+
+    // every error is counted, but only the first two are recorded
+    EXPECT_EQ(num_errors, 3);
+    EXPECT_EQ(errors[0].line, 2);
+    EXPECT_STREQ(errors[0].error_msg, "Invalid G-code word");
+    EXPECT_EQ(errors[1].line, 4);
+    EXPECT_STREQ(errors[1].error_msg, "Feed rate is zero or negative");
+
+    // the valid lines were still parsed
+    EXPECT_TRUE(rtmc_is_equal(rtmc_path_dequeue(&queue).coefficients[RTMC_X_AXIS][2], 10));
+    EXPECT_TRUE(rtmc_is_equal(rtmc_path_dequeue(&queue).coefficients[RTMC_X_AXIS][2], 10));
+    EXPECT_TRUE(rtmc_is_equal(rtmc_path_dequeue(&queue).coefficients[RTMC_X_AXIS][2], -30));
+    EXPECT_FALSE(rtmc_path_queue_front(&queue));
+
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+}
+
+TEST(ParseTests, ParseBufferParallel_MatchesParseBuffer) {
+    // a program big enough to be split into several chunks, with errors,
+    // empty lines, and "\r\n" line breaks mixed in
+    std::string program = "G17 G01 F100\n";
+    for(int i = 0; program.size() < 1000000; i++) {
+        program += "G01 X" + std::to_string(i % 97) + "." + std::to_string(i % 10)
+            + " Y" + std::to_string(i % 89) + ((i % 3) ? "\n" : "\r\n");
+        if(i % 1000 == 0)
+            program += "G01 X1.2.3\n";
+        if(i % 1500 == 0)
+            program += "\n";
+        if(i % 2500 == 0)
+            program += "G02 X0 Y0 I1 J0\nG01\n";
+    }
+
+    rtmc_parser_t* parser = rtmc_create_parser();
+    for(int num_threads : {1, 2, 3, 8, 0}) {
+        rtmc_parse_pool_t* pool = rtmc_create_parse_pool(num_threads);
+        ASSERT_TRUE(pool);
+
+        // parse it sequentially for reference
+        rtmc_flush_parser_data_ctx(parser);
+        rtmc_path_queue_t expected = rtmc_create_path_queue();
+        rtmc_parse_error_t expected_errors[8];
+        size_t num_expected_errors = rtmc_parse_buffer(
+            parser, &expected, program.data(), program.size(), expected_errors, 8
+        );
+        ASSERT_GT(num_expected_errors, 8);
+
+        rtmc_flush_parser_data_ctx(parser);
+        rtmc_path_queue_t queue = rtmc_create_path_queue();
+        rtmc_parse_error_t errors[8];
+        size_t num_errors = rtmc_parse_buffer_parallel(
+            parser, &queue, program.data(), program.size(), errors, 8, pool
+        );
+
+        // same errors on the same lines
+        ASSERT_EQ(num_errors, num_expected_errors);
+        for(int i = 0; i < 8; i++) {
+            EXPECT_EQ(errors[i].line, expected_errors[i].line);
+            EXPECT_STREQ(errors[i].error_msg, expected_errors[i].error_msg);
+        }
+
+        // same paths, bit for bit
+        const rtmc_path_t* expected_path;
+        while((expected_path = rtmc_path_queue_front(&expected))) {
+            const rtmc_path_t* path = rtmc_path_queue_front(&queue);
+            ASSERT_TRUE(path);
+            ASSERT_EQ(path->type, expected_path->type);
+            ASSERT_EQ(path->feed_rate, expected_path->feed_rate);
+            ASSERT_EQ(memcmp(path->coefficients, expected_path->coefficients, sizeof(path->coefficients)), 0);
+            rtmc_path_queue_release(&queue);
+            rtmc_path_queue_release(&expected);
+        }
+        EXPECT_FALSE(rtmc_path_queue_front(&queue));
+
+        rtmc_flush_path_queue(&expected);
+        rtmc_flush_path_queue(&queue);
+        rtmc_destroy_parse_pool(pool);
+    }
+
+    rtmc_destroy_parser(parser);
+}
+
+TEST(ParseTests, ParseBufferParallel_SharedPool) {
+    std::string program;
+    for(int i = 0; program.size() < 500000; i++)
+        program += "G01 X" + std::to_string(i % 53) + " Y" + std::to_string(i % 71) + " F100\n";
+
+    // two parsers share one pool at the same time (each parse reuses the
+    // pool's threads, and lexes chunks itself when they're busy)
+    rtmc_parse_pool_t* pool = rtmc_create_parse_pool(3);
+    ASSERT_TRUE(pool);
+    size_t num_paths[2] = {0, 0};
+    auto parse = [&](int k) {
+        rtmc_parser_t* parser = rtmc_create_parser();
+        rtmc_path_queue_t queue = rtmc_create_path_queue();
+        for(int repeat = 0; repeat < 3; repeat++) {
+            rtmc_flush_parser_data_ctx(parser);
+            EXPECT_EQ(rtmc_parse_buffer_parallel(parser, &queue, program.data(), program.size(), NULL, 0, pool), 0);
+            while(rtmc_path_queue_front(&queue)) {
+                rtmc_path_queue_release(&queue);
+                num_paths[k]++;
+            }
+        }
+        rtmc_destroy_parser(parser);
+        rtmc_flush_path_queue(&queue);
+    };
+    std::thread other(parse, 1);
+    parse(0);
+    other.join();
+    rtmc_destroy_parse_pool(pool);
+
+    // no pool parses on the calling thread
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    EXPECT_EQ(rtmc_parse_buffer_parallel(parser, &queue, program.data(), program.size(), NULL, 0, NULL), 0);
+    size_t num_sequential_paths = 0;
+    while(rtmc_path_queue_front(&queue)) {
+        rtmc_path_queue_release(&queue);
+        num_sequential_paths++;
+    }
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+
+    EXPECT_GT(num_sequential_paths, 0);
+    EXPECT_EQ(num_paths[0], 3 * num_sequential_paths);
+    EXPECT_EQ(num_paths[1], 3 * num_sequential_paths);
+}
+
+TEST(ParseTests, ParseStream_MatchesParseBuffer) {
+    // split lines, split "\r\n" pairs, long numbers, and errors mid-block
+    const std::string program =
+        "G17 G01 F100\r\n"
+        "G01 X1.23456789012345678901234567890 Y-2e1\n"
+        "\n"
+        "G01 X1.2.3 Y4\r"
+        "G01 X 5\r\n"
+        "g1 x+0.5E-1 y3\t\n"
+        "G02 X0 Y0 I1 J0\n"
+        "G00 Z7.5";
+
+    // parse it all at once for reference
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t expected = rtmc_create_path_queue();
+    rtmc_parse_error_t expected_errors[8];
+    size_t num_expected_errors = rtmc_parse_buffer(
+        parser, &expected, program.data(), program.size(), expected_errors, 8
+    );
+    ASSERT_EQ(num_expected_errors, 2);
+
+    for(size_t chunk_size = 1; chunk_size <= program.size(); chunk_size++) {
+        rtmc_flush_parser_data_ctx(parser);
+        rtmc_path_queue_t queue = rtmc_create_path_queue();
+        rtmc_parse_error_t errors[8];
+        size_t num_errors = 0;
+
+        for(size_t i = 0; i < program.size(); i += chunk_size) {
+            size_t length = std::min(chunk_size, program.size() - i);
+            num_errors += rtmc_parse_stream(
+                parser, &queue, program.data() + i, length,
+                errors + num_errors, 8 - num_errors
+            );
+        }
+        num_errors += rtmc_end_stream(parser, &queue, errors + num_errors, 8 - num_errors);
+
+        // same errors on the same lines
+        ASSERT_EQ(num_errors, num_expected_errors);
+        for(size_t i = 0; i < num_errors; i++) {
+            EXPECT_EQ(errors[i].line, expected_errors[i].line);
+            EXPECT_STREQ(errors[i].error_msg, expected_errors[i].error_msg);
+        }
+
+        // same paths, bit for bit
+        rtmc_path_queue_t expected_copy = rtmc_create_path_queue();
+        rtmc_flush_parser_data_ctx(parser);
+        rtmc_parse_buffer(parser, &expected_copy, program.data(), program.size(), NULL, 0);
+        const rtmc_path_t* expected_path;
+        while((expected_path = rtmc_path_queue_front(&expected_copy))) {
+            const rtmc_path_t* path = rtmc_path_queue_front(&queue);
+            ASSERT_TRUE(path);
+            ASSERT_EQ(path->type, expected_path->type);
+            ASSERT_EQ(path->feed_rate, expected_path->feed_rate);
+            ASSERT_EQ(memcmp(path->coefficients, expected_path->coefficients, sizeof(path->coefficients)), 0);
+            rtmc_path_queue_release(&queue);
+            rtmc_path_queue_release(&expected_copy);
+        }
+        EXPECT_FALSE(rtmc_path_queue_front(&queue));
+
+        rtmc_flush_path_queue(&expected_copy);
+        rtmc_flush_path_queue(&queue);
+    }
+
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&expected);
+}
+
+TEST(ParseTests, ParseStream_EnqueuesOnTerminator) {
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    // nothing is enqueued until the block is terminated
+    EXPECT_EQ(rtmc_parse_stream(parser, &queue, "G00 X1", 6, NULL, 0), 0);
+    EXPECT_EQ(rtmc_parse_stream(parser, &queue, "2.", 2, NULL, 0), 0);
+    EXPECT_FALSE(rtmc_path_queue_front(&queue));
+
+    // the path is available as soon as the terminator arrives
+    EXPECT_EQ(rtmc_parse_stream(parser, &queue, "5\r", 2, NULL, 0), 0);
+    ASSERT_TRUE(rtmc_path_queue_front(&queue));
+    EXPECT_TRUE(rtmc_is_equal(rtmc_path_dequeue(&queue).coefficients[RTMC_X_AXIS][2], 12.5));
+
+    // the rest of the "\r\n" isn't an extra (empty) line
+    rtmc_parse_error_t error;
+    EXPECT_EQ(rtmc_parse_stream(parser, &queue, "\nG01 X1", 7, &error, 1), 0);
+    EXPECT_EQ(rtmc_end_stream(parser, &queue, &error, 1), 1);
+    EXPECT_EQ(error.line, 2);
+    EXPECT_STREQ(error.error_msg, "Feed rate is zero or negative");
+
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+}
+
+TEST(ParseTests, GCodeValues) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    // leading zeros and trailing decimals are the same code
+    EXPECT_TRUE(rtmc_parse(&queue, "G017").is_valid);
+    EXPECT_TRUE(rtmc_parse(&queue, "G17.0").is_valid);
+    EXPECT_TRUE(rtmc_parse(&queue, "G1.7E1").is_valid);
+
+    // values equal to zero (to within `rtmc_is_equal()`) are G00
+    EXPECT_TRUE(rtmc_parse(&queue, "G-1E-305").is_valid);
+    EXPECT_TRUE(rtmc_parse(&queue, "G-0").is_valid);
+
+    // unknown, fractional, negative, and out of range codes are invalid
+    EXPECT_FALSE(rtmc_parse(&queue, "G17.5").is_valid);
+    EXPECT_FALSE(rtmc_parse(&queue, "G1.05").is_valid);
+    EXPECT_FALSE(rtmc_parse(&queue, "G-1").is_valid);
+    EXPECT_FALSE(rtmc_parse(&queue, "G100").is_valid);
+    EXPECT_FALSE(rtmc_parse(&queue, "G1E300").is_valid);
+}
+
+TEST(ParseTests, ParseFile) {
+    // write a small program (with an error on line 3)
+    std::string filename = testing::TempDir() + "rtmc_parse_file_test.ngc";
+    FILE* file = fopen(filename.c_str(), "wb");
+    ASSERT_TRUE(file);
+    fputs("G00 X10\r\nG01 F100 Y5\nQQ\nG00 Z-1", file);
+    fclose(file);
+
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_parse_error_t errors[4];
+    size_t num_errors = rtmc_parse_file(parser, &queue, filename.c_str(), errors, 4);
+    EXPECT_EQ(num_errors, 1);
+    EXPECT_EQ(errors[0].line, 3);
+
+    EXPECT_TRUE(rtmc_is_equal(rtmc_path_dequeue(&queue).coefficients[RTMC_X_AXIS][2], 10));
+    EXPECT_TRUE(rtmc_is_equal(rtmc_path_dequeue(&queue).coefficients[RTMC_Y_AXIS][2], 5));
+    EXPECT_TRUE(rtmc_is_equal(rtmc_path_dequeue(&queue).coefficients[RTMC_Z_AXIS][2], -1));
+    EXPECT_FALSE(rtmc_path_queue_front(&queue));
+
+    // missing files are reported as an error on line 0
+    num_errors = rtmc_parse_file(parser, &queue, "/nonexistent/rtmc.ngc", errors, 4);
+    EXPECT_EQ(num_errors, 1);
+    EXPECT_EQ(errors[0].line, 0);
+
+    remove(filename.c_str());
+    rtmc_destroy_parser(parser);
+    rtmc_flush_path_queue(&queue);
+}
@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <gtest/gtest.h>
+#include "rtmc_parser.h"
+#include "rtmc_path.h"
+#include "rtmc_path_file.h"
+
+// returns a file name unique to the running test (ctest runs the tests in
+// parallel, so they can't share one)
+static std::string temp_filename() {
+    return testing::TempDir() + "path_file_tests_"
+        + testing::UnitTest::GetInstance()->current_test_info()->name() + ".rtmcp";
+}
+
+// parses a program with lines and arcs
+static rtmc_path_queue_t parse_program() {
+    std::string program = "G17 G01 F100\n";
+    for(int i = 0; i < 1000; i++) {
+        program += "G01 X" + std::to_string(i % 13) + " Y" + std::to_string(i % 7) + " Z0.5\n";
+        if(i % 10 == 0)
+            program += "G02 X0 Y0 I1 J0\n";
+    }
+
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_parse_buffer(parser, &queue, program.data(), program.size(), NULL, 0);
+    rtmc_destroy_parser(parser);
+    return queue;
+}
+
+TEST(PathFileTests, RoundTrip) {
+    std::string filename = temp_filename();
+    rtmc_path_queue_t queue = parse_program();
+    rtmc_path_queue_t expected = parse_program();
+
+    const char metadata[] = "metadata";
+    ASSERT_TRUE(rtmc_write_path_file(filename.c_str(), &queue, 0x1234, metadata, sizeof(metadata)));
+    EXPECT_FALSE(rtmc_path_queue_front(&queue));
+
+    rtmc_path_view_t view;
+    ASSERT_TRUE(rtmc_open_path_view(&view, filename.c_str()));
+    EXPECT_EQ(view.count, 1100);
+    EXPECT_EQ(view.source_hash, 0x1234);
+    ASSERT_EQ(view.metadata_size, sizeof(metadata));
+    EXPECT_EQ(memcmp(view.metadata, metadata, sizeof(metadata)), 0);
+
+    // the view reads like the original queue
+    const rtmc_path_t* expected_path;
+    while((expected_path = rtmc_path_queue_front(&expected))) {
+        const rtmc_path_t* path = rtmc_path_view_front(&view);
+        ASSERT_TRUE(path);
+        ASSERT_EQ(path->type, expected_path->type);
+        ASSERT_EQ(path->feed_rate, expected_path->feed_rate);
+        ASSERT_EQ(memcmp(path->coefficients, expected_path->coefficients, sizeof(path->coefficients)), 0);
+        rtmc_path_view_release(&view);
+        rtmc_path_queue_release(&expected);
+    }
+    EXPECT_FALSE(rtmc_path_view_front(&view));
+    EXPECT_EQ(view.index, view.count);
+
+    rtmc_close_path_view(&view);
+    rtmc_flush_path_queue(&queue);
+    rtmc_flush_path_queue(&expected);
+    remove(filename.c_str());
+}
+
+TEST(PathFileTests, Empty) {
+    std::string filename = temp_filename();
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    ASSERT_TRUE(rtmc_write_path_file(filename.c_str(), &queue, 0, NULL, 0));
+
+    rtmc_path_view_t view;
+    ASSERT_TRUE(rtmc_open_path_view(&view, filename.c_str()));
+    EXPECT_EQ(view.count, 0);
+    EXPECT_EQ(view.metadata_size, 0);
+    EXPECT_FALSE(rtmc_path_view_front(&view));
+
+    rtmc_close_path_view(&view);
+    remove(filename.c_str());
+}
+
+TEST(PathFileTests, InvalidFiles) {
+    std::string filename = temp_filename();
+    rtmc_path_view_t view;
+    EXPECT_FALSE(rtmc_open_path_view(&view, "missing.rtmcp"));
+
+    // not a path file
+    FILE* file = fopen(filename.c_str(), "wb");
+    fputs("G01 X10 Y10 F100 ... not a compiled program\n", file);
+    fclose(file);
+    EXPECT_FALSE(rtmc_open_path_view(&view, filename.c_str()));
+
+    // truncated
+    rtmc_path_queue_t queue = parse_program();
+    ASSERT_TRUE(rtmc_write_path_file(filename.c_str(), &queue, 0, NULL, 0));
+    file = fopen(filename.c_str(), "rb");
+    std::string data(1 << 20, '\0');
+    data.resize(fread(&data[0], 1, data.size(), file));
+    fclose(file);
+
+    file = fopen(filename.c_str(), "wb");
+    fwrite(data.data(), 1, data.size() - 1, file);
+    fclose(file);
+    EXPECT_FALSE(rtmc_open_path_view(&view, filename.c_str()));
+
+    rtmc_flush_path_queue(&queue);
+    remove(filename.c_str());
+}
@@ -80,3 +80,105 @@ TEST(PathQueueTests, Queue_Flush) {
     EXPECT_FALSE(queue.head);
     EXPECT_FALSE(queue.tail);
 }
+
+TEST(PathQueueTests, Queue_SpansChunks) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    // fill several chunks (plus a partial one)
+    const int NUM_PATHS = 3 * RTMC_PATH_CHUNK_SIZE + 5;
+    rtmc_path_t path;
+    for(int i = 0; i < NUM_PATHS; i++) {
+        path.feed_rate = i;
+        rtmc_path_enqueue(&queue, path);
+    }
+
+    // chunks are linked in order
+    EXPECT_NE(queue.head, queue.tail);
+    EXPECT_EQ(queue.tail_index, 5);
+
+    // paths come back out in order
+    for(int i = 0; i < NUM_PATHS; i++) {
+        EXPECT_DOUBLE_EQ(rtmc_path_queue_peek(&queue).feed_rate, i);
+        EXPECT_DOUBLE_EQ(rtmc_path_dequeue(&queue).feed_rate, i);
+    }
+
+    EXPECT_FALSE(queue.head);
+    EXPECT_FALSE(queue.tail);
+    rtmc_flush_path_queue(&queue);
+}
+
+TEST(PathQueueTests, Queue_RecyclesChunks) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+
+    rtmc_path_t path;
+    path.feed_rate = 100;
+
+    // emptying the queue keeps its chunk for reuse
+    rtmc_path_enqueue(&queue, path);
+    rtmc_path_chunk_t* chunk = queue.head;
+    rtmc_path_dequeue(&queue);
+    EXPECT_EQ(queue.free_chunks, chunk);
+
+    // so the next enqueue reuses the same chunk instead of allocating
+    rtmc_path_enqueue(&queue, path);
+    EXPECT_EQ(queue.head, chunk);
+    EXPECT_FALSE(queue.free_chunks);
+
+    // streaming through many chunks only needs two of them
+    for(int i = 0; i < 10 * RTMC_PATH_CHUNK_SIZE; i++) {
+        rtmc_path_enqueue(&queue, path);
+        rtmc_path_dequeue(&queue);
+    }
+    int num_chunks = 0;
+    for(rtmc_path_chunk_t* c = queue.free_chunks; c; c = c->next) {
+        num_chunks++;
+    }
+    for(rtmc_path_chunk_t* c = queue.head; c; c = c->next) {
+        num_chunks++;
+    }
+    EXPECT_LE(num_chunks, 2);
+
+    // flushing frees everything
+    rtmc_flush_path_queue(&queue);
+    EXPECT_FALSE(queue.head);
+    EXPECT_FALSE(queue.tail);
+    EXPECT_FALSE(queue.free_chunks);
+}
+
+TEST(PathQueueTests, Queue_ZeroCopy) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    EXPECT_FALSE(rtmc_path_queue_front(&queue));
+
+    // reserving doesn't add anything to the queue
+    rtmc_path_t* slot = rtmc_path_queue_reserve(&queue);
+    slot->feed_rate = 100;
+    EXPECT_FALSE(rtmc_path_queue_front(&queue));
+    EXPECT_EQ(rtmc_path_queue_reserve(&queue), slot);
+
+    // committing does, without moving the path
+    rtmc_path_queue_commit(&queue);
+    EXPECT_EQ(rtmc_path_queue_front(&queue), slot);
+
+    // fill past the end of the first chunk
+    for(int i = 1; i <= RTMC_PATH_CHUNK_SIZE; i++) {
+        rtmc_path_queue_reserve(&queue)->feed_rate = 100 + i;
+        rtmc_path_queue_commit(&queue);
+    }
+
+    // read everything back in place
+    for(int i = 0; i <= RTMC_PATH_CHUNK_SIZE; i++) {
+        const rtmc_path_t* head = rtmc_path_queue_front(&queue);
+        ASSERT_TRUE(head);
+        EXPECT_DOUBLE_EQ(head->feed_rate, 100 + i);
+        rtmc_path_queue_release(&queue);
+    }
+
+    // check that queue is now empty
+    EXPECT_FALSE(rtmc_path_queue_front(&queue));
+    EXPECT_FALSE(queue.head);
+    EXPECT_FALSE(queue.tail);
+
+    // releasing an empty queue does nothing
+    EXPECT_NO_THROW(rtmc_path_queue_release(&queue));
+    rtmc_flush_path_queue(&queue);
+}
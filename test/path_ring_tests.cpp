@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "rtmc_path_ring.h"
+
+TEST(PathRingTests, Ring_Typical) {
+    // create ring
+    rtmc_path_t buffer[4];
+    rtmc_path_ring_t ring = rtmc_create_path_ring(buffer, 4);
+    EXPECT_EQ(rtmc_path_ring_size(&ring), 0);
+
+    // create paths
+    rtmc_path_t path1;
+    rtmc_path_t path2;
+    rtmc_path_t path3;
+    path1.feed_rate = 100;
+    path2.feed_rate = 200;
+    path3.feed_rate = 300;
+
+    // add paths to ring
+    EXPECT_TRUE(rtmc_path_ring_enqueue(&ring, path1));
+    EXPECT_TRUE(rtmc_path_ring_enqueue(&ring, path2));
+    EXPECT_TRUE(rtmc_path_ring_enqueue(&ring, path3));
+    EXPECT_EQ(rtmc_path_ring_size(&ring), 3);
+
+    // remove paths from ring and check result
+    rtmc_path_t new_path;
+    EXPECT_TRUE(rtmc_path_ring_dequeue(&ring, &new_path));
+    EXPECT_DOUBLE_EQ(new_path.feed_rate, path1.feed_rate);
+    EXPECT_TRUE(rtmc_path_ring_dequeue(&ring, &new_path));
+    EXPECT_DOUBLE_EQ(new_path.feed_rate, path2.feed_rate);
+    EXPECT_TRUE(rtmc_path_ring_dequeue(&ring, &new_path));
+    EXPECT_DOUBLE_EQ(new_path.feed_rate, path3.feed_rate);
+
+    // check that ring is now empty
+    EXPECT_EQ(rtmc_path_ring_size(&ring), 0);
+}
+
+TEST(PathRingTests, Ring_Underflow) {
+    rtmc_path_t buffer[4];
+    rtmc_path_ring_t ring = rtmc_create_path_ring(buffer, 4);
+
+    rtmc_path_t path;
+    path.feed_rate = 100;
+    EXPECT_FALSE(rtmc_path_ring_dequeue(&ring, &path));
+    EXPECT_FALSE(rtmc_path_ring_peek(&ring, &path));
+
+    // path is left untouched
+    EXPECT_DOUBLE_EQ(path.feed_rate, 100);
+}
+
+TEST(PathRingTests, Ring_Overflow) {
+    rtmc_path_t buffer[4];
+    rtmc_path_ring_t ring = rtmc_create_path_ring(buffer, 4);
+
+    rtmc_path_t path;
+    for(int i = 0; i < 4; i++) {
+        path.feed_rate = i;
+        EXPECT_TRUE(rtmc_path_ring_enqueue(&ring, path));
+    }
+
+    // ring is full, so the path is rejected
+    path.feed_rate = 4;
+    EXPECT_FALSE(rtmc_path_ring_enqueue(&ring, path));
+    EXPECT_EQ(rtmc_path_ring_size(&ring), 4);
+
+    // the oldest path was not overwritten
+    EXPECT_TRUE(rtmc_path_ring_peek(&ring, &path));
+    EXPECT_DOUBLE_EQ(path.feed_rate, 0);
+}
+
+TEST(PathRingTests, Ring_WrapAround) {
+    rtmc_path_t buffer[4];
+    rtmc_path_ring_t ring = rtmc_create_path_ring(buffer, 4);
+
+    // push many more paths than the capacity through the ring
+    rtmc_path_t path;
+    for(int i = 0; i < 100; i++) {
+        path.feed_rate = i;
+        EXPECT_TRUE(rtmc_path_ring_enqueue(&ring, path));
+        EXPECT_TRUE(rtmc_path_ring_dequeue(&ring, &path));
+        EXPECT_DOUBLE_EQ(path.feed_rate, i);
+    }
+    EXPECT_EQ(rtmc_path_ring_size(&ring), 0);
+}
+
+TEST(PathRingTests, Ring_CapacityRoundsDown) {
+    rtmc_path_t buffer[6];
+    rtmc_path_ring_t ring = rtmc_create_path_ring(buffer, 6);
+    EXPECT_EQ(ring.capacity, 4);
+
+    ring = rtmc_create_path_ring(buffer, 1);
+    EXPECT_EQ(ring.capacity, 1);
+
+    // a zero capacity ring is always full
+    rtmc_path_t path;
+    ring = rtmc_create_path_ring(NULL, 0);
+    EXPECT_FALSE(rtmc_path_ring_enqueue(&ring, path));
+    EXPECT_FALSE(rtmc_path_ring_dequeue(&ring, &path));
+}
+
+TEST(PathRingTests, Ring_Flush) {
+    rtmc_path_t buffer[4];
+    rtmc_path_ring_t ring = rtmc_create_path_ring(buffer, 4);
+
+    // add a few paths to the ring
+    rtmc_path_t path;
+    path.feed_rate = 100;
+    rtmc_path_ring_enqueue(&ring, path);
+    rtmc_path_ring_enqueue(&ring, path);
+    rtmc_path_ring_enqueue(&ring, path);
+
+    // flush the ring and verify
+    rtmc_flush_path_ring(&ring);
+    EXPECT_EQ(rtmc_path_ring_size(&ring), 0);
+    EXPECT_FALSE(rtmc_path_ring_dequeue(&ring, &path));
+}
@@ -0,0 +1,134 @@
+#include <string.h>
+#include <gtest/gtest.h>
+#include "rtmc_parser.h"
+#include "rtmc_path.h"
+#include "rtmc_path_sparse.h"
+
+// builds a line path from `start` to `end`
+static rtmc_path_t line(const double* start, const double* end) {
+    rtmc_path_t path;
+    path.type = RTMC_PATH_TYPE_POLYNOMIAL;
+    path.feed_rate = 100;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        path.coefficients[i][0] = 0;
+        path.coefficients[i][1] = 0;
+        path.coefficients[i][2] = end[i] - start[i];
+        path.coefficients[i][3] = start[i];
+    }
+    return path;
+}
+
+static bool are_paths_identical(const rtmc_path_t& p1, const rtmc_path_t& p2) {
+    return p1.type == p2.type &&
+        p1.feed_rate == p2.feed_rate &&
+        memcmp(p1.coefficients, p2.coefficients, sizeof(p1.coefficients)) == 0;
+}
+
+TEST(PathSparseTests, ActiveAxes) {
+    double start[RTMC_NUM_AXES] = {0};
+    double end[RTMC_NUM_AXES] = {0};
+    end[RTMC_X_AXIS] = 10;
+    end[RTMC_C_AXIS] = -1;
+
+    rtmc_path_t path = line(start, end);
+    EXPECT_EQ(rtmc_path_active_axes(&path), (1 << RTMC_X_AXIS) | (1 << RTMC_C_AXIS));
+}
+
+TEST(PathSparseTests, SparseQueue_RoundTrip) {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_sparse_path_queue_t sparse_queue = rtmc_create_sparse_path_queue();
+
+    // mix of lines and arcs (arcs leave other axes where they are)
+    const char* program[] = {
+        "G00 X-100 Y-50 Z5",
+        "G01 F100 Z-1",
+        "G17 G02 X100 Y250 I100 J100",
+        "G01 X0 Y0 A90",
+        "G03 X10 Y0 I5 J0",
+        "G00 Z5"
+    };
+    const int NUM_BLOCKS = sizeof(program) / sizeof(program[0]);
+
+    rtmc_flush_parser_data();
+    for(int i = 0; i < NUM_BLOCKS; i++) {
+        ASSERT_TRUE(rtmc_parse(&queue, program[i]).is_valid) << program[i];
+    }
+
+    // copy everything into the sparse queue
+    rtmc_path_t paths[NUM_BLOCKS];
+    for(int i = 0; i < NUM_BLOCKS; i++) {
+        paths[i] = rtmc_path_dequeue(&queue);
+        rtmc_sparse_path_enqueue(&sparse_queue, paths[i]);
+    }
+
+    // paths come back out bit-for-bit identical
+    for(int i = 0; i < NUM_BLOCKS; i++) {
+        EXPECT_TRUE(are_paths_identical(rtmc_sparse_path_queue_peek(&sparse_queue), paths[i]));
+        EXPECT_TRUE(are_paths_identical(rtmc_sparse_path_dequeue(&sparse_queue), paths[i]));
+    }
+
+    EXPECT_FALSE(sparse_queue.head);
+    EXPECT_FALSE(sparse_queue.tail);
+    rtmc_flush_sparse_path_queue(&sparse_queue);
+}
+
+TEST(PathSparseTests, SparseQueue_UsesLessMemory) {
+    rtmc_sparse_path_queue_t sparse_queue = rtmc_create_sparse_path_queue();
+
+    // zig-zag in XY, with the other axes sitting at non-zero positions
+    const int NUM_PATHS = 10000;
+    double start[RTMC_NUM_AXES];
+    double end[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        start[i] = i;
+        end[i] = i;
+    }
+
+    rtmc_path_t first_path;
+    for(int i = 0; i < NUM_PATHS; i++) {
+        end[RTMC_X_AXIS] = i;
+        end[RTMC_Y_AXIS] = i % 2;
+        rtmc_path_t path = line(start, end);
+        rtmc_sparse_path_enqueue(&sparse_queue, path);
+        memcpy(start, end, sizeof(start));
+
+        if(i == 0) {
+            first_path = path;
+        }
+    }
+
+    // roughly a quarter of the memory of storing full paths
+    size_t full_memory = NUM_PATHS * sizeof(rtmc_path_t);
+    EXPECT_LT(4 * rtmc_sparse_path_queue_memory(&sparse_queue), full_memory);
+
+    // idle axes are still restored from the queue state
+    rtmc_path_t path = rtmc_sparse_path_dequeue(&sparse_queue);
+    EXPECT_TRUE(are_paths_identical(path, first_path));
+    EXPECT_DOUBLE_EQ(path.coefficients[RTMC_C_AXIS][3], RTMC_C_AXIS);
+
+    rtmc_flush_sparse_path_queue(&sparse_queue);
+    EXPECT_EQ(rtmc_sparse_path_queue_memory(&sparse_queue), 0);
+}
+
+TEST(PathSparseTests, SparseQueue_Flush) {
+    rtmc_sparse_path_queue_t sparse_queue = rtmc_create_sparse_path_queue();
+
+    double start[RTMC_NUM_AXES] = {0};
+    double end[RTMC_NUM_AXES] = {0};
+    end[RTMC_Z_AXIS] = 7;
+
+    // add a few paths to the queue
+    rtmc_sparse_path_enqueue(&sparse_queue, line(start, end));
+    rtmc_sparse_path_enqueue(&sparse_queue, line(end, start));
+
+    // flush the queue and verify
+    rtmc_flush_sparse_path_queue(&sparse_queue);
+    EXPECT_FALSE(sparse_queue.head);
+    EXPECT_FALSE(sparse_queue.tail);
+
+    // the queue keeps working after a flush
+    rtmc_path_t path = line(start, end);
+    rtmc_sparse_path_enqueue(&sparse_queue, path);
+    EXPECT_TRUE(are_paths_identical(rtmc_sparse_path_dequeue(&sparse_queue), path));
+    rtmc_flush_sparse_path_queue(&sparse_queue);
+}
@@ -0,0 +1,124 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+#include <gtest/gtest.h>
+#include "rtmc_path_spsc.h"
+
+TEST(PathSpscTests, Spsc_Typical) {
+    rtmc_path_t buffer[4];
+    rtmc_path_spsc_t queue;
+    rtmc_init_path_spsc(&queue, buffer, 4);
+    EXPECT_EQ(rtmc_path_spsc_size(&queue), 0);
+
+    // create paths
+    rtmc_path_t path1;
+    rtmc_path_t path2;
+    path1.feed_rate = 100;
+    path2.feed_rate = 200;
+
+    // add paths to queue
+    EXPECT_TRUE(rtmc_path_spsc_enqueue(&queue, path1));
+    EXPECT_TRUE(rtmc_path_spsc_enqueue(&queue, path2));
+    EXPECT_EQ(rtmc_path_spsc_size(&queue), 2);
+
+    // peek, then remove paths from queue and check result
+    rtmc_path_t new_path;
+    EXPECT_TRUE(rtmc_path_spsc_peek(&queue, &new_path));
+    EXPECT_DOUBLE_EQ(new_path.feed_rate, path1.feed_rate);
+    EXPECT_TRUE(rtmc_path_spsc_dequeue(&queue, &new_path));
+    EXPECT_DOUBLE_EQ(new_path.feed_rate, path1.feed_rate);
+    EXPECT_TRUE(rtmc_path_spsc_dequeue(&queue, &new_path));
+    EXPECT_DOUBLE_EQ(new_path.feed_rate, path2.feed_rate);
+
+    // check that queue is now empty
+    EXPECT_FALSE(rtmc_path_spsc_dequeue(&queue, &new_path));
+    EXPECT_EQ(rtmc_path_spsc_size(&queue), 0);
+}
+
+TEST(PathSpscTests, Spsc_Overflow) {
+    rtmc_path_t buffer[2];
+    rtmc_path_spsc_t queue;
+    rtmc_init_path_spsc(&queue, buffer, 2);
+
+    rtmc_path_t path;
+    path.feed_rate = 100;
+    EXPECT_TRUE(rtmc_path_spsc_enqueue(&queue, path));
+    EXPECT_TRUE(rtmc_path_spsc_enqueue(&queue, path));
+    EXPECT_FALSE(rtmc_path_spsc_enqueue(&queue, path));
+
+    // freeing a slot makes room again
+    EXPECT_TRUE(rtmc_path_spsc_dequeue(&queue, &path));
+    EXPECT_TRUE(rtmc_path_spsc_enqueue(&queue, path));
+}
+
+TEST(PathSpscTests, Spsc_Flush) {
+    rtmc_path_t buffer[4];
+    rtmc_path_spsc_t queue;
+    rtmc_init_path_spsc(&queue, buffer, 4);
+
+    rtmc_path_t path;
+    path.feed_rate = 100;
+    rtmc_path_spsc_enqueue(&queue, path);
+    rtmc_path_spsc_enqueue(&queue, path);
+
+    rtmc_flush_path_spsc(&queue);
+    EXPECT_EQ(rtmc_path_spsc_size(&queue), 0);
+    EXPECT_FALSE(rtmc_path_spsc_dequeue(&queue, &path));
+}
+
+TEST(PathSpscTests, Spsc_IndicesOnSeparateCacheLines) {
+    // each side's data starts its own cache line, and nothing follows it on
+    // the producer's
+    EXPECT_EQ(alignof(rtmc_path_spsc_t), RTMC_CACHE_LINE_SIZE);
+    EXPECT_EQ(offsetof(rtmc_path_spsc_t, head) % RTMC_CACHE_LINE_SIZE, 0);
+    EXPECT_EQ(offsetof(rtmc_path_spsc_t, tail) % RTMC_CACHE_LINE_SIZE, 0);
+    EXPECT_GE(offsetof(rtmc_path_spsc_t, tail), offsetof(rtmc_path_spsc_t, head) + RTMC_CACHE_LINE_SIZE);
+    EXPECT_EQ(sizeof(rtmc_path_spsc_t), offsetof(rtmc_path_spsc_t, tail) + RTMC_CACHE_LINE_SIZE);
+
+    rtmc_path_spsc_t queue;
+    EXPECT_EQ((uintptr_t)&queue % RTMC_CACHE_LINE_SIZE, 0);
+}
+
+TEST(PathSpscTests, Spsc_StressTwoThreads) {
+    // a small queue forces the threads to constantly wait on each other
+    const int NUM_PATHS = 1000000;
+    rtmc_path_t buffer[8];
+    rtmc_path_spsc_t queue;
+    rtmc_init_path_spsc(&queue, buffer, 8);
+
+    std::thread producer([&queue, NUM_PATHS]() {
+        rtmc_path_t path;
+        for(int i = 0; i < NUM_PATHS; i++) {
+            // tag every field so torn copies would be detected
+            path.feed_rate = i;
+            for(int j = 0; j < RTMC_NUM_AXES; j++) {
+                for(int k = 0; k < RTMC_NUM_PATH_COEFFICIENTS; k++) {
+                    path.coefficients[j][k] = i;
+                }
+            }
+
+            while(!rtmc_path_spsc_enqueue(&queue, path)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // consume on this thread and check that order and contents are intact
+    int num_errors = 0;
+    rtmc_path_t path;
+    for(int i = 0; i < NUM_PATHS; i++) {
+        while(!rtmc_path_spsc_dequeue(&queue, &path)) {
+            std::this_thread::yield();
+        }
+
+        if(path.feed_rate != i ||
+            path.coefficients[0][0] != i ||
+            path.coefficients[RTMC_NUM_AXES - 1][RTMC_NUM_PATH_COEFFICIENTS - 1] != i) {
+            num_errors++;
+        }
+    }
+
+    producer.join();
+    EXPECT_EQ(num_errors, 0);
+    EXPECT_EQ(rtmc_path_spsc_size(&queue), 0);
+}
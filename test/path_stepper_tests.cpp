@@ -0,0 +1,198 @@
+#include <math.h>
+#include <string.h>
+#include <gtest/gtest.h>
+#include "rtmc_kins_scalar.h"
+#include "rtmc_math.h"
+#include "rtmc_path.h"
+#include "rtmc_path_stepper.h"
+
+// evaluates a path directly
+static double evaluate(const rtmc_path_t& path, int axis, double s) {
+    const double* c = path.coefficients[axis];
+    if(rtmc_path_is_trigonometric_axis(path.type, axis))
+        return c[0]*sin(c[1]*(s - c[2])) + c[3];
+    return c[0]*s*s*s + c[1]*s*s + c[2]*s + c[3];
+}
+
+static rtmc_path_t make_cubic() {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_POLYNOMIAL;
+    for(int i = 0; i < RTMC_NUM_AXES; i++) {
+        path.coefficients[i][0] = 0.5 * (i - 6);
+        path.coefficients[i][1] = -1.25 * i;
+        path.coefficients[i][2] = 3 + i;
+        path.coefficients[i][3] = 100 * i;
+    }
+    return path;
+}
+
+TEST(PathStepperTests, CubicMatchesDirectEvaluation) {
+    rtmc_path_t path = make_cubic();
+
+    // well past several anchors
+    const int num_steps = 10 * RTMC_PATH_STEPPER_ANCHOR_INTERVAL + 7;
+    const double ds = 1.0 / num_steps;
+
+    rtmc_path_stepper_t stepper;
+    rtmc_path_stepper_init(&stepper, &path, 0, ds);
+
+    double max_error = 0;
+    double pose[RTMC_NUM_AXES];
+    for(int k = 0; k <= num_steps; k++) {
+        rtmc_path_stepper_next(&stepper, pose);
+        for(int i = 0; i < RTMC_NUM_AXES; i++)
+            max_error = fmax(max_error, fabs(pose[i] - evaluate(path, i, k * ds)));
+    }
+
+    EXPECT_LT(max_error, 1e-10);
+}
+
+TEST(PathStepperTests, StartsAtS0) {
+    rtmc_path_t path = make_cubic();
+
+    rtmc_path_stepper_t stepper;
+    rtmc_path_stepper_init(&stepper, &path, 0.25, 0.125);
+
+    double pose[RTMC_NUM_AXES];
+    for(int k = 0; k < 7; k++) {
+        rtmc_path_stepper_next(&stepper, pose);
+        for(int i = 0; i < RTMC_NUM_AXES; i++)
+            EXPECT_NEAR(pose[i], evaluate(path, i, 0.25 + k * 0.125), 1e-12);
+    }
+}
+
+TEST(PathStepperTests, TrigonometricAxes) {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_HELICAL_XY;
+    path.coefficients[RTMC_X_AXIS][0] = 2;
+    path.coefficients[RTMC_X_AXIS][1] = RTMC_PI;
+    path.coefficients[RTMC_X_AXIS][2] = -0.5;
+    path.coefficients[RTMC_Y_AXIS][0] = 2;
+    path.coefficients[RTMC_Y_AXIS][1] = RTMC_PI;
+    path.coefficients[RTMC_Z_AXIS][2] = -3;
+    path.coefficients[RTMC_Z_AXIS][3] = 1;
+
+    const double ds = 0.001;
+    rtmc_path_stepper_t stepper;
+    rtmc_path_stepper_init(&stepper, &path, 0, ds);
+
+    double pose[RTMC_NUM_AXES];
+    for(int k = 0; k <= 1000; k++) {
+        rtmc_path_stepper_next(&stepper, pose);
+        for(int i = 0; i < RTMC_NUM_AXES; i++)
+            EXPECT_NEAR(pose[i], evaluate(path, i, k * ds), 1e-9);
+    }
+}
+
+TEST(PathStepperTests, KinsScalarStepper) {
+    double scale_factors[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_NUM_AXES; i++)
+        scale_factors[i] = -2 + i;
+    rtmc_kins_scalar_setup(scale_factors);
+    rtmc_kins_scalar_load(make_cubic());
+
+    rtmc_path_stepper_t stepper;
+    rtmc_kins_scalar_stepper_init(&stepper, 0, 0.01);
+
+    double pose[RTMC_NUM_AXES], expected[RTMC_NUM_AXES];
+    for(int k = 0; k <= 100; k++) {
+        rtmc_path_stepper_next(&stepper, pose);
+        rtmc_kins_scalar_pose(expected, k * 0.01);
+        for(int i = 0; i < RTMC_NUM_AXES; i++)
+            EXPECT_NEAR(pose[i], expected[i], 1e-9);
+    }
+}
+
+// a full circle of radius 5 in the XY plane
+static rtmc_path_t make_circle() {
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_TRIGONOMETRIC;
+    path.coefficients[RTMC_X_AXIS][0] = 5;
+    path.coefficients[RTMC_X_AXIS][1] = 2 * RTMC_PI;
+    path.coefficients[RTMC_X_AXIS][2] = -0.25;
+    path.coefficients[RTMC_Y_AXIS][0] = 5;
+    path.coefficients[RTMC_Y_AXIS][1] = 2 * RTMC_PI;
+    path.coefficients[RTMC_Y_AXIS][3] = 1;
+    return path;
+}
+
+TEST(PathStepperTests, ArcStaysOnTheCircleOverManySteps) {
+    rtmc_path_t path = make_circle();
+
+    // a million steps (a thousand laps) without re-evaluating the sine
+    const int num_steps = 1000000;
+    const double ds = 0.001;
+    rtmc_path_stepper_t stepper;
+    rtmc_path_stepper_init(&stepper, &path, 0, ds);
+
+    double max_position_error = 0;
+    double max_radius_error = 0;
+    double pose[RTMC_NUM_AXES];
+    for(int k = 0; k <= num_steps; k++) {
+        rtmc_path_stepper_next(&stepper, pose);
+        if(k % 997 == 0) {
+            for(int i = 0; i < RTMC_NUM_AXES; i++)
+                max_position_error = fmax(max_position_error, fabs(pose[i] - evaluate(path, i, k * ds)));
+        }
+        double radius = hypot(pose[RTMC_X_AXIS], pose[RTMC_Y_AXIS] - 1);
+        max_radius_error = fmax(max_radius_error, fabs(radius - 5));
+    }
+
+    EXPECT_LT(max_radius_error, RTMC_PATH_STEPPER_RADIUS_TOLERANCE + 1e-12);
+    EXPECT_LT(max_position_error, 1e-8);
+}
+
+TEST(PathStepperTests, RadiusToleranceIsConfigurable) {
+    rtmc_path_t path = make_circle();
+    const double tolerance = 1e-14;
+
+    rtmc_path_stepper_t stepper;
+    rtmc_path_stepper_init(&stepper, &path, 0, 1e-4);
+    rtmc_path_stepper_set_radius_tolerance(&stepper, tolerance);
+
+    double max_radius_error = 0;
+    double pose[RTMC_NUM_AXES];
+    for(int k = 0; k < 200000; k++) {
+        rtmc_path_stepper_next(&stepper, pose);
+        double radius = hypot(pose[RTMC_X_AXIS], pose[RTMC_Y_AXIS] - 1);
+        max_radius_error = fmax(max_radius_error, fabs(radius - 5));
+    }
+
+    // within the tolerance, give or take the round-off of computing `radius`
+    EXPECT_LT(max_radius_error, tolerance + 1e-14);
+}
+
+TEST(PathStepperTests, KinsScalarHelicalStepper) {
+    double scale_factors[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_NUM_AXES; i++)
+        scale_factors[i] = 1 + i;
+    rtmc_kins_scalar_setup(scale_factors);
+
+    rtmc_path_t path;
+    memset(&path, 0, sizeof(path));
+    path.type = RTMC_PATH_TYPE_HELICAL_XZ;
+    path.coefficients[RTMC_X_AXIS][0] = 3;
+    path.coefficients[RTMC_X_AXIS][1] = 3 * RTMC_PI;
+    path.coefficients[RTMC_X_AXIS][2] = -1.0 / 6;
+    path.coefficients[RTMC_Z_AXIS][0] = 3;
+    path.coefficients[RTMC_Z_AXIS][1] = 3 * RTMC_PI;
+    path.coefficients[RTMC_Y_AXIS][2] = 4;
+    path.coefficients[RTMC_Y_AXIS][3] = -2;
+    rtmc_kins_scalar_load(path);
+
+    rtmc_path_stepper_t stepper;
+    rtmc_kins_scalar_stepper_init(&stepper, 0, 0.01);
+
+    double pose[RTMC_NUM_AXES], expected[RTMC_NUM_AXES];
+    for(int k = 0; k <= 100; k++) {
+        rtmc_path_stepper_next(&stepper, pose);
+        rtmc_kins_scalar_pose(expected, k * 0.01);
+        for(int i = 0; i < RTMC_NUM_AXES; i++) {
+            EXPECT_NEAR(pose[i], expected[i], 1e-9);
+            EXPECT_NEAR(expected[i], scale_factors[i] * evaluate(path, i, k * 0.01), 1e-9);
+        }
+    }
+}
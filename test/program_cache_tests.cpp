@@ -0,0 +1,301 @@
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "rtmc_checkpoints.h"
+#include "rtmc_parser.h"
+#include "rtmc_path.h"
+#include "rtmc_path_file.h"
+#include "rtmc_program_cache.h"
+
+// a fresh cache directory for each test (deleted afterwards)
+class ProgramCacheTests : public ::testing::Test {
+protected:
+    char directory[32];
+
+    void SetUp() override {
+        strcpy(directory, "/tmp/rtmc_cache_XXXXXX");
+        ASSERT_TRUE(mkdtemp(directory));
+    }
+
+    void TearDown() override {
+        for(const std::string& name : list_files()) {
+            remove((std::string(directory) + "/" + name).c_str());
+        }
+        remove(directory);
+    }
+
+    std::vector<std::string> list_files() {
+        std::vector<std::string> names;
+        DIR* dir = opendir(directory);
+        struct dirent* entry;
+        while(dir && (entry = readdir(dir))) {
+            if(entry->d_name[0] != '.')
+                names.push_back(entry->d_name);
+        }
+        if(dir)
+            closedir(dir);
+        return names;
+    }
+};
+
+static std::string make_program(int num_lines, int seed) {
+    std::string program = "G17 G01 F" + std::to_string(100 + seed) + "\n";
+    for(int i = 0; i < num_lines; i++) {
+        program += "X" + std::to_string((i * seed) % 31) + " Y" + std::to_string(i % 17) + "\n";
+    }
+    return program;
+}
+
+static void expect_view_matches(rtmc_path_view_t* view, rtmc_path_queue_t* queue) {
+    const rtmc_path_t* expected;
+    while((expected = rtmc_path_queue_front(queue))) {
+        const rtmc_path_t* path = rtmc_path_view_front(view);
+        ASSERT_TRUE(path);
+        ASSERT_EQ(path->type, expected->type);
+        ASSERT_EQ(path->feed_rate, expected->feed_rate);
+        ASSERT_EQ(memcmp(path->coefficients, expected->coefficients, sizeof(path->coefficients)), 0);
+        rtmc_path_view_release(view);
+        rtmc_path_queue_release(queue);
+    }
+    EXPECT_FALSE(rtmc_path_view_front(view));
+}
+
+TEST_F(ProgramCacheTests, HitAndMiss) {
+    rtmc_program_cache_t* cache = rtmc_create_program_cache(directory, 1 << 30);
+    std::string program = make_program(1000, 3);
+
+    rtmc_parser_t* parser = rtmc_create_parser();
+    for(int i = 0; i < 3; i++) {
+        rtmc_flush_parser_data_ctx(parser);
+        rtmc_path_view_t view;
+        ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, program.data(), program.size(), &view, NULL, 0), 0);
+
+        // the parser continues from the end of the program either way
+        rtmc_path_queue_t queue = rtmc_create_path_queue();
+        rtmc_parse_ctx(parser, &queue, "X100");
+
+        rtmc_path_queue_t copy = rtmc_create_path_queue();
+        rtmc_flush_parser_data_ctx(parser);
+        rtmc_parse_buffer(parser, &copy, program.data(), program.size(), NULL, 0);
+        expect_view_matches(&view, &copy);
+
+        const rtmc_path_t* last = rtmc_path_queue_front(&queue);
+        ASSERT_TRUE(last);
+        EXPECT_EQ(last->feed_rate, 103);
+        EXPECT_EQ(last->coefficients[RTMC_X_AXIS][2], 100 - (999 * 3) % 31);
+
+        rtmc_close_path_view(&view);
+        rtmc_flush_path_queue(&queue);
+        rtmc_flush_path_queue(&copy);
+    }
+
+    rtmc_program_cache_stats_t stats = rtmc_get_program_cache_stats(cache);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 2);
+    EXPECT_EQ(list_files().size(), 1);
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_program_cache(cache);
+}
+
+TEST_F(ProgramCacheTests, KeyIncludesParserState) {
+    rtmc_program_cache_t* cache = rtmc_create_program_cache(directory, 1 << 30);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_view_t view;
+
+    // the same program from a different position is a different job
+    const char program[] = "G01 F100 X10\n";
+    ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, program, sizeof(program) - 1, &view, NULL, 0), 0);
+    ASSERT_EQ(view.count, 1);
+    EXPECT_EQ(view.paths[0].coefficients[RTMC_X_AXIS][2], 10);
+    rtmc_close_path_view(&view);
+
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_parse_ctx(parser, &queue, "G00 X3");
+    ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, program, sizeof(program) - 1, &view, NULL, 0), 0);
+    ASSERT_EQ(view.count, 1);
+    EXPECT_EQ(view.paths[0].coefficients[RTMC_X_AXIS][2], 7);
+    EXPECT_EQ(view.paths[0].coefficients[RTMC_X_AXIS][3], 3);
+    rtmc_close_path_view(&view);
+    rtmc_flush_path_queue(&queue);
+
+    EXPECT_EQ(rtmc_get_program_cache_stats(cache).misses, 2);
+    EXPECT_EQ(rtmc_get_program_cache_stats(cache).hits, 0);
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_program_cache(cache);
+}
+
+TEST_F(ProgramCacheTests, ErrorsArentCached) {
+    rtmc_program_cache_t* cache = rtmc_create_program_cache(directory, 1 << 30);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_view_t view;
+
+    const char program[] = "G01 F100 X10\nH1\n";
+    rtmc_parse_error_t error;
+    ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, program, sizeof(program) - 1, &view, &error, 1), 1);
+    EXPECT_EQ(error.line, 2);
+    EXPECT_EQ(view.count, 0);
+    EXPECT_EQ(list_files().size(), 0);
+    rtmc_close_path_view(&view);
+
+    // an unusable directory is reported as an error
+    rtmc_program_cache_t* missing = rtmc_create_program_cache("/nonexistent/rtmc_cache", 1 << 30);
+    rtmc_flush_parser_data_ctx(parser);
+    ASSERT_EQ(rtmc_cache_parse_buffer(missing, parser, program, 13, &view, &error, 1), 1);
+    EXPECT_EQ(error.line, 0);
+    EXPECT_EQ(view.count, 0);
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_program_cache(cache);
+    rtmc_destroy_program_cache(missing);
+}
+
+TEST_F(ProgramCacheTests, EvictsLeastRecentlyUsed) {
+    rtmc_program_cache_t* cache = rtmc_create_program_cache(directory, 1 << 30);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_view_t view;
+
+    // fill the cache with three programs, used at different times
+    std::string programs[4];
+    for(int i = 0; i < 4; i++) {
+        programs[i] = make_program(100, i + 1);
+    }
+    for(int i = 0; i < 3; i++) {
+        rtmc_flush_parser_data_ctx(parser);
+        ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, programs[i].data(), programs[i].size(), &view, NULL, 0), 0);
+        rtmc_close_path_view(&view);
+    }
+    ASSERT_EQ(list_files().size(), 3);
+
+    // use program 1 again, so program 2 is the oldest (all within the same
+    // second, which file times couldn't tell apart)
+    rtmc_flush_parser_data_ctx(parser);
+    ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, programs[0].data(), programs[0].size(), &view, NULL, 0), 0);
+    rtmc_close_path_view(&view);
+    EXPECT_EQ(rtmc_get_program_cache_stats(cache).hits, 1);
+
+    // a fourth program only leaves room for two
+    rtmc_destroy_program_cache(cache);
+    cache = rtmc_create_program_cache(directory, 100000);
+    rtmc_flush_parser_data_ctx(parser);
+    ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, programs[3].data(), programs[3].size(), &view, NULL, 0), 0);
+    rtmc_close_path_view(&view);
+    EXPECT_EQ(list_files().size(), 2);
+    EXPECT_EQ(rtmc_get_program_cache_stats(cache).evictions, 2);
+
+    // the newest old program survived
+    rtmc_flush_parser_data_ctx(parser);
+    ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, programs[0].data(), programs[0].size(), &view, NULL, 0), 0);
+    rtmc_close_path_view(&view);
+    EXPECT_EQ(rtmc_get_program_cache_stats(cache).hits, 1);
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_program_cache(cache);
+}
+
+TEST_F(ProgramCacheTests, HashCollisionIsAMiss) {
+    rtmc_program_cache_t* cache = rtmc_create_program_cache(directory, 1 << 30);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_view_t view;
+    std::string program = make_program(100, 5);
+
+    ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, program.data(), program.size(), &view, NULL, 0), 0);
+    rtmc_close_path_view(&view);
+
+    // rewrite the cached file as if a different program of the same length
+    // had the same hash (one digit of its source changed)
+    std::vector<std::string> names = list_files();
+    ASSERT_EQ(names.size(), 1);
+    std::string filename = std::string(directory) + "/" + names[0];
+    FILE* file = fopen(filename.c_str(), "rb");
+    ASSERT_TRUE(file);
+    std::string contents;
+    char buffer[4096];
+    size_t count;
+    while((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        contents.append(buffer, count);
+    fclose(file);
+
+    size_t source = contents.find(program);
+    ASSERT_NE(source, std::string::npos);
+    contents[source + program.size() - 2] ^= 1;
+    file = fopen(filename.c_str(), "wb");
+    ASSERT_TRUE(file);
+    fwrite(contents.data(), 1, contents.size(), file);
+    fclose(file);
+
+    // the real program is parsed again (and replaces the impostor)
+    rtmc_flush_parser_data_ctx(parser);
+    ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, program.data(), program.size(), &view, NULL, 0), 0);
+    rtmc_close_path_view(&view);
+    EXPECT_EQ(rtmc_get_program_cache_stats(cache).hits, 0);
+    EXPECT_EQ(rtmc_get_program_cache_stats(cache).misses, 2);
+
+    rtmc_flush_parser_data_ctx(parser);
+    ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, program.data(), program.size(), &view, NULL, 0), 0);
+    rtmc_close_path_view(&view);
+    EXPECT_EQ(rtmc_get_program_cache_stats(cache).hits, 1);
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_program_cache(cache);
+}
+
+TEST_F(ProgramCacheTests, HitsRecordCheckpoints) {
+    rtmc_program_cache_t* cache = rtmc_create_program_cache(directory, 1 << 30);
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_path_view_t view;
+    std::string program = make_program(1000, 7);
+
+    // the miss records the checkpoints
+    rtmc_checkpoints_t* parsed = rtmc_create_checkpoints(100);
+    rtmc_set_parser_checkpoints(parser, parsed);
+    ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, program.data(), program.size(), &view, NULL, 0), 0);
+    rtmc_close_path_view(&view);
+    ASSERT_EQ(rtmc_checkpoint_count(parsed), 11);
+
+    // hits record them too, at the same interval (copied from the cache) or
+    // at another one
+    for(size_t interval : {100, 250}) {
+        SCOPED_TRACE(interval);
+        rtmc_checkpoints_t* checkpoints = rtmc_create_checkpoints(interval);
+        rtmc_flush_parser_data_ctx(parser);
+        rtmc_set_parser_checkpoints(parser, checkpoints);
+        ASSERT_EQ(rtmc_cache_parse_buffer(cache, parser, program.data(), program.size(), &view, NULL, 0), 0);
+        rtmc_close_path_view(&view);
+        EXPECT_EQ(rtmc_checkpoint_count(checkpoints), 1000 / interval + 1);
+
+        // restarting from them matches restarting from the parsed ones
+        rtmc_set_parser_checkpoints(parser, NULL);
+        rtmc_parser_t* expected = rtmc_create_parser();
+        size_t offset, expected_offset;
+        ASSERT_TRUE(rtmc_restore_checkpoint(checkpoints, parser, program.data(), program.size(), 777, &offset));
+        ASSERT_TRUE(rtmc_restore_checkpoint(parsed, expected, program.data(), program.size(), 777, &expected_offset));
+        EXPECT_EQ(offset, expected_offset);
+
+        rtmc_path_queue_t queue = rtmc_create_path_queue();
+        rtmc_path_queue_t expected_queue = rtmc_create_path_queue();
+        rtmc_parse_ctx(parser, &queue, "G01 X-5");
+        rtmc_parse_ctx(expected, &expected_queue, "G01 X-5");
+        const rtmc_path_t* path = rtmc_path_queue_front(&queue);
+        const rtmc_path_t* expected_path = rtmc_path_queue_front(&expected_queue);
+        ASSERT_TRUE(path);
+        ASSERT_TRUE(expected_path);
+        EXPECT_EQ(path->feed_rate, expected_path->feed_rate);
+        EXPECT_EQ(memcmp(path->coefficients, expected_path->coefficients, sizeof(path->coefficients)), 0);
+
+        rtmc_flush_path_queue(&queue);
+        rtmc_flush_path_queue(&expected_queue);
+        rtmc_destroy_parser(expected);
+        rtmc_destroy_checkpoints(checkpoints);
+    }
+    EXPECT_EQ(rtmc_get_program_cache_stats(cache).hits, 2);
+
+    rtmc_destroy_parser(parser);
+    rtmc_destroy_checkpoints(parsed);
+    rtmc_destroy_program_cache(cache);
+}
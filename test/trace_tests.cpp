@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "rtmc_kins_scalar.h"
+#include "rtmc_parser.h"
+#include "rtmc_path.h"
+#include "rtmc_trace.h"
+
+// a separate file per test, so tests can run in parallel
+static std::string temp_filename() {
+    return testing::TempDir() + "trace_tests_" +
+        testing::UnitTest::GetInstance()->current_test_info()->name() + ".json";
+}
+
+// parses and runs a few paths (hitting every trace point)
+static void run_program() {
+    rtmc_path_queue_t queue = rtmc_create_path_queue();
+    rtmc_parser_t* parser = rtmc_create_parser();
+    rtmc_parse_ctx(parser, &queue, "G17 G01 F100");
+    rtmc_parse_ctx(parser, &queue, "G01 X1 Y2");
+    rtmc_parse_ctx(parser, &queue, "G02 X0 Y0 I1 J0");
+    rtmc_destroy_parser(parser);
+
+    double scale_factors[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_NUM_AXES; i++)
+        scale_factors[i] = 1;
+    rtmc_kins_scalar_setup(scale_factors);
+
+    double pose[RTMC_NUM_AXES];
+    while(rtmc_path_queue_front(&queue)) {
+        rtmc_kins_scalar_load(rtmc_path_dequeue(&queue));
+        rtmc_kins_scalar_pose(pose, 0.5);
+    }
+    rtmc_flush_path_queue(&queue);
+}
+
+static size_t count_occurrences(const std::string& str, const std::string& substr) {
+    size_t count = 0;
+    for(size_t i = str.find(substr); i != std::string::npos; i = str.find(substr, i + 1))
+        count++;
+    return count;
+}
+
+#ifdef RTMC_TRACE
+
+TEST(TraceTests, RecordsEveryTracePoint) {
+    EXPECT_TRUE(rtmc_trace_is_enabled());
+    rtmc_trace_clear();
+    EXPECT_EQ(rtmc_trace_event_count(), 0);
+
+    run_program();
+
+    // 3 parses, 3 generated paths, 2 paths, and a load and pose for each
+    EXPECT_EQ(rtmc_trace_event_count(), 14);
+
+    std::string filename = temp_filename();
+    ASSERT_TRUE(rtmc_trace_dump_chrome(filename.c_str()));
+    std::ifstream file(filename);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string json = contents.str();
+
+    EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0);
+    EXPECT_EQ(count_occurrences(json, "\"ph\":\"X\""), 14);
+    EXPECT_EQ(count_occurrences(json, "\"name\":\"parse\""), 3);
+    EXPECT_EQ(count_occurrences(json, "\"name\":\"generate_path\""), 3);
+    EXPECT_EQ(count_occurrences(json, "\"name\":\"path_enqueue\""), 2);
+    EXPECT_EQ(count_occurrences(json, "\"name\":\"path_dequeue\""), 2);
+    EXPECT_EQ(count_occurrences(json, "\"name\":\"rtmc_kins_scalar_load\""), 2);
+    EXPECT_EQ(count_occurrences(json, "\"name\":\"rtmc_kins_scalar_pose\""), 2);
+    EXPECT_NE(json.find("\"dropped_events\":0}"), std::string::npos);
+    remove(filename.c_str());
+}
+
+TEST(TraceTests, SeparatesThreads) {
+    rtmc_trace_clear();
+
+    // this thread keeps its buffer, so the other thread can't reuse it
+    run_program();
+    std::thread thread(run_program);
+    thread.join();
+    EXPECT_EQ(rtmc_trace_event_count(), 28);
+
+    std::string filename = temp_filename();
+    ASSERT_TRUE(rtmc_trace_dump_chrome(filename.c_str()));
+    std::ifstream file(filename);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string json = contents.str();
+
+    // each thread's events have their own tid
+    size_t first_tid = json.find("\"tid\":");
+    ASSERT_NE(first_tid, std::string::npos);
+    std::string tid = json.substr(first_tid, json.find('}', first_tid) - first_tid);
+    EXPECT_EQ(count_occurrences(json, tid + "}"), 14);
+    remove(filename.c_str());
+}
+
+TEST(TraceTests, KeepsMostRecentEvents) {
+    rtmc_trace_clear();
+
+    double pose[RTMC_NUM_AXES];
+    for(int i = 0; i < RTMC_TRACE_BUFFER_SIZE + 100; i++)
+        rtmc_kins_scalar_pose(pose, 0.5);
+    EXPECT_EQ(rtmc_trace_event_count(), RTMC_TRACE_BUFFER_SIZE);
+}
+
+TEST(TraceTests, ReusesBuffersOfExitedThreads) {
+    rtmc_trace_clear();
+
+    double pose[RTMC_NUM_AXES];
+    for(int i = 0; i < 3 * RTMC_TRACE_MAX_THREADS; i++) {
+        std::thread thread([&pose]() { rtmc_kins_scalar_pose(pose, 0.5); });
+        thread.join();
+    }
+    EXPECT_EQ(rtmc_trace_event_count(), 3 * RTMC_TRACE_MAX_THREADS);
+    EXPECT_EQ(rtmc_trace_dropped_count(), 0);
+}
+
+TEST(TraceTests, CountsDroppedEvents) {
+    rtmc_trace_clear();
+
+    double pose[RTMC_NUM_AXES];
+    rtmc_kins_scalar_pose(pose, 0.5);
+
+    // with this thread's buffer, one more thread than there are buffers
+    std::promise<void> finish;
+    std::shared_future<void> finished = finish.get_future().share();
+    std::atomic<int> num_recorded(0);
+    std::vector<std::thread> threads;
+    for(int i = 0; i < RTMC_TRACE_MAX_THREADS; i++) {
+        threads.emplace_back([&num_recorded, finished]() {
+            double thread_pose[RTMC_NUM_AXES];
+            rtmc_kins_scalar_pose(thread_pose, 0.5);
+            num_recorded++;
+            finished.wait();
+        });
+    }
+    while(num_recorded < RTMC_TRACE_MAX_THREADS)
+        std::this_thread::yield();
+    finish.set_value();
+    for(std::thread& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(rtmc_trace_event_count(), RTMC_TRACE_MAX_THREADS);
+    EXPECT_EQ(rtmc_trace_dropped_count(), 1);
+
+    std::string filename = temp_filename();
+    ASSERT_TRUE(rtmc_trace_dump_chrome(filename.c_str()));
+    std::ifstream file(filename);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    EXPECT_NE(contents.str().find("\"dropped_events\":1}"), std::string::npos);
+    remove(filename.c_str());
+
+    rtmc_trace_clear();
+    EXPECT_EQ(rtmc_trace_dropped_count(), 0);
+}
+
+#else
+
+TEST(TraceTests, DisabledByDefault) {
+    EXPECT_FALSE(rtmc_trace_is_enabled());
+    run_program();
+    EXPECT_EQ(rtmc_trace_event_count(), 0);
+    EXPECT_EQ(rtmc_trace_dropped_count(), 0);
+    EXPECT_FALSE(rtmc_trace_dump_chrome(temp_filename().c_str()));
+}
+
+#endif